@@ -191,7 +191,7 @@ void EntryDetailsView::loadTask(const Task *task)
     }
 
     // Track the currently-loaded task and enable actions
-    m_currentTaskUuid = task->uuid;
+    m_currentTaskUuid = QString(task->uuid.text());
     m_deleteBtn->setEnabled(true);
     m_moveBtn->setEnabled(true);
     m_editBtn->setEnabled(true);
@@ -141,7 +141,35 @@ MainWindow::MainWindow(QWidget *parent, CalendarRepository *dataPtr)
         // Exit link-selection mode and show normal todo list
         switchRightPanel(Scene::TodoList); });
 
+    // --- Repository notifications ---
+    // modelChanged is a full reload; the finer signals patch only the affected rows and columns
     connect(repo, &CalendarRepository::modelChanged, this, &MainWindow::modelChanged);
+    connect(repo, &CalendarRepository::taskInserted, todoListView, &TodoListView::onTaskInserted);
+    connect(repo, &CalendarRepository::taskUpdated, todoListView, &TodoListView::onTaskUpdated);
+    connect(repo, &CalendarRepository::taskRemoved, todoListView, &TodoListView::onTaskRemoved);
+    connect(repo, &CalendarRepository::taskMoved, todoListView, &TodoListView::onTaskMoved);
+    connect(repo, &CalendarRepository::habitEntryChanged, todoListView, &TodoListView::onTaskUpdated);
+    connect(repo, &CalendarRepository::timeblockInserted, todoListView, &TodoListView::onTimeblockInserted);
+    connect(repo, &CalendarRepository::timeblockUpdated, todoListView, &TodoListView::onTimeblockUpdated);
+    connect(repo, &CalendarRepository::timeblockRemoved, todoListView, &TodoListView::onTimeblockRemoved);
+    connect(repo, &CalendarRepository::writeFailed, this, [this](const QString &entryUuid, int err)
+            {
+                LOGE("MainWindow", "Saving <%s> failed with SQLite error %d", entryUuid.toUtf8().constData(), err);
+                QMessageBox::warning(this, "Save Failed", "A change could not be saved and has been undone."); });
+
+    connect(repo, &CalendarRepository::taskInserted, overviewView, &OverviewView::onModelEdited);
+    connect(repo, &CalendarRepository::taskUpdated, overviewView, &OverviewView::onModelEdited);
+    connect(repo, &CalendarRepository::taskRemoved, overviewView, &OverviewView::onModelEdited);
+    connect(repo, &CalendarRepository::taskMoved, overviewView, &OverviewView::onModelEdited);
+    connect(repo, &CalendarRepository::habitEntryChanged, overviewView, &OverviewView::onModelEdited);
+    connect(repo, &CalendarRepository::timeblockRemoved, overviewView, &OverviewView::onModelEdited);
+
+    // The new entry form lists timeblocks by name
+    auto refreshTimeblockChoices = [this]()
+    { newEntryView->populateTimeblocks(repo->timeblocks()); };
+    connect(repo, &CalendarRepository::timeblockInserted, this, refreshTimeblockChoices);
+    connect(repo, &CalendarRepository::timeblockUpdated, this, refreshTimeblockChoices);
+    connect(repo, &CalendarRepository::timeblockRemoved, this, refreshTimeblockChoices);
 
     // EntryDetailsView actions
     connect(entryDetailsView, &EntryDetailsView::addHabitEntryRequested, this, &MainWindow::onHabitEntryRequested);
@@ -184,11 +212,8 @@ void MainWindow::onDeleteTaskRequested(const QString &taskUuid)
     if (reply != QMessageBox::Yes)
         return;
 
-    // Call repository to remove task
-    if (!repo->removeTask(taskUuid.toUtf8().constData()))
-    {
-        LOGE(TAG, "Failed to remove task %s", taskUuid.toUtf8().constData());
-    }
+    // Call repository to remove task; the row disappears at once and the delete is written in the background
+    repo->removeTaskAsync(taskUuid.toUtf8().constData());
 }
 
 void MainWindow::onMoveTaskRequested(const QString &taskUuid)
@@ -214,13 +239,13 @@ void MainWindow::onMoveTaskRequested(const QString &taskUuid)
         return;
 
     // Find selected timeblock UUID
-    const char *destUuid = nullptr;
+    const UUID *destUuid = nullptr;
     std::string cname = chosen.toStdString();
     for (const auto &tb : tbs)
     {
         if (cname == tb.name)
         {
-            destUuid = tb.uuid;
+            destUuid = &tb.uuid;
             break;
         }
     }
@@ -230,10 +255,7 @@ void MainWindow::onMoveTaskRequested(const QString &taskUuid)
         return;
     }
 
-    if (!repo->moveTask(taskUuid.toUtf8().constData(), destUuid))
-    {
-        LOGE(TAG, "Failed to move task %s to %s", taskUuid.toUtf8().constData(), destUuid);
-    }
+    repo->moveTaskAsync(taskUuid.toUtf8().constData(), *destUuid);
 }
 
 void MainWindow::onEditTaskRequested(const QString &taskUuid)
@@ -287,8 +309,7 @@ void MainWindow::switchRightPanel(Scene scene, QVariant data)
     case Scene::TodoList:
         rightStack->setCurrentWidget(todoListView);
         currentRightScene = Scene::TodoList;
-        // Update the todo list
-        modelChanged();
+        // The todo list follows the repository's notifications, so no rebuild is needed here
         break;
     case Scene::NewEntryLink:
         // Show the todo list but mark the right scene as NewEntryLink so
@@ -446,6 +467,17 @@ void MainWindow::onTaskCreated(Task *task, int timeblockIndex)
 
     LOGI(TAG, "Task <%s> created for timeblock index %d", task->name, timeblockIndex);
 
+    // Timeblocks may have been reordered since the form was filled in; resolve the one it chose
+    const auto &timeblocks = repo->timeblocks();
+    for (size_t i = 0; i < timeblocks.size(); i++)
+    {
+        if (timeblocks[i].uuid == task->timeblock_uuid)
+        {
+            timeblockIndex = static_cast<int>(i);
+            break;
+        }
+    }
+
     repo->addTask(*task, timeblockIndex);
 
     // Find if a prerequisite was selected in NewEntryView and create the entry link
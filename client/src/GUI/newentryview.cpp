@@ -181,12 +181,17 @@ NewEntryView::NewEntryView(QWidget *parent)
 
 void NewEntryView::populateTimeblocks(const std::vector<Timeblock> &timeblocks)
 {
+    // Items carry the timeblock UUID so the selection survives repopulating and reordering
+    QString selected = m_timeblockCombo->currentData().toString();
     m_timeblockCombo->clear();
     for (const Timeblock &tb : timeblocks)
     {
         QString name = tb.name ? QString::fromUtf8(tb.name) : QString("(Unnamed)");
-        m_timeblockCombo->addItem(name);
+        m_timeblockCombo->addItem(name, QString(tb.uuid.text()));
     }
+    int index = m_timeblockCombo->findData(selected);
+    if (index >= 0)
+        m_timeblockCombo->setCurrentIndex(index);
 }
 
 void NewEntryView::clearFields()
@@ -494,19 +499,19 @@ void NewEntryView::onCreateClicked()
     // Set UUID
     if (m_editMode)
     {
-        memcpy(t->uuid.value, m_editingTask->uuid.value, UUID_LEN);
-        memcpy(t->timeblock_uuid.value, m_editingTask->timeblock_uuid.value, UUID_LEN);
+        t->uuid = m_editingTask->uuid;
+        t->timeblock_uuid = m_editingTask->timeblock_uuid;
     }
 
     // Set name and description
     QString name = m_nameEdit->text().trimmed();
     if (!name.isEmpty())
-        t->name = strdup(name.toUtf8().constData());
+        t->name = intern_string(name.toUtf8().constData());
     else
-        t->name = strdup("(untitled)");
+        t->name = intern_string("(untitled)");
 
     QString desc = m_descEdit->toPlainText();
-    t->desc = strdup(desc.toUtf8().constData());
+    t->desc = intern_string(desc.toUtf8().constData());
 
     // Set priority
     int rawPriority = m_priorityCombo->currentData().toInt();
@@ -567,6 +572,8 @@ void NewEntryView::onCreateClicked()
     }
 
     int tbIndex = m_timeblockCombo->currentIndex();
+    if (!m_editMode)
+        t->set_timeblock_uuid(m_timeblockCombo->currentData().toString().toUtf8().constData());
     if (m_editMode)
     {
         emit taskEdited(t); // Run update signal
@@ -39,7 +39,8 @@ public:
     // Return the selected prerequisite tasks (empty if none)
     void getPrerequisites(std::vector<Task *> &prerequisits);
 signals:
-    // Emitted when the user creates a new task. Caller receives ownership of the Task*
+    // Emitted when the user creates a new task, with task->timeblock_uuid set to the chosen
+    // timeblock. Caller receives ownership of the Task*
     void taskCreated(Task *task, int timeblockIndex);
     // Emitted when the user edits an existing task. Caller receives ownership of the Task*
     void taskEdited(Task *task);
@@ -47,12 +47,12 @@ void NewTimeblockView::onCreateClicked()
     // Set name and description
     QString name = m_nameEdit->text().trimmed();
     if (!name.isEmpty())
-        tb->name = strdup(name.toUtf8().constData());
+        tb->name = intern_string(name.toUtf8().constData());
     else
-        tb->name = strdup("(untitled)");
+        tb->name = intern_string("(untitled)");
 
     QString desc = m_descEdit->toPlainText();
-    tb->desc = strdup(desc.toUtf8().constData());
+    tb->desc = intern_string(desc.toUtf8().constData());
 
     // Emit signal
     emit timeblockCreated(tb);
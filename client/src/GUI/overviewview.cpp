@@ -3,6 +3,9 @@
 #include "log.h"
 #include "taskitemwidget.h"
 
+#include <QShowEvent>
+#include <QTimer>
+
 #define TASKS_TO_DISPLAY 5
 
 OverviewView::OverviewView(QWidget *parent, CalendarRepository *dataRepo)
@@ -43,44 +46,48 @@ OverviewView::OverviewView(QWidget *parent, CalendarRepository *dataRepo)
     updateOverview();
 }
 
+void OverviewView::onModelEdited()
+{
+    if (!isVisible())
+    {
+        m_dirty = true;
+        return;
+    }
+
+    // Several notifications can arrive for one edit; recompute once they have all been delivered
+    if (m_updatePending)
+        return;
+    m_updatePending = true;
+    QTimer::singleShot(0, this, [this]()
+                       {
+        m_updatePending = false;
+        updateOverview(); });
+}
+
+void OverviewView::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_dirty)
+        updateOverview();
+}
+
 void OverviewView::updateOverview()
 {
     const char *TAG = "OverviewView::updateOverview";
     LOGI(TAG, "Updating overview");
+    m_dirty = false;
 
     std::vector<Task *> tasksToDisplay;
     std::vector<Task *> completedToday;
     time_t now = std::time(nullptr);
 
-
-    // Iterate through tasks to get the most urgent ones and tasks completed today.
-    for (auto &[uuid, taskPtr] : repo->tasks())
-    {
-        // Iterate through all ongoing tasks
-        if (taskPtr->status == TaskStatus::INCOMPLETE || taskPtr->status == TaskStatus::HABIT)
-        {
-            tasksToDisplay.push_back(taskPtr.get());
-        }
-        else if (taskPtr->status == TaskStatus::COMPLETE)
-        {
-            // Check if task was completed today
-            time_t startOfDay = now - (now % 86400); // Get start of current day
-            if (taskPtr->completed_datetime >= startOfDay)
-            {
-                completedToday.push_back(taskPtr.get());
-            }
-        }
-    }
-
     // --- Update list of top tasks ---
 
-    // Sort tasks by urgency and take the top ones
-    std::sort(tasksToDisplay.begin(), tasksToDisplay.end(), [](const Task *a, const Task *b)
-              { return a->get_urgency() > b->get_urgency(); });
-    if (tasksToDisplay.size() > (int)TASKS_TO_DISPLAY)
-    {
-        tasksToDisplay.resize((int)TASKS_TO_DISPLAY);
-    }
+    // The repository answers both from its task table, scanning a few columns instead of every Task
+    repo->topUrgentTasks(TASKS_TO_DISPLAY, tasksToDisplay);
+
+    time_t startOfDay = now - (now % 86400); // Get start of current day
+    repo->tasksCompletedSince(startOfDay, completedToday);
 
     // Update the list widget with the top tasks
     m_urgentTasksList->clear();
@@ -108,10 +115,6 @@ void OverviewView::updateOverview()
         return;
     }
 
-    // Sort completed tasks by completion time (most recent first)
-    std::sort(completedToday.begin(), completedToday.end(), [](const Task *a, const Task *b)
-              { return a->completed_datetime > b->completed_datetime; });
-
     // Update the completed tasks list widget
     m_completedTasksList->clear();
     for (auto *task : completedToday)
@@ -13,6 +13,8 @@
 #include <QVBoxLayout>
 #include <QVector>
 
+class QShowEvent;
+
 #include "calendarrepository.h"
 #include "task.h"
 
@@ -23,8 +25,16 @@ public:
     explicit OverviewView(QWidget *parent = nullptr, CalendarRepository *dataRepo = nullptr);
     void updateOverview();
 
+public slots:
+    void onModelEdited(); // Schedule a refresh for after the current edit, or on next show if hidden
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
 private:
     CalendarRepository *repo = nullptr;
+    bool m_dirty = false;         // Model changed while hidden
+    bool m_updatePending = false; // Refresh already queued for this event loop pass
 
     QListWidget *m_urgentTasksList = nullptr;
     QListWidget *m_completedTasksList = nullptr;
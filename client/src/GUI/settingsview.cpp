@@ -12,7 +12,8 @@
 #include <QCoreApplication>
 #include <QDir>
 
-ScoreWeights g_score_weights; // Global variable to hold current score weights
+ScoreWeights g_score_weights;        // Global variable to hold current score weights
+unsigned g_score_weights_generation; // Bumped on every change to g_score_weights
 
 void SettingsView::FindScoreWeights()
 {
@@ -137,6 +138,7 @@ void SettingsView::onProfileChanged(int index)
     w.scope_weight = static_cast<float>(sc);
     w.undated_pressure_constant = static_cast<float>(c);
     g_score_weights = w;
+    g_score_weights_generation++;
 
     LOGI(TAG, "Profile '%s' selected: due=%f pri=%f scope=%f undated_pressure_constant=%f",
          groupKey.toUtf8().constData(), due, pri, sc, c);
@@ -0,0 +1,256 @@
+#include "tasklistmodel.h"
+
+#include "log.h"
+#include "calendarrepository.h"
+
+#include <QTimer>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#define ARCHIVE_FETCH_BATCH 100 // Archived rows exposed per fetchMore()
+
+TaskListModel::TaskListModel(CalendarRepository *repo, Filter filter, QObject *parent)
+    : QAbstractListModel(parent), m_repo(repo), m_filter(filter), m_active(filter == Filter::ACTIVE)
+{
+}
+
+void TaskListModel::setTimeblock(const QString &timeblockUuid)
+{
+    m_timeblockUuid = timeblockUuid;
+    reload();
+}
+
+void TaskListModel::setActive(bool active)
+{
+    if (m_active == active)
+        return;
+    m_active = active;
+    reload(); // Loads rows when activated, releases them when deactivated
+}
+
+void TaskListModel::reload()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_fetched = 0;
+
+    Timeblock *tb = m_active ? m_repo->findTimeblockByUuid(m_timeblockUuid.toUtf8().constData()) : nullptr;
+    if (tb)
+    {
+        for (Task *task : tb->tasks)
+        {
+            if (task && accepts(task))
+                m_rows.push_back(Row{task->uuid, task});
+        }
+    }
+    int total = static_cast<int>(m_rows.size());
+    m_fetched = (m_filter == Filter::ACTIVE) ? total : std::min(total, ARCHIVE_FETCH_BATCH);
+    endResetModel();
+}
+
+bool TaskListModel::accepts(const Task *task) const
+{
+    bool complete = (task->status == TaskStatus::COMPLETE);
+    return (m_filter == Filter::ARCHIVED) == complete;
+}
+
+int TaskListModel::indexOf(const QString &taskUuid) const
+{
+    UUID uuid(taskUuid.toUtf8().constData());
+    for (size_t i = 0; i < m_rows.size(); i++)
+    {
+        if (m_rows[i].uuid == uuid)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int TaskListModel::targetRow(const Task *task) const
+{
+    Timeblock *tb = m_repo->findTimeblockByUuid(m_timeblockUuid.toUtf8().constData());
+    if (!tb)
+        return 0;
+
+    int row = 0;
+    for (const Task *t : tb->tasks)
+    {
+        if (t == task)
+            break;
+        if (accepts(t))
+            row++;
+    }
+    return row;
+}
+
+void TaskListModel::syncTask(Task *task)
+{
+    if (!m_active || !task)
+        return;
+
+    const int current = indexOf(QString(task->uuid.text()));
+    const bool belongs = (m_timeblockUuid == QString(task->timeblock_uuid.text())) && accepts(task);
+
+    // Leaving this list
+    if (!belongs)
+    {
+        if (current >= 0)
+            removeTask(QString(task->uuid.text()));
+        return;
+    }
+
+    const int target = targetRow(task);
+
+    // Same place: repaint only
+    if (current == target)
+    {
+        if (current < m_fetched)
+            emit dataChanged(index(current), index(current));
+        return;
+    }
+
+    // Visible row moving within the visible range: move it so views keep selection
+    if (current >= 0 && current < m_fetched && target < m_fetched)
+    {
+        const int dest = target > current ? target + 1 : target;
+        beginMoveRows(QModelIndex(), current, current, QModelIndex(), dest);
+        Row row = m_rows[current];
+        m_rows.erase(m_rows.begin() + current);
+        m_rows.insert(m_rows.begin() + target, row);
+        endMoveRows();
+        emit dataChanged(index(target), index(target));
+        return;
+    }
+
+    if (current >= 0)
+        removeTask(QString(task->uuid.text()));
+
+    // Rows past the fetched range stay hidden until fetchMore reaches them
+    const bool fullyFetched = (m_fetched == static_cast<int>(m_rows.size()));
+    if (target < m_fetched || (target == m_fetched && fullyFetched))
+    {
+        beginInsertRows(QModelIndex(), target, target);
+        m_rows.insert(m_rows.begin() + target, Row{task->uuid, task});
+        m_fetched++;
+        endInsertRows();
+    }
+    else
+    {
+        m_rows.insert(m_rows.begin() + target, Row{task->uuid, task});
+    }
+}
+
+void TaskListModel::removeTask(const QString &taskUuid)
+{
+    const int row = indexOf(taskUuid);
+    if (row < 0)
+        return;
+
+    if (row < m_fetched)
+    {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.erase(m_rows.begin() + row);
+        m_fetched--;
+        endRemoveRows();
+    }
+    else
+    {
+        m_rows.erase(m_rows.begin() + row);
+    }
+}
+
+Task *TaskListModel::taskAt(const QModelIndex &index)
+{
+    if (!index.isValid())
+        return nullptr;
+    return reinterpret_cast<Task *>(index.data(TaskRole).value<quintptr>());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              QAbstractListModel                            */
+/* -------------------------------------------------------------------------- */
+
+int TaskListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+QVariant TaskListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_fetched)
+        return QVariant();
+
+    const Task *task = m_rows[index.row()].task;
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        return task->name ? QString::fromUtf8(task->name) : QString("(untitled)");
+    case Qt::CheckStateRole:
+        // Tasks are tristate (incomplete / in progress / complete); habits are checked when done today
+        if (task->status == TaskStatus::HABIT)
+            return (task->completed_days[0] == TaskStatus::COMPLETE) ? Qt::Checked : Qt::Unchecked;
+        if (task->status == TaskStatus::IN_PROGRESS)
+            return Qt::PartiallyChecked;
+        return (task->status == TaskStatus::COMPLETE) ? Qt::Checked : Qt::Unchecked;
+    case TaskRole:
+        return QVariant::fromValue(reinterpret_cast<quintptr>(task));
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags TaskListModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= m_fetched)
+        return Qt::NoItemFlags;
+
+    Qt::ItemFlags f = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    // Blocked tasks (unfinished prerequisites) cannot be checked off
+    if (m_rows[index.row()].task->get_urgency() >= 0)
+        f |= Qt::ItemIsUserCheckable;
+    return f;
+}
+
+bool TaskListModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    const char *TAG = "TaskListModel::setData";
+
+    if (role != Qt::CheckStateRole || !index.isValid() || index.row() >= m_fetched)
+        return false;
+
+    const Task *task = m_rows[index.row()].task;
+    const int checkState = value.toInt();
+    LOGI(TAG, "Task '%s' completion changed: checkState=%d", task->name ? task->name : "(untitled)", checkState);
+
+    // Apply on the next event loop pass; the repository updates memory and notifies at once, and
+    // the database write happens on its worker thread
+    UUID uuid_copy = task->uuid;
+    CalendarRepository *repo = m_repo;
+    const Qt::CheckState state = static_cast<Qt::CheckState>(checkState);
+    QTimer::singleShot(0, this, [repo, uuid_copy, state]()
+                       { repo->setCompletionAsync(uuid_copy, state); });
+    return true;
+}
+
+bool TaskListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < static_cast<int>(m_rows.size());
+}
+
+void TaskListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+
+    const int remaining = static_cast<int>(m_rows.size()) - m_fetched;
+    const int count = std::min(remaining, ARCHIVE_FETCH_BATCH);
+    if (count <= 0)
+        return;
+
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + count - 1);
+    m_fetched += count;
+    endInsertRows();
+}
@@ -0,0 +1,80 @@
+/** tasklistmodel.h
+ * List model over the tasks of one timeblock, in the repository's sorted order. A model shows
+ * either the active tasks or the archived (completed) ones. Rows hold pointers into the
+ * repository, so views only pay for the rows they paint.
+ *
+ * Archived models are dormant until activated and then expose their rows in batches through
+ * canFetchMore()/fetchMore(), so collapsed archive sections cost nothing.
+ */
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QString>
+
+#include <vector>
+
+#include "task.h"
+
+class CalendarRepository;
+
+class TaskListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum class Filter
+    {
+        ACTIVE = 0,   // Everything not yet complete (tasks and habits)
+        ARCHIVED = 1, // Completed tasks
+    };
+
+    enum Roles
+    {
+        TaskRole = Qt::UserRole + 1, // quintptr to the row's Task
+    };
+
+    TaskListModel(CalendarRepository *repo, Filter filter, QObject *parent = nullptr);
+
+    // Point the model at a timeblock and reload its rows
+    void setTimeblock(const QString &timeblockUuid);
+    const QString &timeblockUuid() const { return m_timeblockUuid; }
+
+    // Archived models only collect rows while active
+    void setActive(bool active);
+    bool isActive() const { return m_active; }
+
+    // Re-read one task after an edit: updates, moves, inserts or removes its row as needed
+    void syncTask(Task *task);
+    // Drop a task's row; safe after the task has been deleted from the repository
+    void removeTask(const QString &taskUuid);
+
+    static Task *taskAt(const QModelIndex &index);
+
+    // QAbstractListModel
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    struct Row
+    {
+        UUID uuid; // Copied so rows can be matched after their task is deleted
+        Task *task;
+    };
+
+    bool accepts(const Task *task) const;
+    int indexOf(const QString &taskUuid) const;
+    int targetRow(const Task *task) const; // Row `task` belongs at, counting only the other tasks
+    void reload();
+
+    CalendarRepository *m_repo = nullptr;
+    Filter m_filter;
+    QString m_timeblockUuid;
+    bool m_active = true;
+
+    std::vector<Row> m_rows; // Every matching task, in display order
+    int m_fetched = 0;       // Rows exposed to views so far; the rest wait for fetchMore
+};
@@ -4,7 +4,6 @@
 
 #include <QHBoxLayout>
 #include <QVBoxLayout>
-#include <QListWidgetItem>
 #include <QLabel>
 #include <QScrollArea>
 #include <QVariant>
@@ -14,13 +13,18 @@
 #include <QColor>
 #include <QSizePolicy>
 #include <QPushButton>
-#include <QListWidget>
+#include <QListView>
+#include <QItemSelectionModel>
+#include <QSignalBlocker>
+
+#include <algorithm>
 
 // --- Tools ---
 #include "guihelper.h"
 
-// --- Widgets ---
-#include "taskitemwidget.h"
+// --- Models and delegates ---
+#include "tasklistmodel.h"
+#include "taskitemdelegate.h"
 
 TodoListView::TodoListView(QWidget *parent, CalendarRepository *dataRepo)
     : QWidget(parent), repo(dataRepo)
@@ -34,6 +38,8 @@ TodoListView::TodoListView(QWidget *parent, CalendarRepository *dataRepo)
         throw std::runtime_error("No CalendarRepository provided to TodoListView");
     }
 
+    m_delegate = new TaskItemDelegate(this);
+
     // Container for all todo lists
     todoContainer = new QWidget(this);
     todoLayout = new QHBoxLayout(todoContainer);
@@ -60,7 +66,6 @@ void TodoListView::updateTasklists(const std::vector<Timeblock> &timeblocks)
     LOGI(TAG, "Updating task lists with %zu timeblocks.", timeblocks.size());
 
     // Remove old widgets from layout
-    // todo: Consider caching items to avoid constant redrawing
     while (QLayoutItem *item = todoLayout->takeAt(0))
     {
         QWidget *w = item->widget();
@@ -69,240 +74,378 @@ void TodoListView::updateTasklists(const std::vector<Timeblock> &timeblocks)
         delete item;
     }
 
-    todoLists.clear();
+    m_columns.clear();
 
     // Add lists to container instead of root directly
     for (const auto &tb : timeblocks)
     {
-        // LOGI(TAG, "Adding timeblock: %s with %zu tasks.", tb.name, tb.tasks.size());
-
-        // --- Container for label + list ---
-        QWidget *column = new QWidget(this);
-        QVBoxLayout *colLayout = new QVBoxLayout(column);
-        colLayout->setContentsMargins(0, 0, 0, 0);
-        colLayout->setSpacing(4);
-
-        // --- Label and compact status drop down at top ---
-
-        QWidget *titleRow = new QWidget(this);
-        QHBoxLayout *titleRowLayout = new QHBoxLayout(titleRow);
-        titleRowLayout->setContentsMargins(0, 0, 0, 0);
-        titleRowLayout->setSpacing(6);
-
-        QLabel *title = new QLabel(QString(tb.name), this);
-        title->setStyleSheet("font-weight: bold; font-size: 18px;");
-        // Make the title expand and center in the available space to the left
-        // of the status icon. The status combobox below uses a fixed size.
-        title->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-        title->setAlignment(Qt::AlignCenter);
-
-        QComboBox *statusDrop = new QComboBox(this);
-        // Small icon-only combo: Ongoing (blue), Stopped (red), Done (green)
-        const QSize iconSize(12, 12);
-        statusDrop->setIconSize(iconSize);
-        statusDrop->setFixedWidth(30);
-        statusDrop->setSizeAdjustPolicy(QComboBox::AdjustToContents);
-        statusDrop->setEditable(false);
-        // Hide the standard drop-down arrow so the small colored icon isn't obscured.
-        // This keeps the combo compact and visually an icon-only status marker.
-        statusDrop->setStyleSheet(
-            "QComboBox { border: none; background: transparent; padding: 0px; }"
-            "QComboBox::down-arrow { image: none; }");
-        statusDrop->addItem(makeColorIcon(QColor(0, 122, 255), iconSize), "");
-        statusDrop->addItem(makeColorIcon(QColor(204, 0, 0), iconSize), "");
-        statusDrop->addItem(makeColorIcon(QColor(24, 160, 0), iconSize), "");
-        statusDrop->addItem(makeColorIcon(QColor(255, 215, 1), iconSize), "");
-
-        // Map TimeblockStatus -> combo index
-        int tbStatusIndex = 0;
-        switch (tb.status)
+        // Refresh habit previews shown in the active lists
+        for (auto *task : tb.tasks)
         {
-        case TimeblockStatus::ONGOING:
-            tbStatusIndex = 0;
-            break;
-        case TimeblockStatus::STOPPED:
-            tbStatusIndex = 1;
-            break;
-        case TimeblockStatus::DONE:
-            tbStatusIndex = 2;
-            break;
-        case TimeblockStatus::PINNED:
-            tbStatusIndex = 3;
-            break;
+            if (task && task->status == TaskStatus::HABIT)
+                repo->habitCompletionPreview(*task);
         }
-        statusDrop->setCurrentIndex(tbStatusIndex);
 
-        // When the user changes the small status dropdown, persist via repository.
-        // Capture a copy of the timeblock (`tb`) so we can update its status and call repo.
-        connect(statusDrop, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, tb](int idx)
-                {
-                    Timeblock newTb = tb;
-                    // Map combo index to TimeblockStatus (same ordering)
-                    if (idx == 0)
-                        newTb.status = TimeblockStatus::ONGOING;
-                    else if (idx == 1)
-                        newTb.status = TimeblockStatus::STOPPED;
-                    else if (idx == 2)
-                    {
-                        newTb.status = TimeblockStatus::DONE;
-
-                        // Note completion time when marked done
-                        newTb.completed_datetime = time(nullptr);
-                    }
-                    else if (idx == 3)
-                        newTb.status = TimeblockStatus::PINNED;
-
-                    // Persist and refresh views
-                    if (repo)
-                        repo->updateTimeblock(newTb); });
-
-        // Add title (expanding) first, then the fixed-size status widget to the right.
-        statusDrop->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
-        titleRowLayout->addWidget(title);
-        titleRowLayout->addWidget(statusDrop);
-
-        colLayout->addWidget(titleRow);
-
-        // --- Todo list ---
-        QListWidget *todoList = new QListWidget(this);
-        todoList->setSelectionMode(QAbstractItemView::SingleSelection);
-        todoList->setMinimumWidth(300);
-        todoList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        connect(todoList, &QListWidget::currentItemChanged, this, &TodoListView::onListCurrentItemChanged);
-
-        colLayout->addWidget(todoList);
-        colLayout->setStretchFactor(todoList, 1);
-
-        // --- Archived tasks (collapsed by default) ---
-        QWidget *archivedWrapper = new QWidget(this);
-        QVBoxLayout *archLayout = new QVBoxLayout(archivedWrapper);
-        archLayout->setContentsMargins(0, 0, 0, 0);
-        archLayout->setSpacing(4);
-
-        // Collapse button at top of archived section (visible when expanded)
-        QPushButton *collapseArchivedBtn = new QPushButton("VVV", archivedWrapper);
-        collapseArchivedBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-        collapseArchivedBtn->setVisible(false);
-        archLayout->addWidget(collapseArchivedBtn);
+        addColumn(tb);
+    }
+}
 
-        // Archived list (hidden initially)
-        QListWidget *archivedList = new QListWidget(archivedWrapper);
-        archivedList->setSelectionMode(QAbstractItemView::SingleSelection);
-        archivedList->setMinimumWidth(300);
-        archivedList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        archivedList->setVisible(false);
-        archLayout->addWidget(archivedList);
+/* -------------------------------------------------------------------------- */
+/*                             Incremental updates                            */
+/* -------------------------------------------------------------------------- */
 
-        // Populate lists
-        for (auto *task : tb.tasks)
-        {
-            if (!task)
-            {
-                LOGW(TAG, "Encountered null task pointer in timeblock '%s'; skipping.", tb.name);
-                continue;
-            }
+void TodoListView::onTaskInserted(const QString &taskUuid, const QString &timeblockUuid)
+{
+    Task *task = repo->findTaskByUuid(taskUuid.toUtf8().constData());
+    Column *column = findColumn(timeblockUuid);
+    if (!task || !column)
+        return;
 
-            QListWidgetItem *item = new QListWidgetItem();
-            TaskItemWidget *widget = new TaskItemWidget(task, repo);
+    syncTask(*column, task);
+    reorderColumns();
+}
 
-            item->setSizeHint(widget->sizeHint());
-            if (task->status != TaskStatus::COMPLETE)
-            {
-                todoList->addItem(item);
-                todoList->setItemWidget(item, widget);
-                if (task->status == TaskStatus::HABIT)
-                {
-                    repo->habitCompletionPreview(*task);
-                }
-            }
-            else
-            {
-                archivedList->addItem(item);
-                archivedList->setItemWidget(item, widget);
-            }
-        }
+void TodoListView::onTaskUpdated(const QString &taskUuid)
+{
+    Task *task = repo->findTaskByUuid(taskUuid.toUtf8().constData());
+    if (!task)
+        return;
 
-        // Button shown when archived is collapsed; placed at bottom via stretch
-        QPushButton *showArchivedBtn = new QPushButton("^^^", this);
-        showArchivedBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    Column *column = findColumn(QString(task->timeblock_uuid.text()));
+    if (!column)
+        return;
 
-        // Add archived wrapper (hidden) and a spacer + button (button visible when collapsed)
-        colLayout->addWidget(archivedWrapper);
-        colLayout->addStretch();
-        colLayout->addWidget(showArchivedBtn);
+    syncTask(*column, task);
+    reorderColumns();
+}
 
-        // Handlers to toggle collapsed/expanded state
-        connect(showArchivedBtn, &QPushButton::clicked, this, [=]()
-                {
-            // Expand: hide the show button, reveal archivedWrapper and archivedList
-            showArchivedBtn->setVisible(false);
-            archivedWrapper->setVisible(true);
-            archivedList->setVisible(true);
-            collapseArchivedBtn->setVisible(true);
-            // Give equal vertical space to active and archived lists
-            int listIndex = colLayout->indexOf(todoList);
-            int archIndex = colLayout->indexOf(archivedWrapper);
-            if (listIndex >= 0 && archIndex >= 0)
-            {
-                colLayout->setStretch(listIndex, 1);
-                colLayout->setStretch(archIndex, 1);
-            } });
+void TodoListView::onTaskRemoved(const QString &taskUuid, const QString &timeblockUuid)
+{
+    Column *column = findColumn(timeblockUuid);
+    if (!column)
+        return;
+
+    column->todoModel->removeTask(taskUuid);
+    column->archivedModel->removeTask(taskUuid);
+    reorderColumns();
+}
+
+void TodoListView::onTaskMoved(const QString &taskUuid, const QString &fromTimeblockUuid, const QString &toTimeblockUuid)
+{
+    if (Column *from = findColumn(fromTimeblockUuid))
+    {
+        from->todoModel->removeTask(taskUuid);
+        from->archivedModel->removeTask(taskUuid);
+    }
+    onTaskInserted(taskUuid, toTimeblockUuid);
+}
+
+void TodoListView::onTimeblockInserted(const QString &timeblockUuid)
+{
+    Timeblock *tb = repo->findTimeblockByUuid(timeblockUuid.toUtf8().constData());
+    if (!tb || findColumn(timeblockUuid))
+        return;
+
+    addColumn(*tb);
+    reorderColumns();
+}
+
+void TodoListView::onTimeblockUpdated(const QString &timeblockUuid)
+{
+    Timeblock *tb = repo->findTimeblockByUuid(timeblockUuid.toUtf8().constData());
+    Column *column = findColumn(timeblockUuid);
+    if (!tb || !column)
+        return;
 
-        connect(collapseArchivedBtn, &QPushButton::clicked, this, [=]()
+    column->title->setText(QString(tb->name));
+    setColumnStatus(*column, tb->status);
+    reorderColumns();
+}
+
+void TodoListView::onTimeblockRemoved(const QString &timeblockUuid)
+{
+    auto it = std::find_if(m_columns.begin(), m_columns.end(), [&timeblockUuid](const Column &c)
+                           { return c.timeblockUuid == timeblockUuid; });
+    if (it == m_columns.end())
+        return;
+
+    // The column's models are owned by its list views and go with it
+    todoLayout->removeWidget(it->widget);
+    it->widget->deleteLater();
+    m_columns.erase(it);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+TodoListView::Column *TodoListView::findColumn(const QString &timeblockUuid)
+{
+    for (Column &c : m_columns)
+    {
+        if (c.timeblockUuid == timeblockUuid)
+            return &c;
+    }
+    return nullptr;
+}
+
+void TodoListView::setColumnStatus(Column &column, TimeblockStatus status)
+{
+    // Map TimeblockStatus -> combo index
+    int tbStatusIndex = 0;
+    switch (status)
+    {
+    case TimeblockStatus::ONGOING:
+        tbStatusIndex = 0;
+        break;
+    case TimeblockStatus::STOPPED:
+        tbStatusIndex = 1;
+        break;
+    case TimeblockStatus::DONE:
+        tbStatusIndex = 2;
+        break;
+    case TimeblockStatus::PINNED:
+        tbStatusIndex = 3;
+        break;
+    }
+    QSignalBlocker blocker(column.statusDrop);
+    column.statusDrop->setCurrentIndex(tbStatusIndex);
+}
+
+void TodoListView::syncTask(Column &column, Task *task)
+{
+    // Each model inserts, moves, repaints or drops the row depending on where the task now belongs
+    column.todoModel->syncTask(task);
+    column.archivedModel->syncTask(task);
+}
+
+void TodoListView::reorderColumns()
+{
+    const auto &timeblocks = repo->timeblocks();
+    int position = 0;
+    for (const Timeblock &tb : timeblocks)
+    {
+        Column *column = findColumn(QString(tb.uuid.text()));
+        if (!column)
+            continue;
+
+        // Only move columns that are out of place
+        QLayoutItem *current = todoLayout->itemAt(position);
+        if (!current || current->widget() != column->widget)
+        {
+            todoLayout->removeWidget(column->widget);
+            todoLayout->insertWidget(position, column->widget);
+        }
+        position++;
+    }
+}
+
+void TodoListView::addColumn(const Timeblock &tb)
+{
+    Column col;
+    col.timeblockUuid = QString(tb.uuid.text());
+
+    // --- Container for label + list ---
+    QWidget *column = new QWidget(this);
+    QVBoxLayout *colLayout = new QVBoxLayout(column);
+    colLayout->setContentsMargins(0, 0, 0, 0);
+    colLayout->setSpacing(4);
+    col.widget = column;
+
+    // --- Label and compact status drop down at top ---
+
+    QWidget *titleRow = new QWidget(this);
+    QHBoxLayout *titleRowLayout = new QHBoxLayout(titleRow);
+    titleRowLayout->setContentsMargins(0, 0, 0, 0);
+    titleRowLayout->setSpacing(6);
+
+    QLabel *title = new QLabel(QString(tb.name), this);
+    title->setStyleSheet("font-weight: bold; font-size: 18px;");
+    // Make the title expand and center in the available space to the left
+    // of the status icon. The status combobox below uses a fixed size.
+    title->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    title->setAlignment(Qt::AlignCenter);
+    col.title = title;
+
+    QComboBox *statusDrop = new QComboBox(this);
+    // Small icon-only combo: Ongoing (blue), Stopped (red), Done (green)
+    const QSize iconSize(12, 12);
+    statusDrop->setIconSize(iconSize);
+    statusDrop->setFixedWidth(30);
+    statusDrop->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    statusDrop->setEditable(false);
+    // Hide the standard drop-down arrow so the small colored icon isn't obscured.
+    // This keeps the combo compact and visually an icon-only status marker.
+    statusDrop->setStyleSheet(
+        "QComboBox { border: none; background: transparent; padding: 0px; }"
+        "QComboBox::down-arrow { image: none; }");
+    statusDrop->addItem(makeColorIcon(QColor(0, 122, 255), iconSize), "");
+    statusDrop->addItem(makeColorIcon(QColor(204, 0, 0), iconSize), "");
+    statusDrop->addItem(makeColorIcon(QColor(24, 160, 0), iconSize), "");
+    statusDrop->addItem(makeColorIcon(QColor(255, 215, 1), iconSize), "");
+    col.statusDrop = statusDrop;
+    setColumnStatus(col, tb.status);
+
+    // When the user changes the small status dropdown, persist via repository.
+    // Look the timeblock up when the change happens, since the column outlives edits to it.
+    QString tbUuid = col.timeblockUuid;
+    connect(statusDrop, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, tbUuid](int idx)
+            {
+                Timeblock *current = repo ? repo->findTimeblockByUuid(tbUuid.toUtf8().constData()) : nullptr;
+                if (!current)
+                    return;
+                Timeblock newTb = *current;
+                // Map combo index to TimeblockStatus (same ordering)
+                if (idx == 0)
+                    newTb.status = TimeblockStatus::ONGOING;
+                else if (idx == 1)
+                    newTb.status = TimeblockStatus::STOPPED;
+                else if (idx == 2)
                 {
-            // Collapse: hide wrapper, show the show button at bottom
-            archivedList->setVisible(false);
-            collapseArchivedBtn->setVisible(false);
-            archivedWrapper->setVisible(false);
-            showArchivedBtn->setVisible(true);
-            // Restore stretch so main list takes natural space
-            int listIndex = colLayout->indexOf(todoList);
-            int archIndex = colLayout->indexOf(archivedWrapper);
-            if (listIndex >= 0 && archIndex >= 0)
+                    newTb.status = TimeblockStatus::DONE;
+
+                    // Note completion time when marked done
+                    newTb.completed_datetime = time(nullptr);
+                }
+                else if (idx == 3)
+                    newTb.status = TimeblockStatus::PINNED;
+
+                // Persist and refresh views
+                repo->updateTimeblock(newTb); });
+
+    // Add title (expanding) first, then the fixed-size status widget to the right.
+    statusDrop->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
+    titleRowLayout->addWidget(title);
+    titleRowLayout->addWidget(statusDrop);
+
+    colLayout->addWidget(titleRow);
+
+    // --- Todo list ---
+    // Rows are painted by the shared delegate straight from the model; no widgets per task
+    QListView *todoList = new QListView(this);
+    todoList->setSelectionMode(QAbstractItemView::SingleSelection);
+    todoList->setMinimumWidth(300);
+    todoList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    todoList->setUniformItemSizes(true);
+    TaskListModel *todoModel = new TaskListModel(repo, TaskListModel::Filter::ACTIVE, todoList);
+    todoModel->setTimeblock(col.timeblockUuid);
+    col.todoModel = todoModel;
+    todoList->setItemDelegate(m_delegate);
+    todoList->setModel(todoModel);
+    connect(todoList->selectionModel(), &QItemSelectionModel::currentChanged, this, &TodoListView::onCurrentTaskChanged);
+    col.todoList = todoList;
+
+    colLayout->addWidget(todoList);
+    colLayout->setStretchFactor(todoList, 1);
+
+    // --- Archived tasks (collapsed by default) ---
+    QWidget *archivedWrapper = new QWidget(this);
+    QVBoxLayout *archLayout = new QVBoxLayout(archivedWrapper);
+    archLayout->setContentsMargins(0, 0, 0, 0);
+    archLayout->setSpacing(4);
+
+    // Collapse button at top of archived section (visible when expanded)
+    QPushButton *collapseArchivedBtn = new QPushButton("VVV", archivedWrapper);
+    collapseArchivedBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    collapseArchivedBtn->setVisible(false);
+    archLayout->addWidget(collapseArchivedBtn);
+
+    // Archived list (hidden initially). Its model stays empty until the section is expanded,
+    // then pages rows in as the list scrolls.
+    QListView *archivedList = new QListView(archivedWrapper);
+    archivedList->setSelectionMode(QAbstractItemView::SingleSelection);
+    archivedList->setMinimumWidth(300);
+    archivedList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    archivedList->setUniformItemSizes(true);
+    TaskListModel *archivedModel = new TaskListModel(repo, TaskListModel::Filter::ARCHIVED, archivedList);
+    archivedModel->setTimeblock(col.timeblockUuid);
+    col.archivedModel = archivedModel;
+    archivedList->setItemDelegate(m_delegate);
+    archivedList->setModel(archivedModel);
+    archivedList->setVisible(false);
+    archLayout->addWidget(archivedList);
+    col.archivedList = archivedList;
+
+    // Button shown when archived is collapsed; placed at bottom via stretch
+    QPushButton *showArchivedBtn = new QPushButton("^^^", this);
+    showArchivedBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
+    // Add archived wrapper (hidden) and a spacer + button (button visible when collapsed)
+    colLayout->addWidget(archivedWrapper);
+    colLayout->addStretch();
+    colLayout->addWidget(showArchivedBtn);
+
+    // Handlers to toggle collapsed/expanded state
+    connect(showArchivedBtn, &QPushButton::clicked, this, [=]()
             {
-                colLayout->setStretch(listIndex, 1);
-                colLayout->setStretch(archIndex, 0);
-            } });
+        // Expand: hide the show button, load and reveal archivedWrapper and archivedList
+        archivedModel->setActive(true);
+        showArchivedBtn->setVisible(false);
+        archivedWrapper->setVisible(true);
+        archivedList->setVisible(true);
+        collapseArchivedBtn->setVisible(true);
+        // Give equal vertical space to active and archived lists
+        int listIndex = colLayout->indexOf(todoList);
+        int archIndex = colLayout->indexOf(archivedWrapper);
+        if (listIndex >= 0 && archIndex >= 0)
+        {
+            colLayout->setStretch(listIndex, 1);
+            colLayout->setStretch(archIndex, 1);
+        } });
 
-        // Track list for backend
-        todoLists.append(todoList);
+    connect(collapseArchivedBtn, &QPushButton::clicked, this, [=]()
+            {
+        // Collapse: hide wrapper, show the show button at bottom
+        archivedList->setVisible(false);
+        collapseArchivedBtn->setVisible(false);
+        archivedWrapper->setVisible(false);
+        showArchivedBtn->setVisible(true);
+        archivedModel->setActive(false); // Release the archived rows
+        // Restore stretch so main list takes natural space
+        int listIndex = colLayout->indexOf(todoList);
+        int archIndex = colLayout->indexOf(archivedWrapper);
+        if (listIndex >= 0 && archIndex >= 0)
+        {
+            colLayout->setStretch(listIndex, 1);
+            colLayout->setStretch(archIndex, 0);
+        } });
 
-        // Add column to main horizontal layout
-        todoLayout->addWidget(column);
-    }
+    // Track column and add it to the main horizontal layout
+    m_columns.push_back(col);
+    todoLayout->addWidget(column);
 }
 
-void TodoListView::onListCurrentItemChanged(QListWidgetItem *current, QListWidgetItem * /*previous*/)
+void TodoListView::onCurrentTaskChanged(const QModelIndex &current, const QModelIndex & /*previous*/)
 {
-    const char *TAG = "TodoListView::onListCurrentItemChanged";
+    if (m_clearingSelection)
+        return;
 
-    QListWidget *list = qobject_cast<QListWidget *>(sender());
-    if (!list)
+    QItemSelectionModel *selection = qobject_cast<QItemSelectionModel *>(sender());
+    if (!selection)
         return;
 
-    if (!current)
+    Task *task = TaskListModel::taskAt(current);
+    if (!task)
     {
         emit taskDeselected();
         return;
     }
 
     // Deselect items in other lists to ensure only the newly-selected item
-    // appears selected. Block their signals while doing this to avoid
+    // appears selected. Ignore the current-index changes this causes to avoid
     // recursive selection-change handling.
-    for (QListWidget *other : todoLists)
+    m_clearingSelection = true;
+    for (const Column &column : m_columns)
     {
-        if (other == list)
+        QListView *other = column.todoList;
+        if (other->selectionModel() == selection)
             continue;
-        other->blockSignals(true);
         other->clearSelection();
-        other->setCurrentItem(nullptr);
-        other->blockSignals(false);
+        other->setCurrentIndex(QModelIndex());
     }
+    m_clearingSelection = false;
 
-    TaskItemWidget *w = qobject_cast<TaskItemWidget *>(list->itemWidget(current));
-
-    emit taskSelected(&w->task());
-    return;
+    emit taskSelected(task);
 }
 
 //! Depreciated: TaskItemWidget now persists directly to the repository; no need for TodoListView to also handle completionToggled to avoid duplicate persistence operations.
@@ -343,13 +486,13 @@ void TodoListView::onTaskCompleted(const Task &task, int checkState)
     LOGI(TAG, "Task <%s> marked as %s (state %d)", task.name, state_str, checkState);
 
     // Update task status
-    Task new_task = task;
+    TaskPatch patch;
     if (checkState == Qt::Unchecked)
-        new_task.status = TaskStatus::INCOMPLETE;
+        patch.set_status(TaskStatus::INCOMPLETE);
     else if (checkState == Qt::PartiallyChecked)
-        new_task.status = TaskStatus::IN_PROGRESS;
+        patch.set_status(TaskStatus::IN_PROGRESS);
     else if (checkState == Qt::Checked)
-        new_task.status = TaskStatus::COMPLETE;
+        patch.set_status(TaskStatus::COMPLETE);
 
-    repo->updateTask(new_task);
+    repo->patchTask(task.uuid, patch);
 }
\ No newline at end of file
@@ -2,35 +2,69 @@
 
 #include <QWidget>
 #include <QLabel>
-#include <QListWidget>
-#include <QListWidgetItem>
+#include <QListView>
 #include <QHBoxLayout>
 #include <QVector>
+#include <QComboBox>
 
 #include "timeblock.h"
 #include "calendarrepository.h"
 
+class TaskListModel;
+class TaskItemDelegate;
+
 class TodoListView : public QWidget
 {
     Q_OBJECT
 public:
     explicit TodoListView(QWidget *parent = nullptr, CalendarRepository *dataRepo = nullptr);
-    void updateTasklists(const std::vector<Timeblock> &timeblocks);
+    void updateTasklists(const std::vector<Timeblock> &timeblocks); // Full rebuild
 
 signals:
     void taskSelected(const Task *task);
     void taskDeselected();
 
+public slots:
+    // Incremental updates from CalendarRepository; each touches only the affected rows/columns
+    void onTaskInserted(const QString &taskUuid, const QString &timeblockUuid);
+    void onTaskUpdated(const QString &taskUuid);
+    void onTaskRemoved(const QString &taskUuid, const QString &timeblockUuid);
+    void onTaskMoved(const QString &taskUuid, const QString &fromTimeblockUuid, const QString &toTimeblockUuid);
+    void onTimeblockInserted(const QString &timeblockUuid);
+    void onTimeblockUpdated(const QString &timeblockUuid);
+    void onTimeblockRemoved(const QString &timeblockUuid);
+
 private slots:
-    void onListCurrentItemChanged(QListWidgetItem *current, QListWidgetItem *previous);
+    void onCurrentTaskChanged(const QModelIndex &current, const QModelIndex &previous);
 
     // Manage task completion toggles (receives Qt::CheckState values)
     void onTaskCompleted(const Task &task, int checkState);
 
 private:
+    // Widgets making up one timeblock column
+    struct Column
+    {
+        QString timeblockUuid;
+        QWidget *widget = nullptr;
+        QLabel *title = nullptr;
+        QComboBox *statusDrop = nullptr;
+        QListView *todoList = nullptr;
+        QListView *archivedList = nullptr;
+        TaskListModel *todoModel = nullptr;
+        TaskListModel *archivedModel = nullptr; // Dormant until the archive section is expanded
+    };
+
+    Column *findColumn(const QString &timeblockUuid);
+    void addColumn(const Timeblock &tb);
+    void setColumnStatus(Column &column, TimeblockStatus status);
+    void syncTask(Column &column, Task *task); // Update the task's row in both of the column's lists
+    void reorderColumns(); // Match the repository's timeblock order without rebuilding columns
+
     CalendarRepository *repo = nullptr;
 
-    QVector<QListWidget *> todoLists;
+    std::vector<Column> m_columns;
+    TaskItemDelegate *m_delegate = nullptr; // Paints the rows of every list
+    bool m_clearingSelection = false;       // Ignore current-index changes made while deselecting other lists
     QWidget *todoContainer;
     QHBoxLayout *todoLayout;
 };
\ No newline at end of file
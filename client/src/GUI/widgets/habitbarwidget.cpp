@@ -24,27 +24,33 @@ void HabitBarWidget::paintEvent(QPaintEvent *)
         return;
 
     QPainter painter(this);
+    paintBar(painter, rect(), m_values);
+}
+
+void HabitBarWidget::paintBar(QPainter &painter, const QRect &area, const TaskStatus *values)
+{
+    painter.save();
     painter.setRenderHint(QPainter::Antialiasing, false);
 
     const int n = 7;
-    const int cellWidth = width() / n;
-    const int cellHeight = height();
+    const int cellWidth = area.width() / n;
+    const int cellHeight = area.height();
 
     painter.setPen(Qt::white);
     for (int i = 0; i < n; ++i)
     {
         const int spacing = 1;
-        QRect rect(i * cellWidth + spacing,
-                   spacing,
+        QRect rect(area.left() + i * cellWidth + spacing,
+                   area.top() + spacing,
                    cellWidth - spacing * 2,
                    cellHeight - spacing * 2);
 
-        if (m_values[i] == TaskStatus::COMPLETE)
+        if (values[i] == TaskStatus::COMPLETE)
         {
             painter.fillRect(rect, Qt::green);
             painter.setPen(Qt::darkBlue);
         }
-        else if (m_values[i] == TaskStatus::IN_PROGRESS)
+        else if (values[i] == TaskStatus::IN_PROGRESS)
         {
             painter.fillRect(rect, Qt::blue);
             painter.setPen(Qt::white);
@@ -57,11 +63,12 @@ void HabitBarWidget::paintEvent(QPaintEvent *)
 
         // --- Draw days of week labels ---
 
-        // Assume m_values[0] is today, m_values[1] is yesterday, etc. so label from right to left
+        // Assume values[0] is today, values[1] is yesterday, etc. so label from right to left
         int dayOfWeek = QDate::currentDate().dayOfWeek();
 
         painter.setFont(QFont("Arial", 8));
         QString dayLabel = QDate::shortDayName((dayOfWeek + 6 - i) % 7 + 1); // 1=Mon, 7=Sun
         painter.drawText(rect, Qt::AlignCenter, dayLabel);
     }
+    painter.restore();
 }
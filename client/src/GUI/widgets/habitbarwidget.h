@@ -3,6 +3,8 @@
 #include "task.h"
 #include <QWidget>
 
+class QPainter;
+
 class HabitBarWidget : public QWidget
 {
     Q_OBJECT
@@ -12,6 +14,9 @@ public:
 
     void setValues(const TaskStatus *values);
 
+    // Draw seven completion cells (values[0] = today) into `rect`; shared with the task item delegate
+    static void paintBar(QPainter &painter, const QRect &rect, const TaskStatus *values);
+
 protected:
     void paintEvent(QPaintEvent *event) override;
 
@@ -0,0 +1,182 @@
+#include "taskitemdelegate.h"
+#include "habitbarwidget.h"
+
+#include "tasklistmodel.h"
+
+#include <QApplication>
+#include <QFontMetrics>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionButton>
+
+#include <algorithm>
+
+#define ROW_MARGIN 8        // Matches the TaskItemWidget layout margins
+#define ROW_SPACING 4       // Between the three lines of a row
+#define CHECK_SPACING 8     // Between the checkbox and the name
+#define HABIT_BAR_HEIGHT 30 // HabitBarWidget minimum height
+
+static QFont name_font(const QFont &base)
+{
+    QFont f = base;
+    f.setBold(true);
+    f.setPointSize(12);
+    return f;
+}
+
+static const QStyle *style_for(const QStyleOptionViewItem &option)
+{
+    return option.widget ? option.widget->style() : QApplication::style();
+}
+
+// Height of the checkbox + name line
+static int top_line_height(const QStyleOptionViewItem &option)
+{
+    int indicator = style_for(option)->pixelMetric(QStyle::PM_IndicatorHeight, &option, option.widget);
+    return std::max(indicator, QFontMetrics(name_font(option.font)).height());
+}
+
+TaskItemDelegate::TaskItemDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+QRect TaskItemDelegate::checkRect(const QStyleOptionViewItem &option) const
+{
+    const QStyle *style = style_for(option);
+    int w = style->pixelMetric(QStyle::PM_IndicatorWidth, &option, option.widget);
+    int h = style->pixelMetric(QStyle::PM_IndicatorHeight, &option, option.widget);
+    int top = option.rect.top() + ROW_MARGIN + (top_line_height(option) - h) / 2;
+    return QRect(option.rect.left() + ROW_MARGIN, top, w, h);
+}
+
+QSize TaskItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex & /*index*/) const
+{
+    // Habits and tasks share one height so views can use uniform row sizes
+    int textHeight = QFontMetrics(option.font).height();
+    int height = ROW_MARGIN + top_line_height(option) + ROW_SPACING + std::max(HABIT_BAR_HEIGHT, textHeight) + ROW_SPACING + textHeight + ROW_MARGIN;
+    return QSize(300, height);
+}
+
+void TaskItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const Task *task = TaskListModel::taskAt(index);
+    if (!task)
+    {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    const QStyle *style = style_for(opt);
+
+    painter->save();
+
+    // Background and selection highlight
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+
+    // --- Top line: completion checkbox + name ---
+    const Qt::CheckState checkState = static_cast<Qt::CheckState>(index.data(Qt::CheckStateRole).toInt());
+    QStyleOptionButton box;
+    box.rect = checkRect(opt);
+    box.state = QStyle::State_None;
+    if (index.flags() & Qt::ItemIsUserCheckable)
+        box.state |= QStyle::State_Enabled;
+    if (checkState == Qt::Checked)
+        box.state |= QStyle::State_On;
+    else if (checkState == Qt::PartiallyChecked)
+        box.state |= QStyle::State_NoChange;
+    else
+        box.state |= QStyle::State_Off;
+    style->drawPrimitive(QStyle::PE_IndicatorCheckBox, &box, painter, opt.widget);
+
+    const bool selected = opt.state & QStyle::State_Selected;
+    painter->setPen(opt.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+
+    const int left = box.rect.right() + 1 + CHECK_SPACING;
+    const int right = opt.rect.right() - ROW_MARGIN;
+    int top = opt.rect.top() + ROW_MARGIN;
+    const int topHeight = top_line_height(opt);
+
+    QFont nameFont = name_font(opt.font);
+    nameFont.setStrikeOut(checkState == Qt::Checked);
+    painter->setFont(nameFont);
+    QRect nameRect(left, top, right - left, topHeight);
+    painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter, QFontMetrics(nameFont).elidedText(opt.text, Qt::ElideRight, nameRect.width()));
+    top += topHeight + ROW_SPACING;
+
+    // --- Due date *or* habit info ---
+    painter->setFont(opt.font);
+    const int textHeight = QFontMetrics(opt.font).height();
+    const int middleHeight = std::max(HABIT_BAR_HEIGHT, textHeight);
+    const QRect contentRect(opt.rect.left() + ROW_MARGIN, top, right - opt.rect.left() - ROW_MARGIN, middleHeight);
+    if (task->status == TaskStatus::HABIT)
+    {
+        HabitBarWidget::paintBar(*painter, contentRect, task->completed_days);
+        painter->setPen(opt.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+        painter->setFont(opt.font);
+    }
+    else
+    {
+        painter->drawText(contentRect, Qt::AlignLeft | Qt::AlignVCenter, QString::fromStdString("Due: " + task->due_date_string()));
+    }
+    top += middleHeight + ROW_SPACING;
+
+    // --- Priority + Scope ---
+    QRect detailsRect(opt.rect.left() + ROW_MARGIN, top, contentRect.width(), textHeight);
+    painter->drawText(detailsRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      "Priority: " + QString::fromStdString(task->priority_string()) + ", Scope: " + QString::fromStdString(task->scope_string()));
+
+    painter->restore();
+}
+
+bool TaskItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (!(index.flags() & Qt::ItemIsUserCheckable))
+        return false;
+
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick:
+    {
+        // Swallow presses on the checkbox so they do not also change selection
+        QMouseEvent *me = static_cast<QMouseEvent *>(event);
+        return me->button() == Qt::LeftButton && checkRect(option).contains(me->pos());
+    }
+    case QEvent::MouseButtonRelease:
+    {
+        QMouseEvent *me = static_cast<QMouseEvent *>(event);
+        if (me->button() != Qt::LeftButton || !checkRect(option).contains(me->pos()))
+            return false;
+        break;
+    }
+    case QEvent::KeyPress:
+    {
+        QKeyEvent *ke = static_cast<QKeyEvent *>(event);
+        if (ke->key() != Qt::Key_Space && ke->key() != Qt::Key_Select)
+            return false;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    // Same cycle as a tristate QCheckBox for tasks; habits are binary
+    const Task *task = TaskListModel::taskAt(index);
+    const Qt::CheckState state = static_cast<Qt::CheckState>(index.data(Qt::CheckStateRole).toInt());
+    Qt::CheckState next;
+    if (task && task->status == TaskStatus::HABIT)
+        next = (state == Qt::Checked) ? Qt::Unchecked : Qt::Checked;
+    else if (state == Qt::Unchecked)
+        next = Qt::PartiallyChecked;
+    else if (state == Qt::PartiallyChecked)
+        next = Qt::Checked;
+    else
+        next = Qt::Unchecked;
+
+    return model->setData(index, next, Qt::CheckStateRole);
+}
@@ -0,0 +1,26 @@
+/** taskitemdelegate.h
+ * Paints a task row for TaskListModel: completion checkbox and name, then the due date or
+ * the habit's week bar, then priority and scope. Same layout as a FULL TaskItemWidget, but
+ * drawn directly so no widgets exist per row. Checkbox clicks are written back through
+ * the model.
+ */
+
+#pragma once
+
+#include <QStyledItemDelegate>
+
+class TaskItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit TaskItemDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+private:
+    QRect checkRect(const QStyleOptionViewItem &option) const;
+};
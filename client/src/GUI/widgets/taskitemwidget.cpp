@@ -33,31 +33,8 @@ TaskItemWidget::TaskItemWidget(Task *t, CalendarRepository *repo, QWidget *paren
     QHBoxLayout *topRow = new QHBoxLayout;
 
     m_doneCheck = new QCheckBox(this);
-    bool completed = false;
-    // If it's a task (not habit), set tristate based on status
-    if (m_task->status != TaskStatus::HABIT)
-    {
-        m_doneCheck->setTristate(true);
-        if (m_task->status == TaskStatus::INCOMPLETE)
-        {
-            m_doneCheck->setCheckState(Qt::Unchecked);
-        }
-        else if (m_task->status == TaskStatus::IN_PROGRESS)
-        {
-            m_doneCheck->setCheckState(Qt::PartiallyChecked);
-        }
-        else if (m_task->status == TaskStatus::COMPLETE)
-        {
-            m_doneCheck->setCheckState(Qt::Checked);
-            completed = true;
-        }
-    }
-    else
-    {
-        // For habits, just use binary checked/unchecked
-        completed = (m_task->completed_days[0] == TaskStatus::COMPLETE);
-        m_doneCheck->setCheckState(completed ? Qt::Checked : Qt::Unchecked);
-    }
+    m_isHabit = (m_task->status == TaskStatus::HABIT);
+    bool completed = syncCheckState();
 
     // Use stateChanged(int) so we can handle tristate for tasks and binary for habits
     if (mode != Mode::PREVIEW)
@@ -115,20 +92,50 @@ TaskItemWidget::TaskItemWidget(Task *t, CalendarRepository *repo, QWidget *paren
     // --- Due date *or* habit info ---
     if (m_task->status == TaskStatus::HABIT)
     {
-        HabitBarWidget *habitInfo = new HabitBarWidget(this);
-        habitInfo->setValues(m_task->completed_days);
-        layout->addWidget(habitInfo);
+        m_habitBar = new HabitBarWidget(this);
+        m_habitBar->setValues(m_task->completed_days);
+        layout->addWidget(m_habitBar);
     }
     else
     {
         // Due date
-        QLabel *due = new QLabel(QString::fromStdString("Due: " + m_task->due_date_string()), this);
-        layout->addWidget(due);
+        m_dueLabel = new QLabel(QString::fromStdString("Due: " + m_task->due_date_string()), this);
+        layout->addWidget(m_dueLabel);
     }
 
     // --- Priority + Scope ---
-    QLabel *urgency = new QLabel("Priority: " + QString::fromStdString(m_task->priority_string()) + ", Scope: " + QString::fromStdString(m_task->scope_string()), this);
-    layout->addWidget(urgency);
+    m_detailsLabel = new QLabel("Priority: " + QString::fromStdString(m_task->priority_string()) + ", Scope: " + QString::fromStdString(m_task->scope_string()), this);
+    layout->addWidget(m_detailsLabel);
+}
+
+// Tasks use a tristate box (incomplete / in progress / complete); habits are checked when done today
+bool TaskItemWidget::syncCheckState()
+{
+    bool completed = false;
+    if (!m_isHabit)
+    {
+        m_doneCheck->setTristate(true);
+        if (m_task->status == TaskStatus::INCOMPLETE)
+        {
+            m_doneCheck->setCheckState(Qt::Unchecked);
+        }
+        else if (m_task->status == TaskStatus::IN_PROGRESS)
+        {
+            m_doneCheck->setCheckState(Qt::PartiallyChecked);
+        }
+        else if (m_task->status == TaskStatus::COMPLETE)
+        {
+            m_doneCheck->setCheckState(Qt::Checked);
+            completed = true;
+        }
+    }
+    else
+    {
+        // For habits, just use binary checked/unchecked
+        completed = (m_task->completed_days[0] == TaskStatus::COMPLETE);
+        m_doneCheck->setCheckState(completed ? Qt::Checked : Qt::Unchecked);
+    }
+    return completed;
 }
 
 // Convenience constructor for strictly preview mode (no repo reference, no interaction, only reading from a const Task pointer)
@@ -156,61 +163,13 @@ void TaskItemWidget::onCompletionChanged(int checkState)
     // If we have a repository pointer, handle persistence directly from here
     if (m_repo)
     {
-        // For habits, add/remove today's entry asynchronously
-        if (m_task->status == TaskStatus::HABIT)
-        {
-            time_t now = time(nullptr);
-            // capture minimal data (uuid + timestamp) instead of entire Task
-            std::string uuid_copy(m_task->uuid);
-            if (checkState == Qt::Checked)
-            {
-                QTimer::singleShot(0, this, [this, uuid_copy, now]() {
-                    if (m_repo)
-                    {
-                        m_repo->addHabitEntry(uuid_copy.c_str(), now);
-                        // update due date / urgency; repository will mutate the live task
-                        Task *t = m_repo->findTaskByUuid(uuid_copy.c_str());
-                        if (t)
-                            m_repo->updateTask(*t);
-                    }
-                });
-            }
-            else if (checkState == Qt::Unchecked)
-            {
-                QTimer::singleShot(0, this, [this, uuid_copy, now]() {
-                    if (m_repo)
-                        m_repo->removeHabitEntry(uuid_copy.c_str(), now);
-                });
-            }
-            return;
-        }
-
-        // For non-habits, update task status and persist asynchronously
-        TaskStatus newStatus = m_task->status;
-        time_t completeTime = 0;
-        if (checkState == Qt::Unchecked)
-            newStatus = TaskStatus::INCOMPLETE;
-        else if (checkState == Qt::PartiallyChecked)
-            newStatus = TaskStatus::IN_PROGRESS;
-        else if (checkState == Qt::Checked)
-        {
-            newStatus = TaskStatus::COMPLETE;
-            completeTime = time(nullptr);
-        }
-        std::string uuid_copy(m_task->uuid);
-
-        QTimer::singleShot(0, this, [this, uuid_copy, newStatus, completeTime]() {
+        // Habit entry or status, written asynchronously; capture minimal data (uuid + check
+        // state) instead of entire Task
+        UUID uuid_copy = m_task->uuid;
+        const Qt::CheckState state = static_cast<Qt::CheckState>(checkState);
+        QTimer::singleShot(0, this, [this, uuid_copy, state]() {
             if (m_repo)
-            {
-                Task *t = m_repo->findTaskByUuid(uuid_copy.c_str());
-                if (t)
-                {
-                    t->status = newStatus;
-                    if (newStatus == TaskStatus::COMPLETE)
-                        t->completed_datetime = completeTime;
-                    m_repo->updateTask(*t);
-                }
-            }
+                m_repo->setCompletionAsync(uuid_copy, state);
         });
     }
 }
@@ -11,6 +11,7 @@ class QResizeEvent;
 
 // Forward declaration to avoid header include here
 class CalendarRepository;
+class HabitBarWidget;
 
 class TaskItemWidget : public QWidget
 {
@@ -22,6 +23,12 @@ private:
     QCheckBox *m_doneCheck = nullptr;
     CalendarRepository *m_repo = nullptr;
     QLabel *m_priorityLabel = nullptr;
+    QLabel *m_dueLabel = nullptr;        // FULL mode, tasks only
+    HabitBarWidget *m_habitBar = nullptr; // FULL mode, habits only
+    QLabel *m_detailsLabel = nullptr;    // FULL mode
+    bool m_isHabit = false;
+
+    bool syncCheckState(); // set the checkbox from the task; returns true if shown as done
 
 public:
     enum class Mode
@@ -1,8 +1,10 @@
 #include "calendarrepository.h"
+#include "clientconfig.h"
 #include "uuid.h"
 #include "log.h"
 
 #include <time.h>
+#include <cmath>
 #include <algorithm>
 #include <numeric>
 #include <cstring>
@@ -12,19 +14,25 @@
 /* -------------------------------------------------------------------------- */
 
 CalendarRepository::CalendarRepository()
-    : m_synchronizer(new Synchronizer(m_db, this))
+    : CalendarRepository(ClientConfig::storageProfile())
 {
-    connect(m_synchronizer, &Synchronizer::syncCompleted, this, [this]()
-            {
-                m_db.clear_receipts(); // Clear receipts on completed sync
-                LOGI("CalendarRepository", "Sync completed, reloading all data from database");
-                loadAll(); });
+}
+
+CalendarRepository::CalendarRepository(const StorageProfile &profile)
+    : m_db(DATABASE_PATH, profile),
+      m_scheduler(new SyncScheduler(DATABASE_PATH, profile, this)),
+      m_worker(DATABASE_PATH, profile)
+{
+    connect(m_scheduler, &SyncScheduler::serverChangesApplied, this, &CalendarRepository::applyServerChanges);
+    connect(m_scheduler, &SyncScheduler::syncCompleted, this, []()
+            { LOGI("CalendarRepository", "Sync completed"); }); // Acknowledged receipts were pruned page by page
     loadAll();
+    m_scheduler->start();
 }
 
 CalendarRepository::~CalendarRepository()
 {
-    delete m_synchronizer;
+    delete m_scheduler; // Stops the sync thread before the connections it shares the file with close
 }
 
 /* -------------------------------------------------------------------------- */
@@ -50,41 +58,140 @@ void CalendarRepository::loadAll()
     const char *TAG = "CalendarRepository::loadAll";
     LOGI(TAG, "Loading all timeblocks and tasks from database...");
 
-    // Clear current in-memory model
-    m_timeblocks.clear();
+    ModelSnapshot snapshot;
+    readModel(db(), snapshot);
+    applyModel(snapshot);
+}
 
-    // Load timeblocks and task data from database
-    m_db.load_timeblocks(m_timeblocks);
-    m_db.load_tasks(m_tasks);
+void CalendarRepository::loadAllAsync()
+{
+    const char *TAG = "CalendarRepository::loadAllAsync";
+    LOGI(TAG, "Queueing a load of all timeblocks and tasks");
 
-    // Fill tasks with relational data
-    for (auto &[uuid, taskptr] : m_tasks)
+    const unsigned serial = m_modelSerial;
+    m_worker.submit([this, serial](Database &db)
+                    {
+        auto snapshot = std::make_shared<ModelSnapshot>();
+        try
+        {
+            readModel(db, *snapshot);
+        }
+        catch (int err)
+        {
+            LOGE("CalendarRepository::loadAllAsync", "Failed to read model: %d", err);
+            return;
+        }
+
+        // Hand the snapshot to the GUI thread, which owns the model
+        QMetaObject::invokeMethod(this, [this, serial, snapshot]()
+                                  {
+            if (serial != m_modelSerial)
+            {
+                // Edited while the read was in flight; the edits' writes are queued ahead of a new read
+                LOGI("CalendarRepository::loadAllAsync", "Model changed during load, reading again");
+                loadAllAsync();
+                return;
+            }
+            applyModel(*snapshot); }, Qt::QueuedConnection); });
+}
+
+// Read timeblocks, tasks, dependency links and habit previews, and sort each timeblock's tasks.
+// Only the snapshot is touched, so this can run on the worker thread while the GUI keeps using
+// the current model.
+void CalendarRepository::readModel(Database &db, ModelSnapshot &snapshot)
+{
+    db.load_timeblocks(snapshot.timeblocks);
+    db.load_tasks(snapshot.tasks);
+    TaskHash &tasks = snapshot.tasks;
+
+    // Fill tasks with relational data. Links and habit entries are each fetched with a single
+    // query and joined in memory, rather than querying once per task.
+    std::vector<std::pair<UUID, UUID>> links;
+    db.load_entry_links(LinkType::DEPENDENCY, links);
+    for (const auto &[parentUuid, childUuid] : links)
     {
-        // Load task links
-        std::vector<char *> prereqUuids;
-        m_db.get_linked_entries(uuid, LinkType::DEPENDENCY, prereqUuids);
-        findTasksByList(prereqUuids, taskptr->prerequisites);
+        auto parent = tasks.find(parentUuid);
+        auto child = tasks.find(childUuid);
+        if (parent != tasks.end() && child != tasks.end())
+            parent->second->prerequisites.push_back(child->second.get());
+    }
+
+    // Habit previews
+    char now_str[11]; // "YYYY-MM-DD" + null terminator
+    time_t now = time(nullptr);
+    struct tm local_tm = *localtime(&now);
+    strftime(now_str, sizeof(now_str), "%Y-%m-%d", &local_tm);
 
-        // Load habit preview for any habit tasks
-        if (taskptr->status == TaskStatus::HABIT)
+    const int previewDays = sizeof(Task::completed_days) / sizeof(Task::completed_days[0]);
+    for (auto &[uuid, taskptr] : tasks)
+    {
+        if (taskptr->status != TaskStatus::HABIT)
+            continue;
+        seedHabitPreview(*taskptr, local_tm);
+        for (TaskStatus &day : taskptr->completed_days)
         {
-            // Load habit completion preview
-            habitCompletionPreview(*taskptr);
+            if (day != TaskStatus::IN_PROGRESS)
+                day = TaskStatus::INCOMPLETE;
         }
     }
 
-    // Link tasks to their timeblocks based on timeblock_uuid
-    for (auto &tb : m_timeblocks)
+    std::vector<std::pair<UUID, int>> habitEntries;
+    db.load_habit_entries_in_window(now_str, previewDays, habitEntries);
+    for (const auto &[taskUuid, dayOffset] : habitEntries)
     {
-        tb.tasks = getTasksForTimeblock(tb.uuid);
+        auto it = tasks.find(taskUuid);
+        if (it != tasks.end() && it->second->status == TaskStatus::HABIT && dayOffset >= 0 && dayOffset < previewDays)
+            it->second->completed_days[dayOffset] = TaskStatus::COMPLETE;
     }
 
+    // Link tasks to their timeblocks based on timeblock_uuid, in a single pass over the tasks,
+    // and put each timeblock's tasks in order
+    std::unordered_map<UUID, Timeblock *> timeblockIndex;
+    timeblockIndex.reserve(snapshot.timeblocks.size());
+    for (auto &tb : snapshot.timeblocks)
+    {
+        timeblockIndex[tb.uuid] = &tb;
+    }
+    for (auto &[uuid, taskptr] : tasks)
+    {
+        auto tb = timeblockIndex.find(taskptr->timeblock_uuid);
+        if (tb != timeblockIndex.end())
+            tb->second->tasks.push_back(taskptr.get());
+        else
+            LOGW("CalendarRepository::readModel", "Task <%s> references unknown timeblock <%s>", taskptr->name, taskptr->timeblock_uuid.text().c_str());
+    }
+    for (auto &[uuid, taskptr] : tasks)
+    {
+        snapshot.table.update(taskptr.get());
+    }
+    for (auto &tb : snapshot.timeblocks)
+    {
+        snapshot.table.sort(tb.tasks);
+    }
+}
+
+void CalendarRepository::applyModel(ModelSnapshot &snapshot)
+{
+    // Swap the snapshot in. The previous model goes back to the worker to be freed, which for a
+    // large model takes as long as building it did.
+    auto previous = std::make_shared<ModelSnapshot>();
+    previous->timeblocks.swap(m_timeblocks);
+    previous->tasks.swap(m_tasks);
+    std::swap(previous->table, m_table);
+    m_timeblocks = std::move(snapshot.timeblocks);
+    m_tasks = std::move(snapshot.tasks);
+    m_table = std::move(snapshot.table);
+    reindexTimeblocks();
+    m_worker.submit([previous](Database &) mutable
+                    { previous.reset(); });
+
     emit modelChanged();
 }
 
+// Queued writes that land after the exchange started are pushed by the sync that follows it
 void CalendarRepository::sync()
 {
-    m_synchronizer->sync();
+    m_scheduler->syncNow();
 }
 
 void CalendarRepository::habitCompletionPreview(Task &task)
@@ -104,6 +211,20 @@ void CalendarRepository::habitCompletionPreview(Task &task)
     struct tm local_tm = *localtime(&now);
     strftime(now_str, sizeof(now_str), "%Y-%m-%d", &local_tm);
 
+    seedHabitPreview(task, local_tm);
+
+    // Fill task.completed_days with recent completions
+    db().load_habit_completion_preview(task, now_str);
+
+    // Completing today's entry zeroes a habit's urgency
+    if (isStored(&task))
+        indexTask(&task);
+}
+
+// Mark target days in completed_days (for day frequency habits) and refresh the due date.
+// Completions are filled in afterwards from the habit entries.
+void CalendarRepository::seedHabitPreview(Task &task, const struct tm &local_tm)
+{
     // Day Frequency mode
     if (task.goal_spec.mode() == GoalSpec::Mode::DayFrequency)
     {
@@ -125,22 +246,19 @@ void CalendarRepository::habitCompletionPreview(Task &task)
 
     // Note new due date
     task.update_due_date();
-
-    // Fill task.completed_days with recent completions
-    m_db.load_habit_completion_preview(task, now_str);
 }
 
-void CalendarRepository::habitCompletionStats(const char *taskUuid, std::vector<time_t> &completionDates)
+void CalendarRepository::habitCompletionStats(const UUID &taskUuid, std::vector<time_t> &completionDates)
 {
     const char *TAG = "CalendarRepository::habitCompletionStats";
     completionDates.clear();
     try
     {
-        m_db.get_habit_entries(taskUuid, completionDates);
+        db().get_habit_entries(taskUuid, completionDates);
     }
     catch (int err)
     {
-        LOGE(TAG, "Failed to load habit entries for task %s: %d", taskUuid, err);
+        LOGE(TAG, "Failed to load habit entries for task %s: %d", taskUuid.text().c_str(), err);
     }
 }
 
@@ -148,22 +266,56 @@ void CalendarRepository::habitCompletionStats(const char *taskUuid, std::vector<
 /*                              In-memory access                              */
 /* -------------------------------------------------------------------------- */
 
-// Load all timeblocks and tasks from database into memory, linking them together based on timeblock_uuid and sorting them by urgency
+// Tasks belonging to a timeblock, sorted by urgency
 std::vector<Task *> CalendarRepository::getTasksForTimeblock(const UUID &timeblockUuid)
 {
-    std::vector<Task *> result;
+    Timeblock *tb = findTimeblockByUuid(timeblockUuid);
+    if (!tb)
+        return {};
+
+    std::vector<Task *> result = tb->tasks;
+    sortTasks(result);
+    return result;
+}
+
+// Remove tasks from the task map and from the prerequisite lists that point at them. Returns the
+// surviving tasks that lost a prerequisite.
+std::vector<Task *> CalendarRepository::eraseTasks(const std::vector<Task *> &tasks)
+{
+    std::vector<Task *> dependents;
+    if (tasks.empty())
+        return dependents;
 
-    // Find tasks with matching timeblock_uuid and add pointers to them to the result vector
+    auto erased = [&tasks](Task *p)
+    { return std::find(tasks.begin(), tasks.end(), p) != tasks.end(); };
     for (auto &[uuid, taskPtr] : m_tasks)
     {
-        if (taskPtr->timeblock_uuid == timeblockUuid)
-            result.push_back(taskPtr.get());
+        auto &prereqs = taskPtr->prerequisites;
+        auto it = std::remove_if(prereqs.begin(), prereqs.end(), erased);
+        if (it != prereqs.end() && !erased(taskPtr.get()))
+            dependents.push_back(taskPtr.get());
+        prereqs.erase(it, prereqs.end());
     }
+    for (Task *task : tasks)
+    {
+        unindexTask(task);
+        UUID uuid = task->uuid; // erase() destroys the task, so do not key it by its own member
+        m_tasks.erase(uuid);
+    }
+    return dependents;
+}
 
-    // Sort tasks by urgency
-    sortTasks(result);
-
-    return result;
+// Rebuild the UUID -> Timeblock* index. Must be called whenever m_timeblocks is reordered,
+// grown or shrunk, since any of those can move the timeblocks in memory.
+void CalendarRepository::reindexTimeblocks()
+{
+    m_modelSerial++;
+    m_timeblockIndex.clear();
+    m_timeblockIndex.reserve(m_timeblocks.size());
+    for (auto &tb : m_timeblocks)
+    {
+        m_timeblockIndex[tb.uuid] = &tb;
+    }
 }
 
 // Sort timeblocks between each other
@@ -175,46 +327,115 @@ void CalendarRepository::sortTimeblocks()
         sortTasks(tb.tasks);
     }
 
-    // Sort timeblocks by urgency of their top task
-    auto top_task_urgency = [](const Timeblock &tb) -> float
+    orderTimeblocks();
+}
+
+// Sort timeblocks by urgency of their top task. Stable, so timeblocks with equal scores keep
+// their current order and the views do not shuffle columns on unrelated edits.
+void CalendarRepository::orderTimeblocks()
+{
+    auto top_task_urgency = [this](const Timeblock &tb) -> float
     {
         if (tb.tasks.empty())
             return 0.0f;
 
         // Add bonus for pinned timeblocks, so they always show first but keep order among themselves
         if (tb.status == TimeblockStatus::PINNED)
-            return tb.tasks[0]->get_urgency() * tb.status_weight(tb.status) + 1000.0f;
+            return m_table.urgency(tb.tasks[0]) * tb.status_weight(tb.status) + 1000.0f;
 
-        return tb.tasks[0]->get_urgency() * tb.status_weight(tb.status);
+        return m_table.urgency(tb.tasks[0]) * tb.status_weight(tb.status);
     };
 
-    std::sort(m_timeblocks.begin(), m_timeblocks.end(), [&](const Timeblock &a, const Timeblock &b)
-              { return top_task_urgency(a) > top_task_urgency(b); });
+    // Score each timeblock once, sort the keys, then reorder the timeblocks to match
+    std::vector<std::pair<float, size_t>> keys;
+    keys.reserve(m_timeblocks.size());
+    for (size_t i = 0; i < m_timeblocks.size(); i++)
+    {
+        keys.emplace_back(top_task_urgency(m_timeblocks[i]), i);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const std::pair<float, size_t> &a, const std::pair<float, size_t> &b)
+                     { return a.first > b.first; });
+
+    std::vector<Timeblock> sorted;
+    sorted.reserve(m_timeblocks.size());
+    for (const auto &key : keys)
+    {
+        sorted.push_back(std::move(m_timeblocks[key.second]));
+    }
+    m_timeblocks = std::move(sorted);
+    reindexTimeblocks();
 }
 
-// Sort tasks within a timeblock by urgency and completion status
-// Completed tasks are always at the bottom, sorted by completion time (most recent first). Incomplete tasks are sorted by urgency.
+// Sort tasks within a timeblock by urgency and completion status, with keys read from the hot table
 void CalendarRepository::sortTasks(std::vector<Task *> &tasks)
 {
-    std::sort(tasks.begin(), tasks.end(),
-              [](Task *a, Task *b)
-              {
-                  const bool aCompleted = (a->status == TaskStatus::COMPLETE);
-                  const bool bCompleted = (b->status == TaskStatus::COMPLETE);
+    m_table.sort(tasks);
+}
+
+// Put a single task back in sorted position after one of its sort inputs changed, then restore
+// the timeblock order. Inserts the task if its timeblock does not list it yet. Also refreshes the
+// task's row in the hot table, since every modifier that changes urgency passes through here.
+void CalendarRepository::repositionTask(Task *task)
+{
+    indexTask(task);
 
-                  if (aCompleted != bCompleted)
-                      return !aCompleted;
+    Timeblock *tb = findTimeblockByUuid(task->timeblock_uuid);
+    if (!tb)
+        return;
+
+    auto &tasks = tb->tasks;
+    tasks.erase(std::remove(tasks.begin(), tasks.end(), task), tasks.end());
 
-                  if (!aCompleted)
-                  {
-                      return a->get_urgency() > b->get_urgency();
-                  }
+    // The list is already sorted, so binary search for the slot after any equal keys
+    const TaskTable::SortKey key = m_table.sort_key(task);
+    auto pos = std::upper_bound(tasks.begin(), tasks.end(), key, [this](const TaskTable::SortKey &k, Task *t)
+                                { return TaskTable::sorts_before(k, m_table.sort_key(t)); });
+    tasks.insert(pos, task);
 
-                  return a->get_completed_time() > b->get_completed_time();
-              });
+    orderTimeblocks();
 }
 
-Task *CalendarRepository::findTaskByUuid(const char *uuid)
+void CalendarRepository::emitDependentsUpdated(const Task *task)
+{
+    for (auto &[uuid, taskPtr] : m_tasks)
+    {
+        const auto &prereqs = taskPtr->prerequisites;
+        if (std::find(prereqs.begin(), prereqs.end(), task) != prereqs.end())
+        {
+            repositionTask(taskPtr.get());
+            emit taskUpdated(QString(uuid.text()));
+        }
+    }
+}
+
+/* ----------------------------- Hot task table ----------------------------- */
+
+void CalendarRepository::indexTask(Task *task)
+{
+    m_table.update(task);
+}
+
+void CalendarRepository::unindexTask(Task *task)
+{
+    m_table.remove(task);
+}
+
+void CalendarRepository::topUrgentTasks(size_t count, std::vector<Task *> &outTasks)
+{
+    m_table.top_urgent(count, outTasks);
+}
+
+void CalendarRepository::tasksCompletedSince(time_t since, std::vector<Task *> &outTasks)
+{
+    m_table.completed_since(since, outTasks);
+}
+
+bool CalendarRepository::isStored(const Task *task)
+{
+    return task && findTaskByUuid(task->uuid) == task;
+}
+
+Task *CalendarRepository::findTaskByUuid(const UUID &uuid)
 {
     auto it = m_tasks.find(uuid);
     if (it != m_tasks.end())
@@ -224,9 +445,9 @@ Task *CalendarRepository::findTaskByUuid(const char *uuid)
     return nullptr;
 }
 
-void CalendarRepository::findTasksByList(const std::vector<char *> &uuids, std::vector<Task *> &outTasks)
+void CalendarRepository::findTasksByList(const std::vector<UUID> &uuids, std::vector<Task *> &outTasks)
 {
-    for (const char *uuid : uuids)
+    for (const UUID &uuid : uuids)
     {
         Task *t = findTaskByUuid(uuid);
         if (t)
@@ -236,14 +457,12 @@ void CalendarRepository::findTasksByList(const std::vector<char *> &uuids, std::
     }
 }
 
-Timeblock *CalendarRepository::findTimeblockByUuid(const char *uuid)
+Timeblock *CalendarRepository::findTimeblockByUuid(const UUID &uuid)
 {
-    for (auto &tb : m_timeblocks)
+    auto it = m_timeblockIndex.find(uuid);
+    if (it != m_timeblockIndex.end())
     {
-        if (std::strncmp(tb.uuid, uuid, UUID_LEN) == 0)
-        {
-            return &tb;
-        }
+        return it->second;
     }
     return nullptr;
 }
@@ -257,7 +476,6 @@ Timeblock *CalendarRepository::findTimeblockByUuid(const char *uuid)
 bool CalendarRepository::addTask(Task &task, size_t timeblockIndex)
 {
     const char *TAG = "CalendarRepository::addTask";
-    LOGI(TAG, "Adding task <%s> to timeblock <%s>", task.name, m_timeblocks[timeblockIndex].name);
 
     // Append to in-memory model
     if (timeblockIndex >= m_timeblocks.size() || timeblockIndex < 0)
@@ -265,20 +483,22 @@ bool CalendarRepository::addTask(Task &task, size_t timeblockIndex)
         LOGE(TAG, "Invalid timeblock index %zu", timeblockIndex);
         return false;
     }
+    LOGI(TAG, "Adding task <%s> to timeblock <%s>", task.name, m_timeblocks[timeblockIndex].name);
 
     // Ensure task has an id and timeblock_uuid set
-    if (task.uuid[0] == '\0')
+    if (task.uuid.empty())
     {
-        generate_uuid(task.uuid.value);
+        generate_uuid(task.uuid);
     }
 
     // copy the timeblock's uuid into the task
-    strncpy(task.timeblock_uuid.value, m_timeblocks[timeblockIndex].uuid, UUID_LEN);
+    task.timeblock_uuid = m_timeblocks[timeblockIndex].uuid;
 
     // Persist to database
     try
     {
-        m_db.insert_task(task);
+        db().insert_task(task);
+        m_scheduler->localChange();
     }
     catch (int err)
     {
@@ -286,57 +506,37 @@ bool CalendarRepository::addTask(Task &task, size_t timeblockIndex)
         return false;
     }
 
-    // Insert into in-memory model
-    m_tasks[task.uuid] = std::make_unique<Task>(task);
-
-    // Find spot in memory model to insert based on urgency
-    Task *taskPtr = m_tasks[task.uuid].get(); // Get pointer to the newly added task in the map
-    float taskUrgency = taskPtr->get_urgency();
-    for (size_t i = 0; i < m_timeblocks[timeblockIndex].tasks.size(); i++)
-    {
-        if (taskUrgency > m_timeblocks[timeblockIndex].tasks[i]->get_urgency())
-        {
-            m_timeblocks[timeblockIndex].tasks.insert(m_timeblocks[timeblockIndex].tasks.begin() + i, taskPtr);
-            LOGI(TAG, "Inserted task <%s> at position %zu in timeblock <%s>", task.name, i, m_timeblocks[timeblockIndex].name);
-
-            // Notify listeners
-            emit modelChanged();
-
-            return true;
-        }
-    }
-    m_timeblocks[timeblockIndex].tasks.push_back(taskPtr);
-    LOGI(TAG, "Appended task <%s> at end of timeblock <%s>", task.name, m_timeblocks[timeblockIndex].name);
-
-    // Notify listeners
-    emit modelChanged();
-
+    applyTaskInsert(task);
     return true;
 }
 
-bool CalendarRepository::removeTask(const char *taskUuid)
+bool CalendarRepository::removeTask(const UUID &taskUuid)
 {
     const char *TAG = "CalendarRepository::removeTask";
-    LOGI(TAG, "Removing task with UUID <%s>", taskUuid);
+    LOGI(TAG, "Removing task with UUID <%s>", taskUuid.text().c_str());
 
     // Find task in in-memory model
     Task *taskToRemove = findTaskByUuid(taskUuid);
     if (!taskToRemove)
     {
-        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot remove", taskUuid);
+        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot remove", taskUuid.text().c_str());
         return false;
     }
     Timeblock *tb = findTimeblockByUuid(taskToRemove->timeblock_uuid);
     if (!tb)
     {
-        LOGE(TAG, "Timeblock with UUID <%s> not found in memory, cannot remove task <%s>", taskToRemove->timeblock_uuid.value, taskToRemove->name);
+        LOGE(TAG, "Timeblock with UUID <%s> not found in memory, cannot remove task <%s>", taskToRemove->timeblock_uuid.text().c_str(), taskToRemove->name);
         return false;
     }
 
-    // Remove all links
+    // Remove links and the task itself from the database in a single commit
     try
     {
-        m_db.remove_all_links_for_task(taskUuid);
+        Database::Batch batch(db());
+        db().remove_all_links_for_task(taskUuid);
+        db().delete_task(taskUuid);
+        batch.commit();
+        m_scheduler->localChange();
     }
     catch (int err)
     {
@@ -344,38 +544,7 @@ bool CalendarRepository::removeTask(const char *taskUuid)
         return false;
     }
 
-    // Remove from database
-    try
-    {
-        m_db.delete_task(taskUuid);
-    }
-    catch (int err)
-    {
-        LOGE(TAG, "Failed to delete task from database: %d", err);
-        return false;
-    }
-
-    // Remove from in-memory model
-    auto &tasks = tb->tasks;
-    auto it = std::find_if(tasks.begin(), tasks.end(), [taskToRemove](Task *t)
-                           { return t == taskToRemove; });
-    if (it != tasks.end())
-    {
-        tasks.erase(it);
-    }
-    else
-    {
-        LOGW(TAG, "Task <%s> not found in timeblock <%s>", taskToRemove->name, tb->name);
-        return false;
-    }
-
-    // Remove from task map
-    m_tasks.erase(taskUuid);
-
-    // Notify listeners
-    emit modelChanged();
-
-    return true;
+    return applyTaskRemove(taskToRemove, tb);
 }
 
 bool CalendarRepository::updateTask(const Task &task)
@@ -393,14 +562,15 @@ bool CalendarRepository::updateTask(const Task &task)
 
     if (!existingTask)
     {
-        LOGE(TAG, "Task with UUID <%s> not found in memory, no modifications made", task.uuid);
+        LOGE(TAG, "Task with UUID <%s> not found in memory, no modifications made", task.uuid.text().c_str());
         return false;
     }
 
     // Update in database
     try
     {
-        m_db.update_task(task);
+        db().update_task(task);
+        m_scheduler->localChange();
     }
     catch (int err)
     {
@@ -408,69 +578,170 @@ bool CalendarRepository::updateTask(const Task &task)
         return false;
     }
 
-    // Update in-memory model
-    *existingTask = task;
+    applyTaskUpdate(existingTask, task);
+    return true;
+}
 
-    // Notify listeners
-    emit modelChanged();
+bool CalendarRepository::patchTask(const UUID &taskUuid, const TaskPatch &patch)
+{
+    const char *TAG = "CalendarRepository::patchTask";
+    LOGI(TAG, "Patching task <%s> (fields 0x%x)", taskUuid.text().c_str(), patch.fields);
+
+    Task *existingTask = findTaskByUuid(taskUuid);
+    if (!existingTask)
+    {
+        LOGE(TAG, "Task with UUID <%s> not found in memory, no modifications made", taskUuid.text().c_str());
+        return false;
+    }
+
+    try
+    {
+        db().patch_task(taskUuid, patch);
+        m_scheduler->localChange();
+    }
+    catch (int err)
+    {
+        LOGE(TAG, "Failed to patch task in database: %d", err);
+        return false;
+    }
 
+    applyTaskPatch(existingTask, patch);
     return true;
 }
 
-bool CalendarRepository::moveTask(const char *taskUuid, const char *timeblockUuid)
+bool CalendarRepository::moveTask(const UUID &taskUuid, const UUID &timeblockUuid)
 {
     const char *TAG = "CalendarRepository::moveTask";
-    LOGI(TAG, "Moving task with UUID <%s> to timeblock UUID <%s>", taskUuid, timeblockUuid);
+    LOGI(TAG, "Moving task with UUID <%s> to timeblock UUID <%s>", taskUuid.text().c_str(), timeblockUuid.text().c_str());
 
     // Find task in in-memory model
     Task *movingTask = findTaskByUuid(taskUuid);
     if (!movingTask)
     {
-        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot move", taskUuid);
+        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot move", taskUuid.text().c_str());
         return false;
     }
 
     // Find current timeblock of the task
     Timeblock *currentTb = findTimeblockByUuid(movingTask->timeblock_uuid);
+    UUID previousTimeblockUuid = movingTask->timeblock_uuid;
 
     // Update task's timeblock_uuid
-    strncpy(movingTask->timeblock_uuid.value, timeblockUuid, UUID_LEN);
+    movingTask->timeblock_uuid = timeblockUuid;
 
     // Move in database by changing the timeblock_uuid field of the task
     try
     {
-        m_db.update_task(*movingTask);
+        db().update_task(*movingTask);
+        m_scheduler->localChange();
     }
     catch (int err)
     {
         LOGE(TAG, "Failed to update task's timeblock in database: %d", err);
+        movingTask->timeblock_uuid = previousTimeblockUuid; // Keep memory consistent with the database
         return false;
     }
 
-    // Add to new timeblock's task list at correct position based on urgency
-    Timeblock *newTb = findTimeblockByUuid(timeblockUuid);
-    if (newTb)
+    return applyTaskMove(movingTask, currentTb, previousTimeblockUuid);
+}
+
+/* ------------------------- Tasks: in-memory halves ------------------------ */
+
+// Shared by the synchronous modifiers (after the write succeeded) and the async ones (before the
+// write is queued).
+
+Task *CalendarRepository::applyTaskInsert(const Task &task)
+{
+    const char *TAG = "CalendarRepository::applyTaskInsert";
+
+    // Insert into in-memory model
+    m_tasks[task.uuid] = std::make_unique<Task>(task);
+
+    // Insert into the timeblock's task list at its sorted position
+    Task *taskPtr = m_tasks[task.uuid].get(); // Get pointer to the newly added task in the map
+    repositionTask(taskPtr);
+    LOGI(TAG, "Inserted task <%s> into timeblock <%s>", task.name, taskPtr->timeblock_uuid.text().c_str());
+
+    // Notify listeners
+    emit taskInserted(QString(taskPtr->uuid.text()), QString(taskPtr->timeblock_uuid.text()));
+
+    return taskPtr;
+}
+
+bool CalendarRepository::applyTaskRemove(Task *taskToRemove, Timeblock *tb)
+{
+    const char *TAG = "CalendarRepository::applyTaskRemove";
+
+    // Remove from in-memory model
+    auto &tasks = tb->tasks;
+    auto it = std::find_if(tasks.begin(), tasks.end(), [taskToRemove](Task *t)
+                           { return t == taskToRemove; });
+    if (it != tasks.end())
     {
-        float taskUrgency = movingTask->get_urgency();
-        auto &newTasks = newTb->tasks;
-        size_t insertPos = 0;
-        for (; insertPos < newTasks.size(); ++insertPos)
-        {
-            if (taskUrgency > newTasks[insertPos]->get_urgency())
-                break;
-        }
-        newTasks.insert(newTasks.begin() + insertPos, movingTask);
+        tasks.erase(it);
     }
     else
     {
-        LOGW(TAG, "New timeblock with UUID <%s> not found", timeblockUuid);
+        LOGW(TAG, "Task <%s> not found in timeblock <%s>", taskToRemove->name, tb->name);
         return false;
     }
 
+    // Remove from task map
+    QString removedUuid(taskToRemove->uuid.text());
+    QString timeblockUuid(tb->uuid.text());
+    std::vector<Task *> dependents = eraseTasks({taskToRemove});
+    orderTimeblocks();
+
+    // Notify listeners
+    emit taskRemoved(removedUuid, timeblockUuid);
+    for (Task *dependent : dependents)
+    {
+        repositionTask(dependent);
+        emit taskUpdated(QString(dependent->uuid.text()));
+    }
+
+    return true;
+}
+
+void CalendarRepository::applyTaskUpdate(Task *existingTask, const Task &task)
+{
+    // Update in-memory model
+    const bool wasComplete = existingTask->status == TaskStatus::COMPLETE;
+    *existingTask = task;
+    repositionTask(existingTask);
+
+    // Notify listeners
+    emit taskUpdated(QString(existingTask->uuid.text()));
+    if (wasComplete != (existingTask->status == TaskStatus::COMPLETE))
+    {
+        // Tasks blocked on this one may have become (un)blocked
+        emitDependentsUpdated(existingTask);
+    }
+}
+
+void CalendarRepository::applyTaskPatch(Task *existingTask, const TaskPatch &patch)
+{
+    const bool wasComplete = existingTask->status == TaskStatus::COMPLETE;
+    patch.apply(*existingTask);
+    if (patch.fields & TaskPatch::SORT_FIELDS)
+        repositionTask(existingTask);
+
+    emit taskUpdated(QString(existingTask->uuid.text()));
+    if (wasComplete != (existingTask->status == TaskStatus::COMPLETE))
+    {
+        emitDependentsUpdated(existingTask);
+    }
+}
+
+// `task` already carries its new timeblock_uuid
+bool CalendarRepository::applyTaskMove(Task *movingTask, Timeblock *previousTb, const UUID &previousTimeblockUuid)
+{
+    const char *TAG = "CalendarRepository::applyTaskMove";
+
     // Remove from current timeblock's task list
-    if (currentTb)
+    if (previousTb)
     {
-        auto &tasks = currentTb->tasks;
+        auto &tasks = previousTb->tasks;
         // ptr comparison since tasks are stored as pointers in timeblocks
         auto it = std::find_if(tasks.begin(), tasks.end(), [movingTask](const Task *t)
                                { return t == movingTask; });
@@ -482,25 +753,192 @@ bool CalendarRepository::moveTask(const char *taskUuid, const char *timeblockUui
     else
     {
         LOGW(TAG, "Current timeblock for task <%s> not found; task may be in an inconsistent state", movingTask->name);
+    }
+
+    // Add to new timeblock's task list at correct position based on urgency
+    if (!findTimeblockByUuid(movingTask->timeblock_uuid))
+    {
+        LOGW(TAG, "New timeblock with UUID <%s> not found", movingTask->timeblock_uuid.text().c_str());
         return false;
     }
+    repositionTask(movingTask);
 
     // Notify listeners of change
-    emit modelChanged();
+    emit taskMoved(QString(movingTask->uuid.text()), QString(previousTimeblockUuid.text()), QString(movingTask->timeblock_uuid.text()));
 
     return true;
 }
 
+/* ------------------------------ Tasks: async ------------------------------ */
+
+// An async modifier that is rejected before anything is queued
+static std::future<void> rejected_write(int err)
+{
+    std::promise<void> promise;
+    promise.set_exception(std::make_exception_ptr(err));
+    return promise.get_future();
+}
+
+std::future<void> CalendarRepository::addTaskAsync(Task &task, size_t timeblockIndex)
+{
+    const char *TAG = "CalendarRepository::addTaskAsync";
+
+    if (timeblockIndex >= m_timeblocks.size())
+    {
+        LOGE(TAG, "Invalid timeblock index %zu", timeblockIndex);
+        return rejected_write(SQLITE_MISUSE);
+    }
+    LOGI(TAG, "Adding task <%s> to timeblock <%s>", task.name, m_timeblocks[timeblockIndex].name);
+
+    if (task.uuid.empty())
+    {
+        generate_uuid(task.uuid);
+    }
+    task.timeblock_uuid = m_timeblocks[timeblockIndex].uuid;
+
+    applyTaskInsert(task);
+
+    Task row = task;
+    row.prerequisites.clear(); // The worker must not follow pointers into the GUI thread's model
+    return submitWrite(row.uuid, [row](Database &db)
+                       { db.insert_task(row); });
+}
+
+std::future<void> CalendarRepository::removeTaskAsync(const UUID &taskUuid)
+{
+    const char *TAG = "CalendarRepository::removeTaskAsync";
+    LOGI(TAG, "Removing task with UUID <%s>", taskUuid.text().c_str());
+
+    Task *taskToRemove = findTaskByUuid(taskUuid);
+    Timeblock *tb = taskToRemove ? findTimeblockByUuid(taskToRemove->timeblock_uuid) : nullptr;
+    if (!tb)
+    {
+        LOGE(TAG, "Task with UUID <%s> or its timeblock not found in memory, cannot remove", taskUuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+
+    UUID uuid = taskToRemove->uuid; // The task is freed by applyTaskRemove
+    applyTaskRemove(taskToRemove, tb);
+
+    return submitWrite(uuid, [uuid](Database &db)
+                       {
+        Database::Batch batch(db);
+        db.remove_all_links_for_task(uuid);
+        db.delete_task(uuid);
+        batch.commit(); });
+}
+
+std::future<void> CalendarRepository::updateTaskAsync(const Task &task)
+{
+    const char *TAG = "CalendarRepository::updateTaskAsync";
+
+    Task *existingTask = findTaskByUuid(task.uuid);
+    if (!existingTask)
+    {
+        LOGE(TAG, "Task with UUID <%s> not found in memory, no modifications made", task.uuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+
+    applyTaskUpdate(existingTask, task);
+
+    Task row = *existingTask;
+    row.prerequisites.clear();
+    return submitWrite(row.uuid, [row](Database &db)
+                       { db.update_task(row); });
+}
+
+std::future<void> CalendarRepository::patchTaskAsync(const UUID &taskUuid, const TaskPatch &patch)
+{
+    const char *TAG = "CalendarRepository::patchTaskAsync";
+
+    Task *existingTask = findTaskByUuid(taskUuid);
+    if (!existingTask)
+    {
+        LOGE(TAG, "Task with UUID <%s> not found in memory, no modifications made", taskUuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+
+    applyTaskPatch(existingTask, patch);
+
+    // The patch holds only values, so the worker gets it as is
+    UUID uuid = taskUuid;
+    return submitWrite(uuid, [uuid, patch](Database &db)
+                       { db.patch_task(uuid, patch); });
+}
+
+std::future<void> CalendarRepository::moveTaskAsync(const UUID &taskUuid, const UUID &timeblockUuid)
+{
+    const char *TAG = "CalendarRepository::moveTaskAsync";
+    LOGI(TAG, "Moving task with UUID <%s> to timeblock UUID <%s>", taskUuid.text().c_str(), timeblockUuid.text().c_str());
+
+    Task *movingTask = findTaskByUuid(taskUuid);
+    if (!movingTask || !findTimeblockByUuid(timeblockUuid))
+    {
+        LOGE(TAG, "Task <%s> or timeblock <%s> not found in memory, cannot move", taskUuid.text().c_str(), timeblockUuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+
+    Timeblock *currentTb = findTimeblockByUuid(movingTask->timeblock_uuid);
+    UUID previousTimeblockUuid = movingTask->timeblock_uuid;
+    movingTask->timeblock_uuid = timeblockUuid;
+    applyTaskMove(movingTask, currentTb, previousTimeblockUuid);
+
+    Task row = *movingTask;
+    row.prerequisites.clear();
+    return submitWrite(row.uuid, [row](Database &db)
+                       { db.update_task(row); });
+}
+
+// Queue a write on the worker. Memory is already ahead of the database by then, so a failed
+// write is reported and the model is reloaded to match what was actually stored.
+std::future<void> CalendarRepository::submitWrite(const UUID &entryUuid, std::function<void(Database &)> write)
+{
+    QString uuid(entryUuid.text());
+    return m_worker.submit([this, uuid, write = std::move(write)](Database &db)
+                           {
+        try
+        {
+            write(db);
+            QMetaObject::invokeMethod(this, [this]()
+                                      { m_scheduler->localChange(); }, Qt::QueuedConnection);
+        }
+        catch (int err)
+        {
+            QMetaObject::invokeMethod(this, [this, uuid, err]()
+                                      {
+                LOGE("CalendarRepository::submitWrite", "Queued write for <%s> failed: %d; reloading", uuid.toStdString().c_str(), err);
+                emit writeFailed(uuid, err);
+                loadAllAsync(); }, Qt::QueuedConnection);
+            throw;
+        } });
+}
+
+void CalendarRepository::waitForWorker()
+{
+    m_worker.wait_idle();
+}
+
+Database &CalendarRepository::db()
+{
+    // The GUI, worker and sync thread connections all write. Queued writes land first so a
+    // synchronous call does not read or overwrite rows ahead of them; the sync thread is not
+    // waited for, so a synchronous modifier on m_db can block for up to busy_timeout while a sync
+    // page's transaction is open
+    m_worker.wait_idle();
+    return m_db;
+}
+
 /* --------------------------------- Habits --------------------------------- */
 
-bool CalendarRepository::addHabitEntry(const char *taskUuid, const char *dateIso8601)
+bool CalendarRepository::addHabitEntry(const UUID &taskUuid, const char *dateIso8601)
 {
     const char *TAG = "CalendarRepository::addHabitEntry";
-    LOGI(TAG, "Adding habit entry for task UUID <%s> on date %s", taskUuid, dateIso8601);
+    LOGI(TAG, "Adding habit entry for task UUID <%s> on date %s", taskUuid.text().c_str(), dateIso8601);
 
     try
     {
-        m_db.add_habit_entry(taskUuid, dateIso8601);
+        db().add_habit_entry(taskUuid, dateIso8601);
+        m_scheduler->localChange();
         LOGI(TAG, "Persisted habit entry to database");
     }
     catch (int err)
@@ -514,27 +952,29 @@ bool CalendarRepository::addHabitEntry(const char *taskUuid, const char *dateIso
     if (habit)
     {
         habit->update_due_date();
-        m_db.load_habit_completion_preview(*habit, dateIso8601);
+        db().load_habit_completion_preview(*habit, dateIso8601);
     }
     else
     {
-        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot update habit preview", taskUuid);
-        m_db.remove_habit_entry(taskUuid, dateIso8601); // Rollback database change since task doesn't exist in memory
+        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot update habit preview", taskUuid.text().c_str());
+        db().remove_habit_entry(taskUuid, dateIso8601); // Rollback database change since task doesn't exist in memory
         return false;
     }
 
-    emit modelChanged();
+    repositionTask(habit);
+    emit habitEntryChanged(QString(habit->uuid.text()));
     return true;
 }
 
-bool CalendarRepository::removeHabitEntry(const char *taskUuid, const char *dateIso8601)
+bool CalendarRepository::removeHabitEntry(const UUID &taskUuid, const char *dateIso8601)
 {
     const char *TAG = "CalendarRepository::removeHabitEntry";
-    LOGI(TAG, "Removing habit entry for task UUID <%s> on date %s", taskUuid, dateIso8601);
+    LOGI(TAG, "Removing habit entry for task UUID <%s> on date %s", taskUuid.text().c_str(), dateIso8601);
 
     try
     {
-        m_db.remove_habit_entry(taskUuid, dateIso8601);
+        db().remove_habit_entry(taskUuid, dateIso8601);
+        m_scheduler->localChange();
         LOGI(TAG, "Removed habit entry from database");
     }
     catch (int err)
@@ -548,28 +988,29 @@ bool CalendarRepository::removeHabitEntry(const char *taskUuid, const char *date
     if (habit)
     {
         habit->update_due_date();
-        m_db.load_habit_completion_preview(*habit, dateIso8601);
+        db().load_habit_completion_preview(*habit, dateIso8601);
     }
     else
     {
-        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot update habit preview", taskUuid);
-        m_db.add_habit_entry(taskUuid, dateIso8601); // Rollback database change since task doesn't exist in memory
+        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot update habit preview", taskUuid.text().c_str());
+        db().add_habit_entry(taskUuid, dateIso8601); // Rollback database change since task doesn't exist in memory
         return false;
     }
     // Notify listeners of change, reposition by urgency
-    emit modelChanged();
+    repositionTask(habit);
+    emit habitEntryChanged(QString(habit->uuid.text()));
 
     return true;
 }
 
-bool CalendarRepository::habitEntryExists(const char *taskUuid, const char *dateIso8601)
+bool CalendarRepository::habitEntryExists(const UUID &taskUuid, const char *dateIso8601)
 {
     const char *TAG = "CalendarRepository::habitEntryExists";
-    LOGI(TAG, "Checking existence of habit entry for task UUID <%s> on date %s", taskUuid, dateIso8601);
+    LOGI(TAG, "Checking existence of habit entry for task UUID <%s> on date %s", taskUuid.text().c_str(), dateIso8601);
 
     try
     {
-        bool exists = m_db.habit_entry_exists(taskUuid, dateIso8601);
+        bool exists = db().habit_entry_exists(taskUuid, dateIso8601);
         LOGI(TAG, "Habit entry existence: %s", exists ? "true" : "false");
         return exists;
     }
@@ -582,7 +1023,7 @@ bool CalendarRepository::habitEntryExists(const char *taskUuid, const char *date
 
 // --- Helper functions; convert time_t to ISO8601 date string ---
 
-bool CalendarRepository::addHabitEntry(const char *taskUuid, time_t date)
+bool CalendarRepository::addHabitEntry(const UUID &taskUuid, time_t date)
 {
     const char *TAG = "CalendarRepository::addHabitEntry";
     char dateIso8601[11]; // YYYY-MM-DD + null terminator
@@ -590,7 +1031,7 @@ bool CalendarRepository::addHabitEntry(const char *taskUuid, time_t date)
     strftime(dateIso8601, sizeof(dateIso8601), "%Y-%m-%d", tm_info);
     return addHabitEntry(taskUuid, dateIso8601);
 }
-bool CalendarRepository::removeHabitEntry(const char *taskUuid, time_t date)
+bool CalendarRepository::removeHabitEntry(const UUID &taskUuid, time_t date)
 {
     const char *TAG = "CalendarRepository::removeHabitEntry";
     char dateIso8601[11]; // YYYY-MM-DD + null terminator
@@ -598,7 +1039,7 @@ bool CalendarRepository::removeHabitEntry(const char *taskUuid, time_t date)
     strftime(dateIso8601, sizeof(dateIso8601), "%Y-%m-%d", tm_info);
     return removeHabitEntry(taskUuid, dateIso8601);
 }
-bool CalendarRepository::habitEntryExists(const char *taskUuid, time_t date)
+bool CalendarRepository::habitEntryExists(const UUID &taskUuid, time_t date)
 {
     const char *TAG = "CalendarRepository::habitEntryExists";
     char dateIso8601[11]; // YYYY-MM-DD + null terminator
@@ -607,6 +1048,120 @@ bool CalendarRepository::habitEntryExists(const char *taskUuid, time_t date)
     return habitEntryExists(taskUuid, dateIso8601);
 }
 
+std::future<void> CalendarRepository::addHabitEntryAsync(const UUID &taskUuid, time_t date)
+{
+    const char *TAG = "CalendarRepository::addHabitEntryAsync";
+
+    Task *habit = findTaskByUuid(taskUuid);
+    if (!habit)
+    {
+        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot add habit entry", taskUuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+    applyHabitEntry(habit, date, true);
+
+    char dateIso8601[11]; // YYYY-MM-DD + null terminator
+    strftime(dateIso8601, sizeof(dateIso8601), "%Y-%m-%d", localtime(&date));
+    std::string day(dateIso8601);
+    UUID uuid = habit->uuid;
+    return submitWrite(uuid, [uuid, day](Database &db)
+                       { db.add_habit_entry(uuid, day.c_str()); });
+}
+
+std::future<void> CalendarRepository::removeHabitEntryAsync(const UUID &taskUuid, time_t date)
+{
+    const char *TAG = "CalendarRepository::removeHabitEntryAsync";
+
+    Task *habit = findTaskByUuid(taskUuid);
+    if (!habit)
+    {
+        LOGE(TAG, "Task with UUID <%s> not found in memory, cannot remove habit entry", taskUuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+    applyHabitEntry(habit, date, false);
+
+    char dateIso8601[11]; // YYYY-MM-DD + null terminator
+    strftime(dateIso8601, sizeof(dateIso8601), "%Y-%m-%d", localtime(&date));
+    std::string day(dateIso8601);
+    UUID uuid = habit->uuid;
+    return submitWrite(uuid, [uuid, day](Database &db)
+                       { db.remove_habit_entry(uuid, day.c_str()); });
+}
+
+/**
+ * A task's checkbox toggled in a view. A habit gets today's entry added or removed; any other
+ * task gets the status the check state stands for, and its completion time once checked.
+ */
+std::future<void> CalendarRepository::setCompletionAsync(const UUID &taskUuid, Qt::CheckState checkState)
+{
+    const char *TAG = "CalendarRepository::setCompletionAsync";
+
+    Task *task = findTaskByUuid(taskUuid);
+    if (!task)
+    {
+        LOGE(TAG, "Task with UUID <%s> not found in memory, no modifications made", taskUuid.text().c_str());
+        return rejected_write(SQLITE_NOTFOUND);
+    }
+
+    const time_t now = time(nullptr);
+    if (task->status == TaskStatus::HABIT)
+    {
+        if (checkState == Qt::Checked)
+            addHabitEntryAsync(taskUuid, now);
+        else if (checkState == Qt::Unchecked)
+            removeHabitEntryAsync(taskUuid, now);
+        else
+        {
+            LOGW(TAG, "Habit <%s> has no partial completion", task->name);
+            return rejected_write(SQLITE_MISUSE);
+        }
+
+        // Also persist the due date the entry moved the habit to. Writes land in order, so the
+        // patch's future settles after the entry's.
+        return patchTaskAsync(taskUuid, TaskPatch().set_due_date(task->due_date));
+    }
+
+    // Only the status (and completion time) columns change
+    TaskPatch patch;
+    if (checkState == Qt::Unchecked)
+        patch.set_status(TaskStatus::INCOMPLETE);
+    else if (checkState == Qt::PartiallyChecked)
+        patch.set_status(TaskStatus::IN_PROGRESS);
+    else
+        patch.set_status(TaskStatus::COMPLETE).set_completed_datetime(now);
+    return patchTaskAsync(taskUuid, patch);
+}
+
+// Set the preview day for `date` directly instead of re-reading the preview window: completed,
+// or back to a target / rest day.
+void CalendarRepository::applyHabitEntry(Task *habit, time_t date, bool completed)
+{
+    time_t now = time(nullptr);
+    struct tm today = *localtime(&now);
+    struct tm day = *localtime(&date);
+
+    // Whole local days between the two dates; noon keeps DST shifts from crossing midnight
+    today.tm_hour = day.tm_hour = 12;
+    today.tm_min = day.tm_min = today.tm_sec = day.tm_sec = 0;
+    today.tm_isdst = day.tm_isdst = -1;
+    const long offset = lround(difftime(mktime(&today), mktime(&day)) / 86400.0);
+
+    const long previewDays = sizeof(habit->completed_days) / sizeof(habit->completed_days[0]);
+    if (offset >= 0 && offset < previewDays)
+    {
+        if (completed)
+            habit->completed_days[offset] = TaskStatus::COMPLETE;
+        else if (habit->goal_spec.has_day(day.tm_wday))
+            habit->completed_days[offset] = TaskStatus::IN_PROGRESS; // Target day
+        else
+            habit->completed_days[offset] = TaskStatus::INCOMPLETE;
+    }
+    habit->update_due_date();
+
+    repositionTask(habit);
+    emit habitEntryChanged(QString(habit->uuid.text()));
+}
+
 /* ------------------------------- Entry links ------------------------------ */
 
 /**
@@ -618,7 +1173,8 @@ bool CalendarRepository::addEntryLink(Task *parentTask, Task *childTask, LinkTyp
 
     try
     {
-        m_db.add_entry_link(parentTask->uuid, childTask->uuid, linkType);
+        db().add_entry_link(parentTask->uuid, childTask->uuid, linkType);
+        m_scheduler->localChange();
         LOGI(TAG, "Added entry link in database: <%s> --(%d)--> <%s>", parentTask->name, static_cast<int>(linkType), childTask->name);
     }
     catch (int err)
@@ -643,6 +1199,14 @@ bool CalendarRepository::addEntryLink(Task *parentTask, Task *childTask, LinkTyp
         LOGW(TAG, "Unknown link type %d; no in-memory update performed", static_cast<int>(linkType));
     }
 
+    // The parent may now be blocked or unblocked. Editors pass a detached copy and persist it
+    // with updateTask afterwards, which re-files the stored task then.
+    if (isStored(parentTask))
+    {
+        repositionTask(parentTask);
+        emit taskUpdated(QString(parentTask->uuid.text()));
+    }
+
     return true;
 }
 
@@ -652,7 +1216,8 @@ bool CalendarRepository::removeEntryLink(Task *parentTask, Task *childTask, Link
 
     try
     {
-        m_db.remove_entry_link(parentTask->uuid, childTask->uuid, linkType);
+        db().remove_entry_link(parentTask->uuid, childTask->uuid, linkType);
+        m_scheduler->localChange();
         LOGI(TAG, "Removed entry link in database: <%s> --(%d)--> <%s>", parentTask->name, static_cast<int>(linkType), childTask->name);
     }
     catch (int err)
@@ -677,6 +1242,14 @@ bool CalendarRepository::removeEntryLink(Task *parentTask, Task *childTask, Link
         LOGW(TAG, "Unknown link type %d; no in-memory update performed", static_cast<int>(linkType));
     }
 
+    // The parent may now be blocked or unblocked. Editors pass a detached copy and persist it
+    // with updateTask afterwards, which re-files the stored task then.
+    if (isStored(parentTask))
+    {
+        repositionTask(parentTask);
+        emit taskUpdated(QString(parentTask->uuid.text()));
+    }
+
     return true;
 }
 
@@ -686,7 +1259,8 @@ bool CalendarRepository::removeAllLinksForTask(Task *task)
 
     try
     {
-        m_db.remove_all_links_for_task(task->uuid);
+        db().remove_all_links_for_task(task->uuid);
+        m_scheduler->localChange();
         LOGI(TAG, "Removed all entry links for task <%s> from database", task->name);
     }
     catch (int err)
@@ -706,6 +1280,12 @@ bool CalendarRepository::removeAllLinksForTask(Task *task)
 
     task->prerequisites.clear();
     LOGI(TAG, "Cleared all prerequisite links in memory for task <%s>", task->name);
+
+    if (isStored(task))
+    {
+        repositionTask(task);
+        emit taskUpdated(QString(task->uuid.text()));
+    }
     return true;
 }
 
@@ -715,7 +1295,8 @@ bool CalendarRepository::removeAllChildrenForTask(Task *task)
 
     try
     {
-        m_db.remove_all_child_links_for_task(task->uuid);
+        db().remove_all_child_links_for_task(task->uuid);
+        m_scheduler->localChange();
         LOGI(TAG, "Removed all child entry links of <%s> from database", task->name);
     }
     catch (int err)
@@ -728,17 +1309,23 @@ bool CalendarRepository::removeAllChildrenForTask(Task *task)
 
     task->prerequisites.clear();
     LOGI(TAG, "Cleared all prerequisite links in memory for task <%s>", task->name);
+
+    if (isStored(task))
+    {
+        repositionTask(task);
+        emit taskUpdated(QString(task->uuid.text()));
+    }
     return true;
 }
 
 void CalendarRepository::getLinkedEntries(Task *task)
 {
     const char *TAG = "CalendarRepository::getLinkedEntries";
-    std::vector<char *> linkedUuid;
+    std::vector<UUID> linkedUuid;
 
     try
     {
-        m_db.get_linked_entries(task->uuid, task->status == TaskStatus::HABIT ? LinkType::HABIT_TRIGGER : LinkType::DEPENDENCY, linkedUuid);
+        db().get_linked_entries(task->uuid, task->status == TaskStatus::HABIT ? LinkType::HABIT_TRIGGER : LinkType::DEPENDENCY, linkedUuid);
     }
     catch (int err)
     {
@@ -746,7 +1333,7 @@ void CalendarRepository::getLinkedEntries(Task *task)
         return;
     }
 
-    for (const char *uuid : linkedUuid)
+    for (const UUID &uuid : linkedUuid)
     {
         Task *linkedTask = findTaskByUuid(uuid);
         if (linkedTask)
@@ -755,15 +1342,9 @@ void CalendarRepository::getLinkedEntries(Task *task)
         }
     }
 
-    // Cleanup linkedUuid strings
-    for (char *uuid : linkedUuid)
-    {
-        free(uuid);
-    }
-
     for (Task *prereq : task->prerequisites)
     {
-        LOGI(TAG, "Loaded linked task <%s> (%s) for task <%s>", prereq->name, prereq->uuid, task->name);
+        LOGI(TAG, "Loaded linked task <%s> (%s) for task <%s>", prereq->name, prereq->uuid.text().c_str(), task->name);
     }
 }
 
@@ -775,9 +1356,9 @@ bool CalendarRepository::addTimeblock(Timeblock &tb)
     LOGI(TAG, "Adding timeblock <%s>", tb.name);
 
     // Ensure timeblock has an id
-    if (tb.uuid[0] == '\0')
+    if (tb.uuid.empty())
     {
-        generate_uuid(tb.uuid.value);
+        generate_uuid(tb.uuid);
     }
 
     // Append to in-memory model
@@ -785,54 +1366,75 @@ bool CalendarRepository::addTimeblock(Timeblock &tb)
 
     try
     {
-        m_db.insert_timeblock(tb);
+        db().insert_timeblock(tb);
+        m_scheduler->localChange();
     }
     catch (int err)
     {
         LOGE(TAG, "Failed to persist timeblock <%s>: %d", tb.name, err);
         m_timeblocks.pop_back(); // Rollback in-memory addition
+        reindexTimeblocks();
 
         return false;
     }
+    reindexTimeblocks();
 
     LOGI(TAG, "Persisted timeblock <%s> to database", tb.name);
+    orderTimeblocks();
 
     // Notify listeners
-    emit modelChanged();
+    emit timeblockInserted(QString(tb.uuid.text()));
 
     return true;
 }
 
-bool CalendarRepository::removeTimeblock(const char *timeblockUuid)
+bool CalendarRepository::removeTimeblock(const UUID &timeblockUuid)
 {
     const char *TAG = "CalendarRepository::removeTimeblock";
-    LOGI(TAG, "Removing timeblock with UUID <%s>", timeblockUuid);
+    LOGI(TAG, "Removing timeblock with UUID <%s>", timeblockUuid.text().c_str());
 
-    // Find and remove from in-memory model
-    auto it = std::find_if(m_timeblocks.begin(), m_timeblocks.end(), [timeblockUuid](const Timeblock &tb)
-                           { return std::strncmp(tb.uuid, timeblockUuid, UUID_LEN) == 0; });
-    if (it != m_timeblocks.end())
-    {
-        m_timeblocks.erase(it);
-        // Remove from database
-        try
-        {
-            m_db.delete_timeblock(timeblockUuid);
-        }
-        catch (int err)
-        {
-            LOGE(TAG, "Failed to delete timeblock from database: %d", err);
-            return false;
-        }
+    // Copy the UUID first: the caller's pointer may refer to the timeblock being erased
+    UUID uuid = timeblockUuid;
 
-        // Notify listeners
-        emit modelChanged();
+    Timeblock *tb = findTimeblockByUuid(uuid);
+    if (!tb)
+    {
+        LOGE(TAG, "Timeblock with UUID <%s> not found", timeblockUuid.text().c_str());
+        return false;
+    }
 
-        return true;
+    // Remove from database
+    try
+    {
+        db().delete_timeblock(uuid);
+        m_scheduler->localChange();
+    }
+    catch (int err)
+    {
+        LOGE(TAG, "Failed to delete timeblock from database: %d", err);
+        return false;
     }
 
-    LOGE(TAG, "Timeblock with UUID <%s> not found", timeblockUuid);
-    return false;
+    applyTimeblockRemove(tb);
+    return true;
+}
+
+// The database cascades a timeblock delete to its tasks, so they are dropped from memory too
+void CalendarRepository::applyTimeblockRemove(Timeblock *tb)
+{
+    UUID uuid = tb->uuid;
+    std::vector<Task *> orphans = std::move(tb->tasks);
+    m_timeblocks.erase(m_timeblocks.begin() + (tb - m_timeblocks.data()));
+    reindexTimeblocks();
+    std::vector<Task *> dependents = eraseTasks(orphans);
+
+    // Notify listeners
+    emit timeblockRemoved(QString(uuid.text()));
+    for (Task *dependent : dependents)
+    {
+        repositionTask(dependent);
+        emit taskUpdated(QString(dependent->uuid.text()));
+    }
 }
 
 bool CalendarRepository::updateTimeblock(const Timeblock &tb)
@@ -841,25 +1443,18 @@ bool CalendarRepository::updateTimeblock(const Timeblock &tb)
     LOGI(TAG, "Updating timeblock <%s>", tb.name);
 
     // Find in-memory model
-    Timeblock *existingTb = nullptr;
-    for (auto &t : m_timeblocks)
-    {
-        if (std::strncmp(t.uuid, tb.uuid, UUID_LEN) == 0)
-        {
-            existingTb = &t;
-            break;
-        }
-    }
+    Timeblock *existingTb = findTimeblockByUuid(tb.uuid);
     if (!existingTb)
     {
-        LOGE(TAG, "Timeblock with UUID <%s> not found in memory", tb.uuid);
+        LOGE(TAG, "Timeblock with UUID <%s> not found in memory", tb.uuid.text().c_str());
         return false;
     }
 
     // Update in database
     try
     {
-        m_db.update_timeblock(tb);
+        db().update_timeblock(tb);
+        m_scheduler->localChange();
     }
     catch (int err)
     {
@@ -867,11 +1462,225 @@ bool CalendarRepository::updateTimeblock(const Timeblock &tb)
         return false;
     }
 
-    // Update in-memory model
+    applyTimeblockUpdate(existingTb, tb);
+    return true;
+}
+
+// Copy fields in, keeping the task membership the repository maintains
+void CalendarRepository::applyTimeblockUpdate(Timeblock *existingTb, const Timeblock &tb)
+{
+    std::vector<Task *> tasks = std::move(existingTb->tasks);
     *existingTb = tb;
+    existingTb->tasks = std::move(tasks);
+    QString uuid(existingTb->uuid.text());
+    orderTimeblocks(); // Status affects the timeblock's rank
 
     // Notify listeners
-    emit modelChanged();
+    emit timeblockUpdated(uuid);
+}
 
-    return true;
-}
\ No newline at end of file
+/* -------------------------------------------------------------------------- */
+/*                               Server changes                               */
+/* -------------------------------------------------------------------------- */
+
+static bool same_text(const char *a, const char *b)
+{
+    return (a && b) ? strcmp(a, b) == 0 : a == b;
+}
+
+// The columns of a server task that won the merge and differ from the one in memory. A sync
+// echoes back our own edits, which need no model update.
+static TaskPatch won_task_columns(const Task &current, const Task &task, uint32_t won)
+{
+    TaskPatch patch;
+    if ((won & TaskPatch::NAME) && !same_text(current.name, task.name))
+        patch.set_name(task.name);
+    if ((won & TaskPatch::DESC) && !same_text(current.desc, task.desc))
+        patch.set_desc(task.desc);
+    if ((won & TaskPatch::DUE_DATE) && current.due_date != task.due_date)
+        patch.set_due_date(task.due_date);
+    if ((won & TaskPatch::PRIORITY) && current.priority != task.priority)
+        patch.set_priority(task.priority);
+    if ((won & TaskPatch::SCOPE) && current.scope != task.scope)
+        patch.set_scope(task.scope);
+    if ((won & TaskPatch::STATUS) && current.status != task.status)
+        patch.set_status(task.status);
+    if ((won & TaskPatch::GOAL_SPEC) && current.goal_spec.to_sql() != task.goal_spec.to_sql())
+        patch.set_goal_spec(task.goal_spec);
+    if ((won & TaskPatch::COMPLETED_DATETIME) && current.completed_datetime != task.completed_datetime)
+        patch.set_completed_datetime(task.completed_datetime);
+    return patch;
+}
+
+// The timeblock in memory with the columns a server timeblock won, bits in TIMEBLOCK_SYNC_FIELDS
+// order, taken from it
+static Timeblock won_timeblock_columns(const Timeblock &current, const Timeblock &tb, uint32_t won)
+{
+    Timeblock merged = current;
+    if (won & (1u << 0))
+        merged.status = tb.status;
+    if (won & (1u << 1))
+        merged.name = tb.name;
+    if (won & (1u << 2))
+        merged.desc = tb.desc;
+    if (won & (1u << 3))
+        merged.day_frequency = tb.day_frequency;
+    if (won & (1u << 4))
+        merged.duration = tb.duration;
+    if (won & (1u << 5))
+        merged.start = tb.start;
+    if (won & (1u << 6))
+        merged.day_start = tb.day_start;
+    if (won & (1u << 7))
+        merged.completed_datetime = tb.completed_datetime;
+    return merged;
+}
+
+static bool same_timeblock_row(const Timeblock &a, const Timeblock &b)
+{
+    return a.status == b.status && same_text(a.name, b.name) && same_text(a.desc, b.desc) &&
+           a.day_frequency.to_sql() == b.day_frequency.to_sql() && a.duration == b.duration && a.start == b.start &&
+           a.day_start == b.day_start && a.completed_datetime == b.completed_datetime;
+}
+
+// Local noon on an ISO 8601 date, as applyHabitEntry expects
+static bool parse_habit_date(const std::string &dateIso8601, time_t &date)
+{
+    struct tm day = {};
+    if (sscanf(dateIso8601.c_str(), "%d-%d-%d", &day.tm_year, &day.tm_mon, &day.tm_mday) != 3)
+        return false;
+    day.tm_year -= 1900;
+    day.tm_mon -= 1;
+    day.tm_hour = 12;
+    day.tm_isdst = -1;
+    date = mktime(&day);
+    return date != (time_t)-1;
+}
+
+/**
+ * Apply one committed page of server changes to the in-memory model, row by row, through the
+ * same helpers the local modifiers use. Only the columns a row won in the merge are applied, so
+ * an edit made here after the page committed is not reverted by the sync thread's copy of the
+ * row, and columns identical to what is already in memory are skipped. Runs in the order
+ * Synchronizer wrote them: parents first, deletes last.
+ */
+void CalendarRepository::applyServerChanges(const SyncChanges &changes)
+{
+    const char *TAG = "CalendarRepository::applyServerChanges";
+
+    for (size_t i = 0; i < changes.timeblocks.size(); i++)
+    {
+        const Timeblock &tb = changes.timeblocks[i];
+        Timeblock *existingTb = findTimeblockByUuid(tb.uuid);
+        if (!existingTb)
+        {
+            Timeblock added = tb;
+            added.tasks.clear();
+            m_timeblocks.push_back(added);
+            reindexTimeblocks();
+            orderTimeblocks();
+            emit timeblockInserted(QString(tb.uuid.text()));
+            continue;
+        }
+
+        Timeblock updated = won_timeblock_columns(*existingTb, tb, changes.timeblockFields[i]);
+        if (!same_timeblock_row(*existingTb, updated))
+            applyTimeblockUpdate(existingTb, updated);
+    }
+
+    for (size_t i = 0; i < changes.tasks.size(); i++)
+    {
+        const Task &task = changes.tasks[i];
+        Task *existingTask = findTaskByUuid(task.uuid);
+        if (!existingTask)
+        {
+            Task *added = applyTaskInsert(task);
+            if (added->status == TaskStatus::HABIT)
+                habitCompletionPreview(*added);
+            continue;
+        }
+
+        const uint32_t won = changes.taskFields[i];
+        const bool moved = (won & 1u) && existingTask->timeblock_uuid != task.timeblock_uuid; // Bit 0 is timeblock_uuid
+        TaskPatch patch = won_task_columns(*existingTask, task, won);
+        const bool becameHabit = (patch.fields & TaskPatch::STATUS) && patch.status == TaskStatus::HABIT &&
+                                 existingTask->status != TaskStatus::HABIT;
+
+        // Leave the old timeblock before the patch repositions the task, which would otherwise
+        // list it in both timeblocks while listeners handle taskUpdated
+        if (moved)
+        {
+            UUID previousTimeblockUuid = existingTask->timeblock_uuid;
+            existingTask->timeblock_uuid = task.timeblock_uuid;
+            applyTaskMove(existingTask, findTimeblockByUuid(previousTimeblockUuid), previousTimeblockUuid);
+        }
+        if (patch.fields)
+            applyTaskPatch(existingTask, patch);
+        if (becameHabit)
+            habitCompletionPreview(*existingTask);
+    }
+
+    for (const SyncChanges::HabitEntry &habitEntry : changes.habitEntries)
+    {
+        Task *habit = findTaskByUuid(habitEntry.taskUuid);
+        time_t date;
+        if (habit && habit->status == TaskStatus::HABIT && parse_habit_date(habitEntry.date, date))
+            applyHabitEntry(habit, date, true);
+    }
+
+    for (const SyncChanges::EntryLink &link : changes.links)
+    {
+        Task *parent = findTaskByUuid(link.parentUuid);
+        Task *child = findTaskByUuid(link.childUuid);
+        if (!parent || !child || link.linkType != LinkType::DEPENDENCY)
+            continue;
+        auto &prereqs = parent->prerequisites;
+        if (std::find(prereqs.begin(), prereqs.end(), child) != prereqs.end())
+            continue;
+        prereqs.push_back(child);
+        repositionTask(parent);
+        emit taskUpdated(QString(parent->uuid.text()));
+    }
+
+    for (const SyncChanges::EntryLink &link : changes.removedLinks)
+    {
+        Task *parent = findTaskByUuid(link.parentUuid);
+        Task *child = findTaskByUuid(link.childUuid);
+        if (!parent || !child)
+            continue;
+        auto &prereqs = parent->prerequisites;
+        auto it = std::remove(prereqs.begin(), prereqs.end(), child);
+        if (it == prereqs.end())
+            continue;
+        prereqs.erase(it, prereqs.end());
+        repositionTask(parent);
+        emit taskUpdated(QString(parent->uuid.text()));
+    }
+
+    for (const SyncChanges::HabitEntry &habitEntry : changes.removedHabitEntries)
+    {
+        Task *habit = findTaskByUuid(habitEntry.taskUuid);
+        time_t date;
+        if (habit && habit->status == TaskStatus::HABIT && parse_habit_date(habitEntry.date, date))
+            applyHabitEntry(habit, date, false);
+    }
+
+    for (const UUID &uuid : changes.removedTasks)
+    {
+        Task *task = findTaskByUuid(uuid);
+        Timeblock *tb = task ? findTimeblockByUuid(task->timeblock_uuid) : nullptr;
+        if (tb)
+            applyTaskRemove(task, tb);
+    }
+
+    for (const UUID &uuid : changes.removedTimeblocks)
+    {
+        Timeblock *tb = findTimeblockByUuid(uuid);
+        if (tb)
+            applyTimeblockRemove(tb);
+    }
+
+    LOGI(TAG, "Applied %zu timeblocks, %zu tasks, %zu habit entries and %zu links from the server",
+         changes.timeblocks.size() + changes.removedTimeblocks.size(), changes.tasks.size() + changes.removedTasks.size(),
+         changes.habitEntries.size() + changes.removedHabitEntries.size(), changes.links.size() + changes.removedLinks.size());
+}
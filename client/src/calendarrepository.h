@@ -8,8 +8,12 @@
 #include <QObject>
 #include <unordered_map>
 #include <memory>
+#include <future>
+#include <QString>
 
-#include "syncronize.h"
+#include "syncscheduler.h"
+#include "databaseworker.h"
+#include "tasktable.h"
 
 class CalendarRepository : public QObject
 {
@@ -17,6 +21,7 @@ class CalendarRepository : public QObject
 
 public:
     CalendarRepository();
+    explicit CalendarRepository(const StorageProfile &profile);
     ~CalendarRepository();
 
     /* ---------------------------------- Accessors --------------------------------- */
@@ -26,35 +31,40 @@ public:
     /* ---------------------------- In memory access ---------------------------- */
     void sortTimeblocks();                                                                 // sorts timeblocks in memory
     void sortTasks(std::vector<Task *> &tasks);                                            // sorts tasks within each timeblock in memory (not timeblocks)
-    Task *findTaskByUuid(const char *uuid);                                                // Recovers pointer to repository task by UUID
-    void findTasksByList(const std::vector<char *> &uuids, std::vector<Task *> &outTasks); // Recovers pointers to repository tasks by list of UUIDs
-    Timeblock *findTimeblockByUuid(const char *uuid);                                      // Recovers pointer to repository timeblock by UUID
+    Task *findTaskByUuid(const UUID &uuid);                                                // Recovers pointer to repository task by UUID
+    void findTasksByList(const std::vector<UUID> &uuids, std::vector<Task *> &outTasks); // Recovers pointers to repository tasks by list of UUIDs
+    Timeblock *findTimeblockByUuid(const UUID &uuid);                                      // Recovers pointer to repository timeblock by UUID
 
     /* ------------------------------ Load from DB ------------------------------ */
     // Load everything from DB into memory
     void loadAll();
-    void sync();                                                         // Sync with server
+    void loadAllAsync(); // Read on the worker thread, then swap the model in and emit modelChanged
+    void sync();                                                         // Sync with server now; edits are also pushed on their own
     std::vector<Task *> getTasksForTimeblock(const UUID &timeblockUuid); // Load tasks for a specific timeblock into provided vector
     // --- Getters ---
     void habitCompletionPreview(Task &task); // fills task.completed_days with recent completions
-    void habitCompletionStats(const char *taskUuid, std::vector<time_t> &completionDates);
+    void habitCompletionStats(const UUID &taskUuid, std::vector<time_t> &completionDates);
+    // --- Overview queries (linear scans over the hot task table) ---
+    void topUrgentTasks(size_t count, std::vector<Task *> &outTasks);      // Open tasks (incomplete or habit), most urgent first
+    void tasksCompletedSince(time_t since, std::vector<Task *> &outTasks); // Completed tasks, most recently completed first
 
     /* ------------------ Modifiers (update both memory and DB) ----------------- */
     // Tasks
     bool addTask(Task &task, size_t timeblockIndex);                // returns success
-    bool removeTask(const char *taskUuid);                          // Delete task by UUID
+    bool removeTask(const UUID &taskUuid);                          // Delete task by UUID
     bool updateTask(const Task &task);                              // persist updated task
-    bool moveTask(const char *taskUuid, const char *timeblockUuid); // move task to different timeblock
+    bool patchTask(const UUID &taskUuid, const TaskPatch &patch);   // persist only the patched columns
+    bool moveTask(const UUID &taskUuid, const UUID &timeblockUuid); // move task to different timeblock
     // Habits
-    bool addHabitEntry(const char *taskUuid, const char *dateIso8601);
-    bool addHabitEntry(const char *taskUuid, time_t date);
-    bool removeHabitEntry(const char *taskUuid, const char *dateIso8601);
-    bool removeHabitEntry(const char *taskUuid, time_t date);
-    bool habitEntryExists(const char *taskUuid, const char *dateIso8601);
-    bool habitEntryExists(const char *taskUuid, time_t date);
+    bool addHabitEntry(const UUID &taskUuid, const char *dateIso8601);
+    bool addHabitEntry(const UUID &taskUuid, time_t date);
+    bool removeHabitEntry(const UUID &taskUuid, const char *dateIso8601);
+    bool removeHabitEntry(const UUID &taskUuid, time_t date);
+    bool habitEntryExists(const UUID &taskUuid, const char *dateIso8601);
+    bool habitEntryExists(const UUID &taskUuid, time_t date);
     // Timeblocks
     bool addTimeblock(Timeblock &tb); // returns success
-    bool removeTimeblock(const char *timeblockUuid);
+    bool removeTimeblock(const UUID &timeblockUuid);
     bool updateTimeblock(const Timeblock &tb); // persist updated timeblock
     // Entry links
     bool addEntryLink(Task *parentTask, Task *childTask, LinkType linkType = LinkType::DEPENDENCY);    // Update database and in-memory model
@@ -63,15 +73,87 @@ public:
     bool removeAllLinksForTask(Task *task);                                                            // Remove all links for a given task
     bool removeAllChildrenForTask(Task *task);                                                         // Remove all child links for a given task
 
+    /* --------------- Async modifiers (memory now, DB on the worker) --------------- */
+    // The in-memory model is updated and listeners notified before these return; the write is
+    // queued on the database worker. The future holds the SQLite error if the write fails, in
+    // which case writeFailed is emitted and the model is reloaded from the database.
+    std::future<void> addTaskAsync(Task &task, size_t timeblockIndex);
+    std::future<void> removeTaskAsync(const UUID &taskUuid);
+    std::future<void> updateTaskAsync(const Task &task);
+    std::future<void> patchTaskAsync(const UUID &taskUuid, const TaskPatch &patch);
+    std::future<void> moveTaskAsync(const UUID &taskUuid, const UUID &timeblockUuid);
+    std::future<void> addHabitEntryAsync(const UUID &taskUuid, time_t date);
+    std::future<void> removeHabitEntryAsync(const UUID &taskUuid, time_t date);
+    std::future<void> setCompletionAsync(const UUID &taskUuid, Qt::CheckState checkState); // a view's checkbox toggle
+    void waitForWorker(); // Block until every queued write (and async load) has finished on the worker
+
 signals:
-    // Notify listeners that the model has changed
+    // Notify listeners that the whole model was reloaded (startup, sync)
     void modelChanged();
 
+    // Fine-grained notifications for single edits. Timeblocks (and the tasks within them) are
+    // already back in sorted order when these fire, so listeners only apply the delta.
+    void taskInserted(const QString &taskUuid, const QString &timeblockUuid);
+    void taskUpdated(const QString &taskUuid); // Any field, prerequisite or urgency change
+    void taskRemoved(const QString &taskUuid, const QString &timeblockUuid);
+    void taskMoved(const QString &taskUuid, const QString &fromTimeblockUuid, const QString &toTimeblockUuid);
+    void timeblockInserted(const QString &timeblockUuid);
+    void timeblockUpdated(const QString &timeblockUuid);
+    void timeblockRemoved(const QString &timeblockUuid);
+    void habitEntryChanged(const QString &taskUuid);
+
+    // A queued write was rejected by the database; a reload from disk follows
+    void writeFailed(const QString &entryUuid, int err);
+
 private:
-    Database m_db;                //  DB interface
-    Synchronizer *m_synchronizer; // Sync interface
+    // Everything loadAll reads from the database: tasks joined and sorted into their timeblocks,
+    // and the hot table over them
+    struct ModelSnapshot
+    {
+        std::vector<Timeblock> timeblocks;
+        TaskHash tasks;
+        TaskTable table;
+    };
+    static void readModel(Database &db, ModelSnapshot &snapshot); // runs on either connection; touches no members
+    void applyModel(ModelSnapshot &snapshot);                    // replace the in-memory model and rebuild indexes
+
+    Database &db();                                                            // m_db, once queued async writes have landed
+    std::future<void> submitWrite(const UUID &entryUuid, std::function<void(Database &)> write); // queue a write; reports failures
+    Task *applyTaskInsert(const Task &task);                                   // store a copy in memory, file it and notify
+    bool applyTaskRemove(Task *task, Timeblock *tb);                           // drop from memory and notify
+    void applyTaskUpdate(Task *existingTask, const Task &task);                // copy fields in, reposition and notify
+    void applyTaskPatch(Task *existingTask, const TaskPatch &patch);           // copy the patched fields in, reposition and notify
+    bool applyTaskMove(Task *task, Timeblock *previousTb, const UUID &previousTimeblockUuid); // refile after timeblock_uuid changed
+    void applyHabitEntry(Task *habit, time_t date, bool completed);            // mark one preview day and notify
+    void applyTimeblockUpdate(Timeblock *existingTb, const Timeblock &tb);     // copy fields in, reorder and notify
+    void applyTimeblockRemove(Timeblock *tb);                                  // drop it and its tasks from memory and notify
+    void applyServerChanges(const SyncChanges &changes);                       // one committed sync page, row by row
+
+    static void seedHabitPreview(Task &task, const struct tm &local_tm); // target days + due date, before completions are applied
+    void reindexTimeblocks();                                     // rebuild m_timeblockIndex after m_timeblocks changes shape
+    std::vector<Task *> eraseTasks(const std::vector<Task *> &tasks); // drop tasks from m_tasks and prerequisite lists; returns the tasks that depended on them
+    void repositionTask(Task *task);                              // move one task to its sorted slot in its timeblock
+    void orderTimeblocks();                                       // sort timeblocks by their (already sorted) top tasks
+    void emitDependentsUpdated(const Task *task);                 // taskUpdated for every task that has `task` as a prerequisite
+    bool isStored(const Task *task);                              // true for the repository's own instance, false for a caller's copy
+    void indexTask(Task *task);                                   // refresh one task's row in the hot table
+    void unindexTask(Task *task);                                 // drop one task's row from the hot table
+
+    Database m_db;               //  DB interface
+    SyncScheduler *m_scheduler; // Sync interface; runs exchanges on its own thread and connection
 
     // All tasks are stored in hash map for O(1) access by UUID, timeblocks store pointers to their tasks for organization
     TaskHash m_tasks;                    // In-memory model of tasks, keyed by UUID for fast lookup
     std::vector<Timeblock> m_timeblocks; // In-memory model of timeblocks (does not own tasks, just organizes them)
+    std::unordered_map<UUID, Timeblock *> m_timeblockIndex; // Timeblock lookup by UUID, points into m_timeblocks
+
+    TaskTable m_table; // Sort and score fields of every task, kept in step by indexTask / unindexTask
+
+    // Bumped by reindexTimeblocks, which every in-memory edit ends with. An async load whose
+    // snapshot was read before an edit is discarded and read again.
+    unsigned m_modelSerial = 0;
+
+    // Declared last so it is destroyed first: queued writes are flushed while the model they
+    // report back to still exists
+    DatabaseWorker m_worker;
 };
\ No newline at end of file
@@ -2,8 +2,11 @@
  * Pull from settings.ini and provide configuration values to client code.
  * It will also produce a default settings.ini if one does not exist, with default profiles.
  */
+#pragma once
 
 #include "task.h"
+#include "database.h"
+#include "synccodec.h"
 
 #include <QString>
 
@@ -23,4 +26,14 @@ public:
     static QString clientCertPath();
     static QString clientKeyPath();
     static QString serverCaPath();
+    static int syncPageSize(); // Entries per sync page in either direction
+    static SyncEncoding syncEncoding(); // Preferred wire format; JSON is always the fallback
+    static bool syncCompression();      // Deflate request bodies sent in the binary format
+    static int syncDebounceMs();   // Quiet time after a local edit before it is pushed
+    static int syncPullInterval(); // Seconds between pulls while nothing else triggers a sync
+    static int syncMaxBackoff();   // Longest wait in seconds between retries of a failing sync
+
+    // Storage settings: a named preset from [Storage]/profile, with any pragma set explicitly in
+    // [Storage] overriding the preset's value
+    static StorageProfile storageProfile();
 };
\ No newline at end of file
@@ -1,11 +1,15 @@
 #include "clientconfig.h"
 #include "log.h"
+#include "syncronize.h"
+#include "syncscheduler.h"
 
 #include <QDir>
 #include <QStandardPaths>
 #include <QSettings>
 #include <QCoreApplication>
 
+#include <algorithm>
+
 ClientConfig::ClientConfig()
 {
     // Ensure settings ini exists
@@ -26,6 +30,17 @@ ClientConfig::ClientConfig()
         s.setValue("client_cert_path", "certs/client.crt");
         s.setValue("client_key_path", "certs/client.key");
         s.setValue("server_ca_path", "certs/server_ca.crt");
+        s.setValue("page_size", SYNC_PAGE_SIZE);
+        s.setValue("encoding", "cbor");
+        s.setValue("compress", true);
+        s.setValue("debounce_ms", SYNC_DEBOUNCE_MS);
+        s.setValue("pull_interval", SYNC_PULL_INTERVAL_S);
+        s.setValue("max_backoff", SYNC_MAX_BACKOFF_S);
+        s.endGroup();
+
+        // Storage tuning (durable, balanced or fast)
+        s.beginGroup("Storage");
+        s.setValue("profile", "balanced");
         s.endGroup();
 
         // Create a default score weight profile
@@ -109,4 +124,67 @@ QString ClientConfig::serverCaPath()
 {
     QSettings s(settingsFilePath(), QSettings::IniFormat);
     return s.value("Sync/server_ca_path", "certs/server_ca.crt").toString();
+}
+
+int ClientConfig::syncPageSize()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    int pageSize = s.value("Sync/page_size", SYNC_PAGE_SIZE).toInt();
+    return pageSize > 0 ? pageSize : SYNC_PAGE_SIZE;
+}
+
+SyncEncoding ClientConfig::syncEncoding()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    return s.value("Sync/encoding", "cbor").toString() == "json" ? SyncEncoding::JSON : SyncEncoding::CBOR;
+}
+
+bool ClientConfig::syncCompression()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    return s.value("Sync/compress", true).toBool();
+}
+
+int ClientConfig::syncDebounceMs()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    return std::max(0, s.value("Sync/debounce_ms", SYNC_DEBOUNCE_MS).toInt());
+}
+
+int ClientConfig::syncPullInterval()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    int seconds = s.value("Sync/pull_interval", SYNC_PULL_INTERVAL_S).toInt();
+    return seconds > 0 ? seconds : SYNC_PULL_INTERVAL_S;
+}
+
+int ClientConfig::syncMaxBackoff()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    int seconds = s.value("Sync/max_backoff", SYNC_MAX_BACKOFF_S).toInt();
+    return seconds > 0 ? seconds : SYNC_MAX_BACKOFF_S;
+}
+
+StorageProfile ClientConfig::storageProfile()
+{
+    QSettings s(settingsFilePath(), QSettings::IniFormat);
+    s.beginGroup("Storage");
+    StorageProfile p = StorageProfile::preset(s.value("profile", "balanced").toString().toStdString());
+
+    if (s.contains("journal_mode"))
+        p.journal_mode = s.value("journal_mode").toString().toStdString();
+    if (s.contains("synchronous"))
+        p.synchronous = s.value("synchronous").toString().toStdString();
+    if (s.contains("cache_size"))
+        p.cache_size = s.value("cache_size").toInt();
+    if (s.contains("mmap_size"))
+        p.mmap_size = s.value("mmap_size").toLongLong();
+    if (s.contains("temp_store"))
+        p.temp_store = s.value("temp_store").toString().toStdString();
+    if (s.contains("page_size"))
+        p.page_size = s.value("page_size").toInt();
+    if (s.contains("busy_timeout"))
+        p.busy_timeout = s.value("busy_timeout").toInt();
+    s.endGroup();
+    return p;
 }
\ No newline at end of file
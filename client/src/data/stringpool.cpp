@@ -0,0 +1,100 @@
+#include <cstring>
+
+#include "stringpool.h"
+
+StringPool &StringPool::global()
+{
+    static StringPool pool;
+    return pool;
+}
+
+// FNV-1a; names and descriptions are short
+static uint32_t hash_bytes(const char *str, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= static_cast<unsigned char>(str[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+const char *StringPool::intern(const char *str)
+{
+    return str ? intern(str, std::strlen(str)) : nullptr;
+}
+
+const char *StringPool::intern(const char *str, size_t len)
+{
+    if (!str)
+        return nullptr;
+    const uint32_t hash = hash_bytes(str, len);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if ((m_count + 1) * 2 > m_slots.size())
+        grow();
+
+    const size_t mask = m_slots.size() - 1;
+    size_t i = hash & mask;
+    for (; m_slots[i].str; i = (i + 1) & mask)
+    {
+        const Slot &slot = m_slots[i];
+        if (slot.hash == hash && slot.len == len && std::memcmp(slot.str, str, len) == 0)
+            return slot.str;
+    }
+
+    char *copy = allocate(len + 1);
+    std::memcpy(copy, str, len);
+    copy[len] = '\0';
+    m_slots[i] = Slot{copy, static_cast<uint32_t>(len), hash};
+    m_count++;
+    m_bytes += len + 1;
+    return copy;
+}
+
+StringPool::Stats StringPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats s;
+    s.strings = m_count;
+    s.bytes = m_bytes;
+    s.blocks = m_blocks.size();
+    return s;
+}
+
+char *StringPool::allocate(size_t size)
+{
+    if (size > m_left)
+    {
+        // A string too long for a block gets one of its own, leaving the current block in use
+        if (size > BLOCK_SIZE / 4)
+        {
+            m_blocks.emplace_back(new char[size]);
+            return m_blocks.back().get();
+        }
+        m_blocks.emplace_back(new char[BLOCK_SIZE]);
+        m_next = m_blocks.back().get();
+        m_left = BLOCK_SIZE;
+    }
+    char *p = m_next;
+    m_next += size;
+    m_left -= size;
+    return p;
+}
+
+void StringPool::grow()
+{
+    std::vector<Slot> old(m_slots.empty() ? 1024 : m_slots.size() * 2);
+    old.swap(m_slots);
+    const size_t mask = m_slots.size() - 1;
+    for (const Slot &slot : old)
+    {
+        if (!slot.str)
+            continue;
+        size_t i = slot.hash & mask;
+        while (m_slots[i].str)
+            i = (i + 1) & mask;
+        m_slots[i] = slot;
+    }
+}
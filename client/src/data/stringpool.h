@@ -0,0 +1,66 @@
+/// @file stringpool.h
+/// @brief Interned, immutable strings for task and timeblock names and descriptions
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Each distinct string is stored once, bump-allocated from large blocks that are never freed,
+ * so a returned pointer stays valid for the life of the pool and can be copied between tasks,
+ * snapshots and threads without touching the heap. Equal strings intern to the same pointer,
+ * which keeps reloading the same rows from growing the pool.
+ */
+class StringPool
+{
+public:
+    struct Stats
+    {
+        size_t strings = 0; // Distinct strings held
+        size_t bytes = 0;   // Bytes of string data, terminators included
+        size_t blocks = 0;  // Heap allocations made for string data
+    };
+
+    StringPool() = default;
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    // The pool every Task and Timeblock string lives in
+    static StringPool &global();
+
+    // Interned copy of str; nullptr stays nullptr. The second form need not be null terminated.
+    const char *intern(const char *str);
+    const char *intern(const char *str, size_t len);
+
+    Stats stats() const;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Slot
+    {
+        const char *str = nullptr;
+        uint32_t len = 0;
+        uint32_t hash = 0;
+    };
+
+    char *allocate(size_t size);
+    void grow();
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char *m_next = nullptr; // Free space left in the newest block
+    size_t m_left = 0;
+    std::vector<Slot> m_slots; // Open addressing, kept at most half full
+    size_t m_count = 0;
+    size_t m_bytes = 0;
+};
+
+// StringPool::global().intern(str)
+inline const char *intern_string(const char *str)
+{
+    return StringPool::global().intern(str);
+}
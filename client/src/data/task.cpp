@@ -4,6 +4,7 @@
 #include "log.h"
 #include "database.h"
 #include "task.h"
+#include "urgency.h"
 
 /* -------------------------------------------------------------------------- */
 /*                                Constructors                                */
@@ -11,11 +12,10 @@
 
 Task::Task(const char *name_, const char *desc_, Priority priority_, time_t due_date_, uint8_t frequency_)
 {
-    generate_uuid(uuid.value);
-    name = strdup(name_);
-    desc = strdup(desc_);
+    generate_uuid(uuid);
+    name = intern_string(name_);
+    desc = intern_string(desc_);
 
-    std::memset(timeblock_uuid.value, 0, sizeof(timeblock_uuid.value));
     std::memset(completed_days, 0, sizeof(completed_days));
 
     due_date = due_date_;
@@ -26,53 +26,6 @@ Task::Task(const char *name_, const char *desc_, Priority priority_, time_t due_
     LOGI("Task::Constructor", "Created task <%s> with frequency %d", name, frequency_);
 }
 
-// Copy constructor: deep-copy heap strings and other fields
-Task::Task(const Task &other)
-{
-    uuid = other.uuid;
-    timeblock_uuid = other.timeblock_uuid;
-    due_date = other.due_date;
-    priority = other.priority;
-    scope = other.scope;
-    status = other.status;
-    completed_datetime = other.completed_datetime;
-    prerequisites = other.prerequisites;
-    goal_spec = other.goal_spec;
-    std::memcpy(completed_days, other.completed_days, sizeof(completed_days));
-    name = other.name ? strdup(other.name) : nullptr;
-    desc = other.desc ? strdup(other.desc) : nullptr;
-}
-
-// Copy assignment operator
-Task &Task::operator=(const Task &other)
-{
-    if (this != &other)
-    {
-        free(name);
-        free(desc);
-        uuid = other.uuid;
-        timeblock_uuid = other.timeblock_uuid;
-        due_date = other.due_date;
-        priority = other.priority;
-        scope = other.scope;
-        status = other.status;
-        completed_datetime = other.completed_datetime;
-        prerequisites = other.prerequisites;
-        goal_spec = other.goal_spec;
-        std::memcpy(completed_days, other.completed_days, sizeof(completed_days));
-        name = other.name ? strdup(other.name) : nullptr;
-        desc = other.desc ? strdup(other.desc) : nullptr;
-    }
-    return *this;
-}
-
-Task::~Task()
-{
-    free(name);
-    free(desc);
-    // Prerequisites are not owned by Task, so we don't free them either
-}
-
 /* -------------------------------------------------------------------------- */
 /*                                Handle habit                                */
 /* -------------------------------------------------------------------------- */
@@ -347,9 +300,9 @@ char Task::priority_char() const
 /*                                   Setters                                  */
 /* -------------------------------------------------------------------------- */
 
-void Task::set_timeblock_uuid(const char *tb_uuid)
+void Task::set_timeblock_uuid(const UUID &tb_uuid)
 {
-    std::strncpy(timeblock_uuid.value, tb_uuid, UUID_LEN);
+    timeblock_uuid = tb_uuid;
 }
 
 /* ------------------------ Get the urgency of a task ----------------------- */
@@ -373,36 +326,8 @@ inline float status_weight(TaskStatus s)
     return 0.0f;
 }
 
-/**
- * Compute deadline pressure component based on hours left until due time
- */
-inline float compute_deadline_pressure(time_t now, time_t due)
-{
-    /**
-     * Pressure function: pressure = exp(-T, t)
-     * T = time until deadline in hours
-     * t = time constant (half life of pressure in hours)
-     */
-    const float t = 48.0f; // Half life of 48 hours; TODO: make this user-configurable
-    float T = difftime(due, now) / 3600.0f;
-
-    // Linear scaling for overdue tasks to avoid very large pressures
-    if (T < 0)
-    {
-        return std::max(std::abs(T), 1.0f);
-    }
-
-    return std::exp(-T / t);
-}
-
 float Task::get_urgency() const
 {
-    // Constants
-    const float C = g_score_weights.undated_pressure_constant; // Undated pressure constant
-    const float w_p = g_score_weights.priority_weight;         // Priority weight
-    const float w_u = g_score_weights.due_date_weight;         // Urgency/deadline pressure weight
-    const float w_e = g_score_weights.scope_weight;            // Effort/scope weight
-
     // Execptions
     if (priority == Priority::NONE)
     {
@@ -422,21 +347,107 @@ float Task::get_urgency() const
         }
     }
 
-    // --- Calculate urgency ---
-    //! Should have multiple types of sorting factors, for now we do hardest first
+    // Reuse the cached score while its inputs are unchanged
+    const time_t bucket = time(nullptr) / URGENCY_TIME_BUCKET;
+    UrgencyCache &c = m_urgency_cache;
+    if (!c.valid || c.priority != priority || c.scope != scope || c.due_date != due_date ||
+        c.weights_generation != g_score_weights_generation || c.bucket != bucket)
+    {
+        c.score = base_urgency(priority, scope, due_date, bucket);
+        c.priority = priority;
+        c.scope = scope;
+        c.due_date = due_date;
+        c.weights_generation = g_score_weights_generation;
+        c.bucket = bucket;
+        c.valid = true;
+    }
+    return c.score;
+}
 
-    /** Eat the frog
-      score_frog = w_u * U
-      + w_p * P_norm
-      + w_e * E_norm
-     */
+// Urgency score ignoring the exceptions in get_urgency(). Deadline pressure is measured from the
+// start of the time bucket so every task scored in the same bucket sees the same clock.
+float Task::base_urgency(Priority priority, Scope scope, time_t due_date, time_t bucket)
+{
+    return urgency_score(static_cast<int8_t>(priority), static_cast<int8_t>(scope), due_date,
+                         bucket * URGENCY_TIME_BUCKET, g_score_weights);
+}
 
-    // Normalize priority and effort to [0, 1]
-    double P_norm = (static_cast<int>(priority) - static_cast<int>(Priority::VERY_LOW)) / static_cast<int>(Priority::VERY_HIGH);
-    double E_norm = (static_cast<int>(scope) - static_cast<int>(Scope::XS)) / static_cast<int>(Scope::XL);
+/* -------------------------------------------------------------------------- */
+/*                                 Task patches                               */
+/* -------------------------------------------------------------------------- */
 
-    // Compute deadline pressure, from [0, 1] or [1, inf) if overdue, or constant C if undated
-    double pressure = due_date ? compute_deadline_pressure(time(nullptr), due_date) : C;
+TaskPatch &TaskPatch::set_name(const char *name_)
+{
+    name = intern_string(name_);
+    fields |= NAME;
+    return *this;
+}
 
-    return w_u * pressure + w_p * P_norm + w_e * E_norm;
-}
\ No newline at end of file
+TaskPatch &TaskPatch::set_desc(const char *desc_)
+{
+    desc = intern_string(desc_);
+    fields |= DESC;
+    return *this;
+}
+
+TaskPatch &TaskPatch::set_due_date(time_t due_date_)
+{
+    due_date = due_date_;
+    fields |= DUE_DATE;
+    return *this;
+}
+
+TaskPatch &TaskPatch::set_priority(Priority priority_)
+{
+    priority = priority_;
+    fields |= PRIORITY;
+    return *this;
+}
+
+TaskPatch &TaskPatch::set_scope(Scope scope_)
+{
+    scope = scope_;
+    fields |= SCOPE;
+    return *this;
+}
+
+TaskPatch &TaskPatch::set_status(TaskStatus status_)
+{
+    status = status_;
+    fields |= STATUS;
+    return *this;
+}
+
+TaskPatch &TaskPatch::set_goal_spec(const GoalSpec &goal_spec_)
+{
+    goal_spec = goal_spec_;
+    fields |= GOAL_SPEC;
+    return *this;
+}
+
+TaskPatch &TaskPatch::set_completed_datetime(time_t completed_datetime_)
+{
+    completed_datetime = completed_datetime_;
+    fields |= COMPLETED_DATETIME;
+    return *this;
+}
+
+void TaskPatch::apply(Task &task) const
+{
+    if (fields & NAME)
+        task.name = name;
+    if (fields & DESC)
+        task.desc = desc;
+    if (fields & DUE_DATE)
+        task.due_date = due_date;
+    if (fields & PRIORITY)
+        task.priority = priority;
+    if (fields & SCOPE)
+        task.scope = scope;
+    if (fields & STATUS)
+        task.status = status;
+    if (fields & GOAL_SPEC)
+        task.goal_spec = goal_spec;
+    if (fields & COMPLETED_DATETIME)
+        task.completed_datetime = completed_datetime;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <ctime>
 #include <string>
 #include <sqlite3.h>
@@ -7,6 +8,7 @@
 
 #include "uuid.h"
 #include "goalspec.h"
+#include "stringpool.h"
 
 struct ScoreWeights
 {
@@ -17,6 +19,7 @@ struct ScoreWeights
 };
 
 extern ScoreWeights g_score_weights;
+extern unsigned g_score_weights_generation; // Increment after changing g_score_weights so cached urgencies are recomputed
 
 enum class LinkType
 {
@@ -52,8 +55,21 @@ enum class TaskStatus
     HABIT = 3
 };
 
+// Row of a stored task in its repository's TaskTable. The row stays with the object: a copy
+// starts without one, and assigning another task's fields in keeps it, since only the
+// repository's own instances have rows.
+struct TaskRow
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+    uint32_t index = NONE;
+
+    TaskRow() = default;
+    TaskRow(const TaskRow &) noexcept {}
+    TaskRow &operator=(const TaskRow &) noexcept { return *this; }
+};
+
 /** Task Struct
- * UUID string used for id to match with JSON format.
+ * Keyed by a binary UUID; its text form is what the JSON format carries.
  */
 class Task
 {
@@ -84,8 +100,9 @@ public:
     TaskStatus completed_days[10];
 
     // --- Descriptive fields ---
-    char *name = NULL; // Title of entry
-    char *desc = NULL; // Verbose description of entry
+    // Interned in StringPool::global(); copying a task copies the pointers
+    const char *name = NULL; // Title of entry
+    const char *desc = NULL; // Verbose description of entry
 
     /* -------------------------------- Functions ------------------------------- */
     // --- Constructors ---
@@ -93,26 +110,23 @@ public:
     Task() = default;
     Task(const char *name_, const char *desc_, Priority priority_ = Priority::NONE, time_t due_date_ = 0, uint8_t frequency_ = 0);
 
-    // custom copy semantics to manage heap-allocated strings
-    Task(const Task &other);
-    Task &operator=(const Task &other);
-
-    // defaulted move operations are safe since we take ownership of pointers
-    Task(Task &&) noexcept = default;
-    Task &operator=(Task &&) noexcept = default;
-
-    ~Task();
-
     // --- Setters ---
 
-    void set_timeblock_uuid(const char *tb_uuid);
+    void set_timeblock_uuid(const UUID &tb_uuid);
 
     // --- Get parameters ---
 
     /**
-     * Get urgency of a task
+     * Get urgency of a task. The score is cached and only recomputed when one of its inputs
+     * (priority, scope, due date, score weights) changes or the clock enters a new
+     * URGENCY_TIME_BUCKET; the prerequisite check is always live.
      */
     float get_urgency() const;
+    static constexpr time_t URGENCY_TIME_BUCKET = 60; // Seconds the deadline pressure is held constant
+
+    // Urgency score before the exceptions in get_urgency(), with deadline pressure measured from
+    // the start of the given time bucket
+    static float base_urgency(Priority priority, Scope scope, time_t due_date, time_t bucket);
 
     time_t get_completed_time() const
     {
@@ -143,4 +157,63 @@ public:
      * Updates the due date of a if a task is repeating, otherwise does nothing
      */
     void update_due_date();
-};
\ No newline at end of file
+
+private:
+    friend class TaskTable;
+    TaskRow m_table_row;
+
+    // Score from get_urgency() before exceptions, with the inputs it was computed from
+    struct UrgencyCache
+    {
+        bool valid = false;
+        float score = 0.0f;
+        Priority priority = Priority::NONE;
+        Scope scope = Scope::NONE;
+        time_t due_date = 0;
+        unsigned weights_generation = 0;
+        time_t bucket = 0;
+    };
+    mutable UrgencyCache m_urgency_cache;
+};
+/**
+ * Some of a task's columns, for CalendarRepository::patchTask. Only the columns given through
+ * the setters are copied into the stored task and written to the database, so a status toggle
+ * neither copies the whole task nor rewrites its whole row. The bits of `fields` follow
+ * TASK_SYNC_FIELDS; the timeblock is changed with moveTask instead.
+ */
+struct TaskPatch
+{
+    enum Field : uint32_t
+    {
+        NAME = 1u << 1,
+        DESC = 1u << 2,
+        DUE_DATE = 1u << 3,
+        PRIORITY = 1u << 4,
+        SCOPE = 1u << 5,
+        STATUS = 1u << 6,
+        GOAL_SPEC = 1u << 7,
+        COMPLETED_DATETIME = 1u << 8,
+    };
+    static constexpr uint32_t SORT_FIELDS = DUE_DATE | PRIORITY | SCOPE | STATUS | COMPLETED_DATETIME; // Inputs of the task order
+
+    uint32_t fields = 0; // Field bits of the columns set
+    const char *name = nullptr;
+    const char *desc = nullptr;
+    time_t due_date = 0;
+    Priority priority = Priority::NONE;
+    Scope scope = Scope::NONE;
+    TaskStatus status = TaskStatus::INCOMPLETE;
+    GoalSpec goal_spec;
+    time_t completed_datetime = 0;
+
+    TaskPatch &set_name(const char *name_);
+    TaskPatch &set_desc(const char *desc_);
+    TaskPatch &set_due_date(time_t due_date_);
+    TaskPatch &set_priority(Priority priority_);
+    TaskPatch &set_scope(Scope scope_);
+    TaskPatch &set_status(TaskStatus status_);
+    TaskPatch &set_goal_spec(const GoalSpec &goal_spec_);
+    TaskPatch &set_completed_datetime(time_t completed_datetime_);
+
+    void apply(Task &task) const; // copy the set columns into task
+};
@@ -0,0 +1,225 @@
+#include <algorithm>
+
+#include "tasktable.h"
+#include "urgency.h"
+
+bool TaskTable::sorts_before(const SortKey &a, const SortKey &b)
+{
+    if (a.completed != b.completed)
+        return !a.completed;
+
+    if (!a.completed)
+    {
+        return a.urgency > b.urgency;
+    }
+
+    return a.completed_time > b.completed_time;
+}
+
+void TaskTable::update(Task *task)
+{
+    refresh();
+
+    uint32_t row = task->m_table_row.index;
+    if (row == TaskRow::NONE)
+    {
+        row = static_cast<uint32_t>(m_tasks.size());
+        task->m_table_row.index = row;
+        m_due_date.push_back(0);
+        m_completed_datetime.push_back(0);
+        m_urgency.push_back(0.0f);
+        m_priority.push_back(0);
+        m_scope.push_back(0);
+        m_status.push_back(0);
+        m_flags.push_back(0);
+        m_tasks.push_back(task);
+    }
+
+    uint8_t flags = 0;
+    for (const Task *prereq : task->prerequisites)
+    {
+        if (prereq->status != TaskStatus::COMPLETE)
+        {
+            flags |= BLOCKED;
+            break;
+        }
+    }
+    if (task->status == TaskStatus::HABIT && task->completed_days[0] == TaskStatus::COMPLETE)
+        flags |= DONE_TODAY;
+
+    m_due_date[row] = task->due_date;
+    m_completed_datetime[row] = task->completed_datetime;
+    m_priority[row] = static_cast<int8_t>(task->priority);
+    m_scope[row] = static_cast<int8_t>(task->scope);
+    m_status[row] = static_cast<uint8_t>(task->status);
+    m_flags[row] = flags;
+    score(row);
+}
+
+void TaskTable::remove(Task *task)
+{
+    const uint32_t row = task->m_table_row.index;
+    if (row == TaskRow::NONE)
+        return;
+    task->m_table_row.index = TaskRow::NONE;
+
+    const uint32_t last = static_cast<uint32_t>(m_tasks.size() - 1);
+    if (row != last)
+    {
+        m_due_date[row] = m_due_date[last];
+        m_completed_datetime[row] = m_completed_datetime[last];
+        m_urgency[row] = m_urgency[last];
+        m_priority[row] = m_priority[last];
+        m_scope[row] = m_scope[last];
+        m_status[row] = m_status[last];
+        m_flags[row] = m_flags[last];
+        m_tasks[row] = m_tasks[last];
+        m_tasks[row]->m_table_row.index = row;
+    }
+    m_due_date.pop_back();
+    m_completed_datetime.pop_back();
+    m_urgency.pop_back();
+    m_priority.pop_back();
+    m_scope.pop_back();
+    m_status.pop_back();
+    m_flags.pop_back();
+    m_tasks.pop_back();
+}
+
+void TaskTable::score(uint32_t row)
+{
+    m_urgency[row] = urgency_score(m_priority[row], m_scope[row], m_due_date[row],
+                                   m_bucket * Task::URGENCY_TIME_BUCKET, g_score_weights);
+    apply_exceptions(row);
+}
+
+// Same exceptions as Task::get_urgency(), read from the columns
+void TaskTable::apply_exceptions(uint32_t row)
+{
+    if (m_priority[row] == static_cast<int8_t>(Priority::NONE) || (m_flags[row] & DONE_TODAY))
+        m_urgency[row] = 0.0f;
+    else if (m_flags[row] & BLOCKED)
+        m_urgency[row] = -1.0f;
+}
+
+void TaskTable::refresh()
+{
+    const time_t bucket = time(nullptr) / Task::URGENCY_TIME_BUCKET;
+    if (bucket == m_bucket && g_score_weights_generation == m_generation)
+        return;
+
+    m_bucket = bucket;
+    m_generation = g_score_weights_generation;
+
+    // Base scores for the whole column in one batch, then the few rows with exceptions
+    score_urgency(m_due_date.data(), m_priority.data(), m_scope.data(), m_tasks.size(),
+                  m_bucket * Task::URGENCY_TIME_BUCKET, g_score_weights, m_urgency.data());
+    for (uint32_t row = 0; row < m_tasks.size(); row++)
+    {
+        if (m_flags[row] || m_priority[row] == static_cast<int8_t>(Priority::NONE))
+            apply_exceptions(row);
+    }
+}
+
+float TaskTable::urgency(const Task *task)
+{
+    const uint32_t row = task->m_table_row.index;
+    if (row == TaskRow::NONE)
+        return task->get_urgency();
+    refresh();
+    return m_urgency[row];
+}
+
+TaskTable::SortKey TaskTable::sort_key(const Task *task)
+{
+    refresh();
+    return key(task);
+}
+
+TaskTable::SortKey TaskTable::key(const Task *task) const
+{
+    const uint32_t row = task->m_table_row.index;
+    if (row == TaskRow::NONE)
+    {
+        const bool completed = (task->status == TaskStatus::COMPLETE);
+        return {completed, completed ? 0.0f : task->get_urgency(), task->completed_datetime};
+    }
+    const bool completed = (m_status[row] == static_cast<uint8_t>(TaskStatus::COMPLETE));
+    return {completed, completed ? 0.0f : m_urgency[row], m_completed_datetime[row]};
+}
+
+void TaskTable::sort(std::vector<Task *> &tasks)
+{
+    refresh();
+
+    // Read each task's key once instead of inside the comparator
+    std::vector<std::pair<SortKey, Task *>> keys;
+    keys.reserve(tasks.size());
+    for (Task *t : tasks)
+    {
+        keys.emplace_back(key(t), t);
+    }
+
+    std::sort(keys.begin(), keys.end(), [](const std::pair<SortKey, Task *> &a, const std::pair<SortKey, Task *> &b)
+              { return sorts_before(a.first, b.first); });
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        tasks[i] = keys[i].second;
+    }
+}
+
+void TaskTable::top_urgent(size_t count, std::vector<Task *> &out)
+{
+    refresh();
+    if (count == 0)
+        return;
+
+    // Min-heap of the `count` most urgent rows seen so far; ties go to the lower row
+    using Entry = std::pair<float, uint32_t>;
+    auto more_urgent = [](const Entry &a, const Entry &b)
+    { return a.first != b.first ? a.first > b.first : a.second < b.second; };
+    std::vector<Entry> heap;
+    heap.reserve(count);
+
+    const uint8_t incomplete = static_cast<uint8_t>(TaskStatus::INCOMPLETE);
+    const uint8_t habit = static_cast<uint8_t>(TaskStatus::HABIT);
+    const uint32_t rows = static_cast<uint32_t>(m_tasks.size());
+    for (uint32_t row = 0; row < rows; row++)
+    {
+        if (m_status[row] != incomplete && m_status[row] != habit)
+            continue;
+        if (heap.size() < count)
+        {
+            heap.emplace_back(m_urgency[row], row);
+            std::push_heap(heap.begin(), heap.end(), more_urgent);
+        }
+        else if (m_urgency[row] > heap.front().first)
+        {
+            std::pop_heap(heap.begin(), heap.end(), more_urgent);
+            heap.back() = Entry(m_urgency[row], row);
+            std::push_heap(heap.begin(), heap.end(), more_urgent);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), more_urgent);
+    for (const Entry &entry : heap)
+        out.push_back(m_tasks[entry.second]);
+}
+
+void TaskTable::completed_since(time_t since, std::vector<Task *> &out)
+{
+    const uint8_t complete = static_cast<uint8_t>(TaskStatus::COMPLETE);
+    std::vector<std::pair<time_t, uint32_t>> found;
+    const uint32_t rows = static_cast<uint32_t>(m_tasks.size());
+    for (uint32_t row = 0; row < rows; row++)
+    {
+        if (m_status[row] == complete && m_completed_datetime[row] >= since)
+            found.emplace_back(m_completed_datetime[row], row);
+    }
+
+    std::sort(found.begin(), found.end(), [](const std::pair<time_t, uint32_t> &a, const std::pair<time_t, uint32_t> &b)
+              { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+    for (const auto &entry : found)
+        out.push_back(m_tasks[entry.second]);
+}
@@ -0,0 +1,67 @@
+/// @file tasktable.h
+/// @brief Columnar copy of the task fields the repository sorts and scores by
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include "task.h"
+
+/**
+ * One row per stored task at a dense index, with the fields sorting and scoring read laid out
+ * column by column, so urgency scans and the overview queries walk a few contiguous arrays
+ * instead of following a pointer to every Task. The Task objects stay authoritative: update()
+ * copies a task's fields into its row and must be called whenever one of them changes.
+ * Removing a row moves the last one into its place.
+ */
+class TaskTable
+{
+public:
+    // Order of tasks within a timeblock: open tasks by urgency, then completed ones by
+    // completion time, most recent first
+    struct SortKey
+    {
+        bool completed;
+        float urgency;
+        time_t completed_time;
+    };
+    static bool sorts_before(const SortKey &a, const SortKey &b);
+
+    void update(Task *task); // add the task or refresh its row
+    void remove(Task *task); // no-op for tasks without a row
+    size_t size() const { return m_tasks.size(); }
+
+    // Task::get_urgency() as of the task's last update; tasks without a row are scored directly
+    float urgency(const Task *task);
+    SortKey sort_key(const Task *task);
+    void sort(std::vector<Task *> &tasks);
+
+    void top_urgent(size_t count, std::vector<Task *> &out);      // open tasks (incomplete or habit), most urgent first
+    void completed_since(time_t since, std::vector<Task *> &out); // completed tasks, most recently completed first
+
+private:
+    enum Flags : uint8_t
+    {
+        BLOCKED = 0x01,    // An incomplete prerequisite
+        DONE_TODAY = 0x02, // Habit with today's entry complete
+    };
+
+    void refresh();                      // re-score every row once the urgency bucket or the weights moved on
+    void score(uint32_t row);            // urgency column from the row's other columns
+    void apply_exceptions(uint32_t row); // overrides of the base score, as in Task::get_urgency()
+    SortKey key(const Task *task) const; // sort_key() without the refresh
+
+    // Columns, indexed by row
+    std::vector<time_t> m_due_date;
+    std::vector<time_t> m_completed_datetime;
+    std::vector<float> m_urgency;
+    std::vector<int8_t> m_priority;
+    std::vector<int8_t> m_scope;
+    std::vector<uint8_t> m_status;
+    std::vector<uint8_t> m_flags;
+    std::vector<Task *> m_tasks; // Owner of the row, for its cold fields
+
+    time_t m_bucket = 0;       // URGENCY_TIME_BUCKET the urgency column was scored in
+    unsigned m_generation = 0; // g_score_weights_generation it was scored with
+};
@@ -13,9 +13,9 @@
 Timeblock::Timeblock(const char *name_, const char *desc_, uint8_t day_flags,
                      time_t duration, time_t start_or_day_start)
 {
-    generate_uuid(uuid.value);
-    name = strdup(name_);
-    desc = strdup(desc_);
+    generate_uuid(uuid);
+    name = intern_string(name_);
+    desc = intern_string(desc_);
     day_frequency = GoalSpec::day_frequency(day_flags);
     duration = duration;
 
@@ -81,7 +81,7 @@ void Timeblock::print() const
 {
     const char *TAG = "Timeblock::print";
     LOGI(TAG, "Timeblock <%s>: name=\"%s\", desc=\"%s\", day_freq=%u, duration=%ld, start=%ld, day_start=%ld, status=%d, completed_datetime=%ld\n",
-           uuid.value, name, desc, day_frequency.data, duration, start, day_start, static_cast<int>(status), completed_datetime);
+           uuid.text().c_str(), name, desc, day_frequency.data, duration, start, day_start, static_cast<int>(status), completed_datetime);
     LOGI(TAG, "  Tasks:\n");
     for (const auto *task : tasks)
     {
@@ -91,6 +91,6 @@ void Timeblock::print() const
             continue;
         }
         LOGI(TAG, "    Task <%s>: name=\"%s\", desc=\"%s\", priority=%d, due_date=%ld, status=%d\n",
-               task->uuid.value, task->name, task->desc, static_cast<int>(task->priority), task->due_date, static_cast<int>(task->status));
+               task->uuid.text().c_str(), task->name, task->desc, static_cast<int>(task->priority), task->due_date, static_cast<int>(task->status));
     }
 }
\ No newline at end of file
@@ -44,7 +44,7 @@ public:
     time_t start;           // For single events; Time since epoch
     time_t day_start;       // For weekly events; Time since start of day
 
-    char *name, *desc;
+    const char *name = nullptr, *desc = nullptr; // Interned in StringPool::global()
     std::vector<Task *> tasks;
 
     TimeblockStatus status = TimeblockStatus::ONGOING;
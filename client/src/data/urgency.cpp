@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "urgency.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MCAL_URGENCY_AVX2
+#include <immintrin.h>
+#endif
+
+/*
+ * The kernels perform the same float and double operations in the same order, which is what
+ * keeps their results identical. This file is built without floating point contraction, so no
+ * multiply-add in either kernel is fused into a single rounding.
+ */
+
+static const float PRESSURE_HALF_LIFE = 48.0f; // Hours; TODO: make this user-configurable
+
+// Seconds to a deadline are clamped to +-2^50 (far past any real deadline), a range the AVX2
+// kernel can convert to double exactly
+static const int64_t MAX_SECONDS = int64_t(1) << 50;
+
+// e^x for x <= 0 with the Cephes single precision polynomial, which both kernels evaluate
+// step by step instead of calling a libm exp the vector kernel could not match
+static const float EXP_MIN = -87.3365447505f; // Below this e^x is not a normal float; scored as 0
+static const float LOG2E = 1.44269504089f;
+static const float LN2_HI = 0.693359375f;
+static const float LN2_LO = -2.12194440e-4f;
+static const float EXP_P0 = 1.9875691500e-4f;
+static const float EXP_P1 = 1.3981999507e-3f;
+static const float EXP_P2 = 8.3334519073e-3f;
+static const float EXP_P3 = 4.1665795894e-2f;
+static const float EXP_P4 = 1.6666665459e-1f;
+static const float EXP_P5 = 5.0000001201e-1f;
+
+static float exp_neg(float x)
+{
+    if (x < EXP_MIN)
+        return 0.0f;
+
+    // x = n ln2 + r, |r| <= ln2 / 2
+    const float n = static_cast<float>(std::lrint(x * LOG2E));
+    float r = x - n * LN2_HI;
+    r = r - n * LN2_LO;
+
+    float p = EXP_P0;
+    p = p * r + EXP_P1;
+    p = p * r + EXP_P2;
+    p = p * r + EXP_P3;
+    p = p * r + EXP_P4;
+    p = p * r + EXP_P5;
+    const float y = p * (r * r) + r + 1.0f;
+
+    // 2^n, built in the exponent field
+    const int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return y * scale;
+}
+
+static int64_t seconds_until(time_t due, time_t now)
+{
+    // Wrapping subtraction, as in the vector kernel
+    const int64_t seconds = static_cast<int64_t>(static_cast<uint64_t>(due) - static_cast<uint64_t>(now));
+    return std::min(std::max(seconds, -MAX_SECONDS), MAX_SECONDS);
+}
+
+/**
+ * Compute deadline pressure component based on hours left until due time
+ */
+static float deadline_pressure(int64_t seconds)
+{
+    /**
+     * Pressure function: pressure = exp(-T, t)
+     * T = time until deadline in hours
+     * t = time constant (half life of pressure in hours)
+     */
+    float T = static_cast<float>(static_cast<double>(seconds) / 3600.0);
+
+    // Linear scaling for overdue tasks to avoid very large pressures
+    if (T < 0)
+    {
+        return std::max(std::abs(T), 1.0f);
+    }
+
+    return exp_neg(-T / PRESSURE_HALF_LIFE);
+}
+
+// Normalize priority and effort to [0, 1] and weight them
+static double priority_term(int8_t priority, const ScoreWeights &weights)
+{
+    double P_norm = (static_cast<int>(priority) - static_cast<int>(Priority::VERY_LOW)) / static_cast<int>(Priority::VERY_HIGH);
+    return weights.priority_weight * P_norm;
+}
+
+static double scope_term(int8_t scope, const ScoreWeights &weights)
+{
+    double E_norm = (static_cast<int>(scope) - static_cast<int>(Scope::XS)) / static_cast<int>(Scope::XL);
+    return weights.scope_weight * E_norm;
+}
+
+float urgency_score(int8_t priority, int8_t scope, time_t due_date, time_t now, const ScoreWeights &weights)
+{
+    //! Should have multiple types of sorting factors, for now we do hardest first
+
+    /** Eat the frog
+      score_frog = w_u * U
+      + w_p * P_norm
+      + w_e * E_norm
+     */
+
+    // Compute deadline pressure, from [0, 1] or [1, inf) if overdue, or constant C if undated
+    double pressure = due_date ? deadline_pressure(seconds_until(due_date, now)) : weights.undated_pressure_constant;
+
+    return weights.due_date_weight * pressure + priority_term(priority, weights) + scope_term(scope, weights);
+}
+
+static void score_scalar(const time_t *due_date, const int8_t *priority, const int8_t *scope, size_t count,
+                         time_t now, const ScoreWeights &weights, float *out)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = urgency_score(priority[i], scope[i], due_date[i], now, weights);
+    }
+}
+
+#ifdef MCAL_URGENCY_AVX2
+static_assert(sizeof(time_t) == sizeof(int64_t), "the AVX2 kernel loads due dates as 64 bit lanes");
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// exp_neg() on 8 lanes
+AVX2_TARGET static __m256 exp_neg_avx2(__m256 x)
+{
+    const __m256 underflow = _mm256_cmp_ps(x, _mm256_set1_ps(EXP_MIN), _CMP_LT_OQ);
+
+    const __m256i ni = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)));
+    const __m256 n = _mm256_cvtepi32_ps(ni);
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(LN2_HI)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(n, _mm256_set1_ps(LN2_LO)));
+
+    __m256 p = _mm256_set1_ps(EXP_P0);
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(EXP_P1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(EXP_P2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(EXP_P3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(EXP_P4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(EXP_P5));
+    const __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p, _mm256_mul_ps(r, r)), r), _mm256_set1_ps(1.0f));
+
+    const __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(ni, _mm256_set1_epi32(127)), 23));
+    return _mm256_andnot_ps(underflow, _mm256_mul_ps(y, scale));
+}
+
+// Hours until 4 due dates, through the same double division as deadline_pressure()
+AVX2_TARGET static __m128 hours_until(const time_t *due, __m256i now)
+{
+    const __m256i max = _mm256_set1_epi64x(MAX_SECONDS);
+    const __m256i min = _mm256_set1_epi64x(-MAX_SECONDS);
+    __m256i seconds = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(due)), now);
+    seconds = _mm256_blendv_epi8(seconds, max, _mm256_cmpgt_epi64(seconds, max));
+    seconds = _mm256_blendv_epi8(seconds, min, _mm256_cmpgt_epi64(min, seconds));
+
+    // int64 to double by way of the 2^52 + 2^51 bias; exact below 2^51
+    const __m256d bias = _mm256_set1_pd(6755399441055744.0);
+    const __m256d exact = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(seconds, _mm256_castpd_si256(bias))), bias);
+    return _mm256_cvtpd_ps(_mm256_div_pd(exact, _mm256_set1_pd(3600.0)));
+}
+
+// Four int8 column entries as table indexes
+AVX2_TARGET static __m128i load_indexes(const int8_t *column)
+{
+    int32_t packed;
+    std::memcpy(&packed, column, sizeof(packed));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+}
+
+AVX2_TARGET static void score_avx2(const time_t *due_date, const int8_t *priority, const int8_t *scope, size_t count,
+                                   time_t now, const ScoreWeights &weights, float *out)
+{
+    // Priority and scope terms for every int8 value, indexed by its unsigned byte
+    double priority_terms[256];
+    double scope_terms[256];
+    for (int i = 0; i < 256; i++)
+    {
+        priority_terms[i] = priority_term(static_cast<int8_t>(i), weights);
+        scope_terms[i] = scope_term(static_cast<int8_t>(i), weights);
+    }
+
+    const __m256i now4 = _mm256_set1_epi64x(now);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 half_life = _mm256_set1_ps(PRESSURE_HALF_LIFE);
+    const __m256d w_u = _mm256_set1_pd(weights.due_date_weight);
+    const __m256d undated_pressure = _mm256_set1_pd(weights.undated_pressure_constant);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); // Gather every lane
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 T = _mm256_insertf128_ps(_mm256_castps128_ps256(hours_until(due_date + i, now4)),
+                                              hours_until(due_date + i + 4, now4), 1);
+
+        const __m256 overdue = _mm256_cmp_ps(T, _mm256_setzero_ps(), _CMP_LT_OQ);
+        const __m256 late = _mm256_max_ps(_mm256_andnot_ps(sign, T), _mm256_set1_ps(1.0f));
+        const __m256 ahead = exp_neg_avx2(_mm256_div_ps(_mm256_xor_ps(T, sign), half_life));
+        const __m256 pressure = _mm256_blendv_ps(ahead, late, overdue);
+
+        // Weighted sum in double, four rows at a time
+        for (size_t half = 0; half < 2; half++)
+        {
+            const size_t row = i + 4 * half;
+            __m256d p = _mm256_cvtps_pd(half ? _mm256_extractf128_ps(pressure, 1) : _mm256_castps256_ps128(pressure));
+            const __m256i undated = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(due_date + row)),
+                                                       _mm256_setzero_si256());
+            p = _mm256_blendv_pd(p, undated_pressure, _mm256_castsi256_pd(undated));
+
+            __m256d u = _mm256_mul_pd(w_u, p);
+            u = _mm256_add_pd(u, _mm256_mask_i32gather_pd(zero, priority_terms, load_indexes(priority + row), all, 8));
+            u = _mm256_add_pd(u, _mm256_mask_i32gather_pd(zero, scope_terms, load_indexes(scope + row), all, 8));
+            _mm_storeu_ps(out + row, _mm256_cvtpd_ps(u));
+        }
+    }
+
+    score_scalar(due_date + i, priority + i, scope + i, count - i, now, weights, out + i);
+}
+#endif
+
+UrgencyKernel best_urgency_kernel()
+{
+#ifdef MCAL_URGENCY_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2)
+        return UrgencyKernel::AVX2;
+#endif
+    return UrgencyKernel::SCALAR;
+}
+
+const char *urgency_kernel_name(UrgencyKernel kernel)
+{
+    switch (kernel)
+    {
+    case UrgencyKernel::SCALAR:
+        return "scalar";
+    case UrgencyKernel::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void score_urgency(const time_t *due_date, const int8_t *priority, const int8_t *scope, size_t count,
+                   time_t now, const ScoreWeights &weights, float *out)
+{
+    score_urgency(best_urgency_kernel(), due_date, priority, scope, count, now, weights, out);
+}
+
+// A kernel the CPU cannot run falls back to the scalar one
+void score_urgency(UrgencyKernel kernel, const time_t *due_date, const int8_t *priority, const int8_t *scope,
+                   size_t count, time_t now, const ScoreWeights &weights, float *out)
+{
+#ifdef MCAL_URGENCY_AVX2
+    if (kernel == UrgencyKernel::AVX2 && best_urgency_kernel() == UrgencyKernel::AVX2)
+    {
+        score_avx2(due_date, priority, scope, count, now, weights, out);
+        return;
+    }
+#endif
+    score_scalar(due_date, priority, scope, count, now, weights, out);
+}
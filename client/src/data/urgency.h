@@ -0,0 +1,34 @@
+/// @file urgency.h
+/// @brief Batch urgency scoring over contiguous task columns
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#include "task.h"
+
+/**
+ * The "eat the frog" score of Task::base_urgency, computed for a whole column of tasks at once.
+ * Every kernel produces the same bits for the same inputs, so scores do not depend on the CPU
+ * the client happens to run on or on which path scored a task; Task::base_urgency itself goes
+ * through urgency_score().
+ */
+enum class UrgencyKernel
+{
+    SCALAR = 0,
+    AVX2 = 1, // x86-64 only, chosen when the CPU supports it
+};
+
+// Fastest kernel this build and CPU can run
+UrgencyKernel best_urgency_kernel();
+const char *urgency_kernel_name(UrgencyKernel kernel);
+
+// Score of a single task, with deadline pressure measured from `now`
+float urgency_score(int8_t priority, int8_t scope, time_t due_date, time_t now, const ScoreWeights &weights);
+
+// urgency_score() for rows [0, count) of the given columns, written to out
+void score_urgency(const time_t *due_date, const int8_t *priority, const int8_t *scope, size_t count,
+                   time_t now, const ScoreWeights &weights, float *out);
+void score_urgency(UrgencyKernel kernel, const time_t *due_date, const int8_t *priority, const int8_t *scope,
+                   size_t count, time_t now, const ScoreWeights &weights, float *out);
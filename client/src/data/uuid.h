@@ -6,55 +6,165 @@
 #pragma once
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 
-#define UUID_LEN 37 // 36 chars + null
+#define UUID_LEN 37  // Text form: 36 chars + null
+#define UUID_BYTES 16 // Binary form, as stored in the database
 
 #define TaskHash std::unordered_map<UUID, std::unique_ptr<Task>>
 
+/**
+ * 128-bit UUID held as its 16 bytes in RFC 4122 order. Comparing the bytes orders UUIDs the same
+ * way as comparing their canonical lowercase text, so the binary form can stand in for the text
+ * everywhere except the JSON / UI boundary, where text() and the const char * constructor convert.
+ * The all-zero UUID is the empty one.
+ */
 struct UUID
 {
-    char value[UUID_LEN];
+    alignas(8) unsigned char bytes[UUID_BYTES];
+
+    // Canonical text of a UUID, in a buffer that lives as long as the returned object
+    struct Text
+    {
+        char value[UUID_LEN];
+
+        operator const char *() const noexcept
+        {
+            return value;
+        }
+
+        const char *c_str() const noexcept
+        {
+            return value;
+        }
+    };
 
     // Default constructor
     UUID()
     {
-        value[0] = '\0';
+        std::memset(bytes, 0, UUID_BYTES);
     }
 
-    // Construct from C-string
+    // Parse canonical text ("xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx", either case); anything else gives the empty UUID
     UUID(const char *str)
     {
-        if (str)
+        if (!parse(str, *this))
+            std::memset(bytes, 0, UUID_BYTES);
+    }
+
+    static UUID from_bytes(const void *data)
+    {
+        UUID uuid;
+        std::memcpy(uuid.bytes, data, UUID_BYTES);
+        return uuid;
+    }
+
+    static bool parse(const char *str, UUID &out)
+    {
+        if (!str)
+            return false;
+        int n = 0;
+        for (int i = 0; i < UUID_LEN - 1; i++)
+        {
+            char c = str[i];
+            if (i == 8 || i == 13 || i == 18 || i == 23)
+            {
+                if (c != '-')
+                    return false;
+                continue;
+            }
+            int nibble = hex_value(c);
+            if (nibble < 0)
+                return false;
+            if (n % 2 == 0)
+                out.bytes[n / 2] = nibble << 4;
+            else
+                out.bytes[n / 2] |= nibble;
+            n++;
+        }
+        return str[UUID_LEN - 1] == '\0';
+    }
+
+    // Lowercase canonical text; the empty UUID gives an empty string, as an unset one always has
+    Text text() const noexcept
+    {
+        static const char digits[] = "0123456789abcdef";
+        Text t;
+        if (empty())
         {
-            std::strncpy(value, str, UUID_LEN - 1);
-            value[UUID_LEN - 1] = '\0';
+            t.value[0] = '\0';
+            return t;
         }
-        else
+        char *out = t.value;
+        for (int i = 0; i < UUID_BYTES; i++)
         {
-            value[0] = '\0';
+            if (i == 4 || i == 6 || i == 8 || i == 10)
+                *out++ = '-';
+            *out++ = digits[bytes[i] >> 4];
+            *out++ = digits[bytes[i] & 0xf];
         }
+        *out = '\0';
+        return t;
+    }
+
+    // The two 64-bit halves, high bytes first, so they compare like the text does
+    uint64_t high() const noexcept
+    {
+        return load_be(bytes);
     }
 
-    // Allow use anywhere const char* is expected
-    operator const char *() const noexcept
+    uint64_t low() const noexcept
     {
-        return value;
+        return load_be(bytes + 8);
     }
 
-    const char *c_str() const noexcept
+    bool empty() const noexcept
     {
-        return value;
+        return (word(0) | word(1)) == 0;
     }
 
     // Equality operator
     bool operator==(const UUID &other) const noexcept
     {
-        return std::strncmp(value, other.value, UUID_LEN) == 0;
+        return word(0) == other.word(0) && word(1) == other.word(1);
     }
 
     bool operator!=(const UUID &other) const noexcept
     {
         return !(*this == other);
     }
-};
\ No newline at end of file
+
+    bool operator<(const UUID &other) const noexcept
+    {
+        return high() != other.high() ? high() < other.high() : low() < other.low();
+    }
+
+    // Raw halves in memory order, for equality and hashing
+    uint64_t word(int i) const noexcept
+    {
+        uint64_t w;
+        std::memcpy(&w, bytes + 8 * i, sizeof(w));
+        return w;
+    }
+
+private:
+    static int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    static uint64_t load_be(const unsigned char *p)
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++)
+            v = (v << 8) | p[i];
+        return v;
+    }
+};
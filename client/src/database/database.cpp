@@ -1,6 +1,8 @@
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <time.h>
+#include <chrono>
 #include <unordered_map>
 
 #include "database.h"
@@ -17,6 +19,11 @@ void generate_uuid(char *uuid_buf)
     uuid_unparse_lower(binuuid, uuid_buf);
 }
 
+void generate_uuid(UUID &uuid)
+{
+    uuid_generate_random(uuid.bytes);
+}
+
 // Utility: Get current epoch time
 time_t get_current_epoch()
 {
@@ -24,6 +31,7 @@ time_t get_current_epoch()
 }
 
 /** Database schema
+ * UUID columns (uuid, *_uuid) hold the UUID's 16 bytes as a BLOB, in RFC 4122 byte order.
  * Tables:
  * timeblocks:
  *  uuid (PK)           - unique identifier for timeblock
@@ -61,54 +69,983 @@ time_t get_current_epoch()
  *  uuid (PK)           - UUID of entry that was changed
  *  table_name          - name of table that was changed (timeblocks, tasks, habit_entries, entry_links)
  *  last_modified       - time since epoch of when the change was made
+ *  seq                 - position in the local change sequence (client_sync_state.receipt_seq);
+ *                        receipts are sent in seq order and pruned by it once acknowledged
+ *  changed             - timeblock / task receipts: bit mask of the columns changed since the last
+ *                        acknowledged sync, in TIMEBLOCK_SYNC_FIELDS / TASK_SYNC_FIELDS order
+ * field_clocks:
+ *  uuid (PK)           - UUID of a timeblock or task
+ *  field (PK)          - index of the column in TIMEBLOCK_SYNC_FIELDS / TASK_SYNC_FIELDS
+ *  hlc                 - hybrid logical clock of the column's last change, local or from the server
+ * client_sync_state (one row):
+ *  last_server_version - server version the client has applied every change up to
+ *  receipt_seq, hlc    - counters behind receipt seq numbers and field clocks
+ *  download_*          - where an interrupted download resumes: the server version it runs up to
+ *                        and either the stream cursor or the manifest tables left, with cursors
+ *  inflight_*          - upload page sent but not yet acknowledged: its batch id and receipt seq
  */
 
+// Tables, created when missing. UUID columns hold 16-byte BLOBs; migrate_binary_uuids rebuilds
+// tables from before that, which held the 36-character text.
+static const char *const SCHEMA_TABLES =
+    "CREATE TABLE IF NOT EXISTS timeblocks ( \
+        uuid BLOB PRIMARY KEY, \
+        status INTEGER NOT NULL, \
+        name TEXT NOT NULL, \
+        description TEXT, \
+        day_frequency INTEGER NOT NULL, \
+        duration INTEGER NOT NULL, \
+        start INTEGER, \
+        day_start INTEGER, \
+        completed_datetime INTEGER \
+    ); \
+    CREATE TABLE IF NOT EXISTS tasks( \
+        uuid BLOB PRIMARY KEY, \
+        timeblock_uuid BLOB NOT NULL,  \
+        name TEXT NOT NULL, \
+        description TEXT, \
+        due_date INTEGER, \
+        priority INTEGER NOT NULL, \
+        scope INTEGER NOT NULL, \
+        status INTEGER NOT NULL, \
+        goal_spec INTEGER NOT NULL, \
+        completed_datetime INTEGER, \
+        FOREIGN KEY(timeblock_uuid) REFERENCES timeblocks(uuid) ON DELETE CASCADE); \
+    CREATE TABLE IF NOT EXISTS habit_entries( \
+        task_uuid BLOB NOT NULL, \
+        date TEXT NOT NULL, \
+        PRIMARY KEY(task_uuid, date), \
+        FOREIGN KEY(task_uuid) REFERENCES tasks(uuid) ON DELETE CASCADE); \
+    CREATE TABLE IF NOT EXISTS entry_links( \
+        parent_uuid BLOB NOT NULL, \
+        child_uuid BLOB NOT NULL, \
+        link_type INTEGER NOT NULL, \
+        PRIMARY KEY(parent_uuid, child_uuid), \
+        FOREIGN KEY(parent_uuid) REFERENCES tasks(uuid) ON DELETE CASCADE, \
+        FOREIGN KEY(child_uuid) REFERENCES tasks(uuid) ON DELETE CASCADE);";
+static const char *const SCHEMA_SYNC_TABLES =
+    "CREATE TABLE IF NOT EXISTS timeblock_change_receipts ( \
+        uuid BLOB PRIMARY KEY, \
+        status INTEGER NOT NULL, \
+        name TEXT NOT NULL, \
+        description TEXT, \
+        day_frequency INTEGER NOT NULL, \
+        duration INTEGER NOT NULL, \
+        start INTEGER, \
+        day_start INTEGER, \
+        completed_datetime INTEGER, \
+        modified_at INTEGER NOT NULL, \
+        deleted_at INTEGER, \
+        seq INTEGER NOT NULL DEFAULT 0, \
+        changed INTEGER NOT NULL DEFAULT -1 \
+    ); \
+    CREATE TABLE IF NOT EXISTS task_change_receipts ( \
+        uuid BLOB PRIMARY KEY, \
+        timeblock_uuid BLOB NOT NULL,  \
+        name TEXT NOT NULL, \
+        description TEXT, \
+        due_date INTEGER, \
+        priority INTEGER NOT NULL, \
+        scope INTEGER NOT NULL, \
+        status INTEGER NOT NULL, \
+        goal_spec INTEGER NOT NULL, \
+        completed_datetime INTEGER, \
+        modified_at INTEGER NOT NULL, \
+        deleted_at INTEGER, \
+        seq INTEGER NOT NULL DEFAULT 0, \
+        changed INTEGER NOT NULL DEFAULT -1 \
+    ); \
+    CREATE TABLE IF NOT EXISTS habit_entry_change_receipts ( \
+        task_uuid BLOB NOT NULL, \
+        date TEXT NOT NULL, \
+        modified_at INTEGER NOT NULL, \
+        deleted_at INTEGER, \
+        seq INTEGER NOT NULL DEFAULT 0, \
+        PRIMARY KEY(task_uuid, date) \
+    ); \
+    CREATE TABLE IF NOT EXISTS entry_link_change_receipts ( \
+        parent_uuid BLOB NOT NULL, \
+        child_uuid BLOB NOT NULL, \
+        link_type INTEGER NOT NULL, \
+        modified_at INTEGER NOT NULL, \
+        deleted_at INTEGER, \
+        seq INTEGER NOT NULL DEFAULT 0, \
+        PRIMARY KEY(parent_uuid, child_uuid) \
+    ); \
+    CREATE TABLE IF NOT EXISTS client_sync_state ( \
+        id INTEGER PRIMARY KEY CHECK (id = 1), \
+        last_server_version INTEGER NOT NULL DEFAULT 0, \
+        receipt_seq INTEGER NOT NULL DEFAULT 0, \
+        hlc INTEGER NOT NULL DEFAULT 0, \
+        download_upto INTEGER NOT NULL DEFAULT 0, \
+        download_cursor TEXT, \
+        download_tables TEXT, \
+        inflight_batch TEXT, \
+        inflight_seq INTEGER NOT NULL DEFAULT 0 \
+    ); \
+    CREATE TABLE IF NOT EXISTS field_clocks ( \
+        uuid BLOB NOT NULL, \
+        field INTEGER NOT NULL, \
+        hlc INTEGER NOT NULL, \
+        PRIMARY KEY(uuid, field) \
+    ) WITHOUT ROWID;";
+
+/* -------------------------------------------------------------------------- */
+/*                               Statement cache                              */
+/* -------------------------------------------------------------------------- */
+
+// Return a ready-to-bind statement for `sql`, preparing it on first use. Cached statements are
+// reset and have their bindings cleared before being handed out, so callers only need to bind,
+// step and sqlite3_reset() when done. Returns nullptr if the statement could not be prepared.
+sqlite3_stmt *Database::prepare_cached(const char *sql)
+{
+    auto it = m_stmt_cache.find(sql);
+    if (it != m_stmt_cache.end())
+    {
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+
+    m_stmt_cache.emplace(sql, stmt);
+    return stmt;
+}
+
+// Run a cached statement that returns no rows (transaction control)
+int Database::exec_cached(const char *sql)
+{
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
+        return sqlite3_errcode(db);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Batches                                  */
+/* -------------------------------------------------------------------------- */
+
+// The outermost batch opens a write transaction; batches opened inside it become savepoints so an
+// inner failure can be rolled back without discarding the work of the enclosing batch.
+Database::Batch::Batch(Database &db) : m_db(db)
+{
+    const char *TAG = "DB::Batch";
+
+    m_nested = m_db.m_batch_depth > 0;
+    int rc = m_db.exec_cached(m_nested ? "SAVEPOINT batch;" : "BEGIN IMMEDIATE;");
+    if (rc != SQLITE_OK)
+    {
+        LOGE(TAG, "Failed to open batch: %s", sqlite3_errmsg(m_db.db));
+        throw rc;
+    }
+    m_db.m_batch_depth++;
+}
+
+Database::Batch::~Batch()
+{
+    if (m_done)
+        return;
+
+    // Not committed (early exit or exception): discard everything written in this scope
+    m_db.m_batch_depth--;
+    if (m_nested)
+    {
+        m_db.exec_cached("ROLLBACK TO batch;");
+        m_db.exec_cached("RELEASE batch;");
+    }
+    else
+    {
+        m_db.exec_cached("ROLLBACK;");
+    }
+    LOGW("DB::Batch", "Batch rolled back");
+}
+
+void Database::Batch::commit()
+{
+    const char *TAG = "DB::Batch::commit";
+
+    if (m_done)
+        return;
+
+    int rc = m_db.exec_cached(m_nested ? "RELEASE batch;" : "COMMIT;");
+    if (rc != SQLITE_OK)
+    {
+        // Leave m_done unset so the destructor rolls the batch back
+        LOGE(TAG, "Failed to commit batch: %s", sqlite3_errmsg(m_db.db));
+        throw rc;
+    }
+    m_db.m_batch_depth--;
+    m_done = true;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              Storage profiles                              */
+/* -------------------------------------------------------------------------- */
+
+StorageProfile StorageProfile::preset(const std::string &name)
+{
+    StorageProfile p; // balanced
+    if (name == "durable")
+    {
+        p.synchronous = "FULL";
+        p.cache_size = -2000;
+        p.mmap_size = 0;
+        p.temp_store = "DEFAULT";
+    }
+    else if (name == "fast")
+    {
+        p.synchronous = "OFF";
+        p.cache_size = -65536;
+        p.mmap_size = 256LL << 20;
+    }
+    else if (name != "balanced")
+    {
+        LOGW("StorageProfile", "Unknown storage profile '%s'; using balanced", name.c_str());
+    }
+    return p;
+}
+
+// Whether an existing table already has the given column, for migrations that add one
+static bool has_column(sqlite3 *db, const char *table, const char *column)
+{
+    std::string sql = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt *stmt = nullptr;
+    bool found = false;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK)
+    {
+        while (!found && sqlite3_step(stmt) == SQLITE_ROW)
+            found = strcmp((const char *)sqlite3_column_text(stmt, 1), column) == 0;
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+// Receipt tables from before sequence numbers get a seq column, with the receipts already in them
+// numbered in rowid order, and the seq indexes are created. One transaction, so connections
+// opening the same file at once migrate it only once.
+static int migrate_receipt_seq(sqlite3 *db)
+{
+    const char *TAG = "DB::migrate_receipt_seq";
+    static const char *const RECEIPT_TABLES[] = {
+        "timeblock_change_receipts", "task_change_receipts", "habit_entry_change_receipts", "entry_link_change_receipts"};
+
+    int rc = sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        return rc;
+
+    std::string sql;
+    if (!has_column(db, "client_sync_state", "receipt_seq"))
+        sql += "ALTER TABLE client_sync_state ADD COLUMN receipt_seq INTEGER NOT NULL DEFAULT 0;";
+    for (const char *table : RECEIPT_TABLES)
+    {
+        if (!has_column(db, table, "seq"))
+        {
+            LOGI(TAG, "Numbering existing receipts in %s", table);
+            sql += std::string("ALTER TABLE ") + table + " ADD COLUMN seq INTEGER NOT NULL DEFAULT 0;" +
+                   "UPDATE " + table + " SET seq = rowid + (SELECT receipt_seq FROM client_sync_state WHERE id = 1);" +
+                   "UPDATE client_sync_state SET receipt_seq = receipt_seq + (SELECT COALESCE(MAX(rowid), 0) FROM " + table + ") WHERE id = 1;";
+        }
+        // Acknowledged receipts are pruned, and pending ones read, by seq range
+        sql += std::string("CREATE INDEX IF NOT EXISTS ") + table + "_seq ON " + table + "(seq);";
+    }
+
+    rc = sqlite3_exec(db, sql.c_str(), 0, 0, 0);
+    if (rc == SQLITE_OK)
+        rc = sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    return rc;
+}
+
+// Receipt tables from before field clocks get a changed mask (every column, as their snapshots were
+// sent whole) and the sync state a clock. The field_clocks table itself is created with the schema.
+static int migrate_field_clocks(sqlite3 *db)
+{
+    int rc = sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        return rc;
+
+    std::string sql;
+    if (!has_column(db, "client_sync_state", "hlc"))
+        sql += "ALTER TABLE client_sync_state ADD COLUMN hlc INTEGER NOT NULL DEFAULT 0;";
+    if (!has_column(db, "timeblock_change_receipts", "changed"))
+        sql += "ALTER TABLE timeblock_change_receipts ADD COLUMN changed INTEGER NOT NULL DEFAULT -1;";
+    if (!has_column(db, "task_change_receipts", "changed"))
+        sql += "ALTER TABLE task_change_receipts ADD COLUMN changed INTEGER NOT NULL DEFAULT -1;";
+
+    rc = sqlite3_exec(db, sql.c_str(), 0, 0, 0);
+    if (rc == SQLITE_OK)
+        rc = sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    return rc;
+}
+
+// The sync state gets the columns an interrupted exchange resumes from, all empty
+static int migrate_resume_state(sqlite3 *db)
+{
+    int rc = sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        return rc;
+
+    if (!has_column(db, "client_sync_state", "download_upto"))
+        rc = sqlite3_exec(db,
+                          "ALTER TABLE client_sync_state ADD COLUMN download_upto INTEGER NOT NULL DEFAULT 0;"
+                          "ALTER TABLE client_sync_state ADD COLUMN download_cursor TEXT;"
+                          "ALTER TABLE client_sync_state ADD COLUMN download_tables TEXT;"
+                          "ALTER TABLE client_sync_state ADD COLUMN inflight_batch TEXT;"
+                          "ALTER TABLE client_sync_state ADD COLUMN inflight_seq INTEGER NOT NULL DEFAULT 0;",
+                          0, 0, 0);
+    if (rc == SQLITE_OK)
+        rc = sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    return rc;
+}
+
+// Column names of a table, in declaration order
+static std::vector<std::string> table_columns(sqlite3 *db, const char *table)
+{
+    std::string sql = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt *stmt = nullptr;
+    std::vector<std::string> columns;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK)
+    {
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+            columns.push_back((const char *)sqlite3_column_text(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+    return columns;
+}
+
+static bool has_text_uuids(sqlite3 *db)
+{
+    sqlite3_stmt *stmt = nullptr;
+    bool text = false;
+    if (sqlite3_prepare_v2(db, "SELECT type FROM pragma_table_info('timeblocks') WHERE name = 'uuid';", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+        text = strcasecmp((const char *)sqlite3_column_text(stmt, 0), "TEXT") == 0;
+    sqlite3_finalize(stmt);
+    return text;
+}
+
+// uuid_blob(value): the 16 bytes of a UUID given as text; anything else is returned unchanged
+static void uuid_blob(sqlite3_context *ctx, int, sqlite3_value **argv)
+{
+    UUID uuid;
+    if (sqlite3_value_type(argv[0]) == SQLITE_TEXT && UUID::parse((const char *)sqlite3_value_text(argv[0]), uuid))
+        sqlite3_result_blob(ctx, uuid.bytes, UUID_BYTES, SQLITE_TRANSIENT);
+    else
+        sqlite3_result_value(ctx, argv[0]);
+}
+
+// Tables from before binary keys held UUIDs as text. Each is renamed, made again from the schema
+// with BLOB columns and copied over with its UUIDs converted, then its indexes are recreated.
+// Foreign keys are off meanwhile, since parents and children are rebuilt one at a time.
+static int migrate_binary_uuids(sqlite3 *db)
+{
+    const char *TAG = "DB::migrate_binary_uuids";
+    static const char *const UUID_TABLES[] = {
+        "timeblocks", "tasks", "habit_entries", "entry_links", "timeblock_change_receipts", "task_change_receipts",
+        "habit_entry_change_receipts", "entry_link_change_receipts", "field_clocks"};
+
+    if (!has_text_uuids(db))
+        return SQLITE_OK;
+
+    int rc = sqlite3_create_function_v2(db, "uuid_blob", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, uuid_blob, nullptr, nullptr, nullptr);
+    if (rc != SQLITE_OK)
+        return rc;
+    sqlite3_exec(db, "PRAGMA foreign_keys = OFF;", 0, 0, 0);
+    rc = sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+    {
+        sqlite3_exec(db, "PRAGMA foreign_keys = ON;", 0, 0, 0);
+        return rc;
+    }
+
+    // Another connection may have migrated the file while this one waited for the lock
+    if (has_text_uuids(db))
+    {
+        LOGI(TAG, "Converting UUID keys to 16-byte BLOBs");
+        std::string rename, copy, indexes;
+        for (const char *table : UUID_TABLES)
+        {
+            std::string old = std::string(table) + "_text";
+            std::string columns, values;
+            for (const std::string &column : table_columns(db, table))
+            {
+                bool key = column == "uuid" || (column.size() > 5 && column.compare(column.size() - 5, 5, "_uuid") == 0);
+                columns += (columns.empty() ? "" : ", ") + column;
+                values += (values.empty() ? "" : ", ") + (key ? "uuid_blob(" + column + ")" : column);
+            }
+
+            // Indexes would follow the renamed table, so they are dropped and made again on the new one
+            sqlite3_stmt *stmt = nullptr;
+            if (sqlite3_prepare_v2(db, "SELECT name, sql FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND sql IS NOT NULL;", -1, &stmt, nullptr) == SQLITE_OK)
+            {
+                sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+                while (sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    rename += std::string("DROP INDEX ") + (const char *)sqlite3_column_text(stmt, 0) + ";";
+                    indexes += std::string((const char *)sqlite3_column_text(stmt, 1)) + ";";
+                }
+            }
+            sqlite3_finalize(stmt);
+
+            rename += std::string("ALTER TABLE ") + table + " RENAME TO " + old + ";";
+            copy += std::string("INSERT INTO ") + table + " (" + columns + ") SELECT " + values + " FROM " + old + ";" +
+                    "DROP TABLE " + old + ";";
+        }
+        std::string sql = rename + SCHEMA_TABLES + SCHEMA_SYNC_TABLES + copy + indexes;
+        rc = sqlite3_exec(db, sql.c_str(), 0, 0, 0);
+    }
+
+    if (rc == SQLITE_OK)
+        rc = sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+    if (rc != SQLITE_OK)
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    sqlite3_exec(db, "PRAGMA foreign_keys = ON;", 0, 0, 0);
+    return rc;
+}
+
+// Pragma keywords are spliced into SQL text, so only accept the documented values
+static bool is_pragma_keyword(const std::string &value, const char *const *allowed)
+{
+    for (; *allowed; allowed++)
+        if (strcasecmp(value.c_str(), *allowed) == 0)
+            return true;
+    return false;
+}
+
+void Database::apply_storage_profile(const StorageProfile &profile)
+{
+    const char *TAG = "DB::apply_storage_profile";
+    static const char *const journalModes[] = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF", nullptr};
+    static const char *const syncModes[] = {"OFF", "NORMAL", "FULL", "EXTRA", nullptr};
+    static const char *const tempStores[] = {"DEFAULT", "FILE", "MEMORY", nullptr};
+
+    // Set before the pragmas below, which may need a lock held by another connection
+    sqlite3_busy_timeout(db, profile.busy_timeout);
+
+    std::vector<std::string> pragmas;
+    // page_size must come first: it cannot change once the file is in WAL mode
+    pragmas.push_back("PRAGMA page_size = " + std::to_string(profile.page_size) + ";");
+    if (is_pragma_keyword(profile.journal_mode, journalModes))
+        pragmas.push_back("PRAGMA journal_mode = " + profile.journal_mode + ";");
+    else
+        LOGW(TAG, "Ignoring invalid journal_mode '%s'", profile.journal_mode.c_str());
+    if (is_pragma_keyword(profile.synchronous, syncModes))
+        pragmas.push_back("PRAGMA synchronous = " + profile.synchronous + ";");
+    else
+        LOGW(TAG, "Ignoring invalid synchronous '%s'", profile.synchronous.c_str());
+    pragmas.push_back("PRAGMA cache_size = " + std::to_string(profile.cache_size) + ";");
+    pragmas.push_back("PRAGMA mmap_size = " + std::to_string(profile.mmap_size) + ";");
+    if (is_pragma_keyword(profile.temp_store, tempStores))
+        pragmas.push_back("PRAGMA temp_store = " + profile.temp_store + ";");
+    else
+        LOGW(TAG, "Ignoring invalid temp_store '%s'", profile.temp_store.c_str());
+
+    for (const std::string &pragma : pragmas)
+    {
+        char *errmsg = nullptr;
+        if (sqlite3_exec(db, pragma.c_str(), 0, 0, &errmsg) != SQLITE_OK)
+        {
+            // Tuning is best effort; the database is still usable with SQLite's defaults
+            LOGW(TAG, "%s failed: %s", pragma.c_str(), errmsg);
+            sqlite3_free(errmsg);
+        }
+    }
+
+    LOGI(TAG, "journal_mode=%s synchronous=%s cache_size=%d mmap_size=%lld temp_store=%s page_size=%d busy_timeout=%d",
+         profile.journal_mode.c_str(), profile.synchronous.c_str(), profile.cache_size, profile.mmap_size,
+         profile.temp_store.c_str(), profile.page_size, profile.busy_timeout);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Field clocks                                */
+/* -------------------------------------------------------------------------- */
+
+const char *const TIMEBLOCK_SYNC_FIELDS[TIMEBLOCK_SYNC_FIELD_COUNT] = {
+    "status", "name", "description", "day_frequency", "duration", "start", "day_start", "completed_datetime"};
+const char *const TASK_SYNC_FIELDS[TASK_SYNC_FIELD_COUNT] = {
+    "timeblock_uuid", "name", "description", "due_date", "priority", "scope", "status", "goal_spec", "completed_datetime"};
+
+Hlc hlc_from_seconds(time_t seconds)
+{
+    sqlite3_int64 ms = (sqlite3_int64)seconds * 1000 - HLC_EPOCH_MS;
+    return ms > 0 ? ms << HLC_COUNTER_BITS : 0;
+}
+
+static FieldValue timeblock_field(const Timeblock &tb, int field)
+{
+    switch (field)
+    {
+    case 0:
+        return {nullptr, static_cast<int>(tb.status)};
+    case 1:
+        return {tb.name ? tb.name : "", 0};
+    case 2:
+        return {tb.desc ? tb.desc : "", 0};
+    case 3:
+        return {nullptr, tb.day_frequency.to_sql()};
+    case 4:
+        return {nullptr, tb.duration};
+    case 5:
+        return {nullptr, tb.start};
+    case 6:
+        return {nullptr, tb.day_start};
+    default:
+        return {nullptr, tb.completed_datetime};
+    }
+}
+
+static FieldValue task_field(const Task &task, int field)
+{
+    switch (field)
+    {
+    case 0:
+        return {nullptr, 0, &task.timeblock_uuid};
+    case 1:
+        return {task.name ? task.name : "", 0};
+    case 2:
+        return {task.desc ? task.desc : "", 0};
+    case 3:
+        return {nullptr, task.due_date};
+    case 4:
+        return {nullptr, static_cast<int>(task.priority)};
+    case 5:
+        return {nullptr, static_cast<int>(task.scope)};
+    case 6:
+        return {nullptr, static_cast<int>(task.status)};
+    case 7:
+        return {nullptr, task.goal_spec.to_sql()};
+    default:
+        return {nullptr, task.completed_datetime};
+    }
+}
+
+// Orders values for the tie-break between equal clocks: numbers below text, numbers by value,
+// text by UTF-8 bytes (the server orders them the same way). UUIDs rank as text and their bytes
+// order like their text.
+static int compare_field(const FieldValue &a, const FieldValue &b)
+{
+    if (a.uuid && b.uuid)
+        return *a.uuid < *b.uuid ? -1 : *b.uuid < *a.uuid;
+    if (a.uuid || b.uuid)
+        return a.uuid ? 1 : -1;
+    if (a.text && b.text)
+        return strcmp(a.text, b.text);
+    if (a.text || b.text)
+        return a.text ? 1 : -1;
+    return a.number < b.number ? -1 : a.number > b.number;
+}
+
+// The server's value wins a column with a later clock, or with an equal clock and a greater value
+static bool server_field_wins(Hlc serverClock, const FieldValue &serverValue, Hlc localClock, const FieldValue &localValue)
+{
+    if (serverClock != localClock)
+        return serverClock > localClock;
+    return compare_field(serverValue, localValue) > 0;
+}
+
+Hlc Database::next_hlc()
+{
+    const char *TAG = "DB::next_hlc";
+
+    sqlite3_int64 ms = (sqlite3_int64)std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+    Hlc physical = (ms - HLC_EPOCH_MS) << HLC_COUNTER_BITS;
+
+    // Runs inside the caller's write, like the receipt sequence
+    sqlite3_stmt *stmt = prepare_cached("UPDATE client_sync_state SET hlc = MAX(hlc + 1, ?) WHERE id = 1;");
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    sqlite3_bind_int64(stmt, 1, physical);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE(TAG, "Failed to advance the clock: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+
+    stmt = prepare_cached("SELECT hlc FROM client_sync_state WHERE id = 1;");
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    rc = sqlite3_step(stmt);
+    Hlc hlc = rc == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_ROW)
+    {
+        LOGE(TAG, "Failed to read the clock: %s", sqlite3_errmsg(db));
+        throw rc;
+    }
+    return hlc;
+}
+
+void Database::observe_hlc(Hlc hlc)
+{
+    sqlite3_stmt *stmt = prepare_cached("UPDATE client_sync_state SET hlc = MAX(hlc, ?) WHERE id = 1;");
+    if (!stmt)
+    {
+        LOGE("DB::observe_hlc", "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    sqlite3_bind_int64(stmt, 1, hlc);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE("DB::observe_hlc", "Failed to observe clock: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
+void Database::write_field_clocks(const UUID &uuid, uint32_t fields, const Hlc *clocks, int count)
+{
+    const char *TAG = "DB::write_field_clocks";
+
+    sqlite3_stmt *stmt = prepare_cached("INSERT OR REPLACE INTO field_clocks (uuid, field, hlc) VALUES (?, ?, ?);");
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    for (int f = 0; f < count; f++)
+    {
+        if (!(fields & (1u << f)))
+            continue;
+        bind_uuid(stmt, 1, uuid);
+        sqlite3_bind_int(stmt, 2, f);
+        sqlite3_bind_int64(stmt, 3, clocks[f]);
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE)
+        {
+            LOGE(TAG, "Failed to stamp field %d of <%s>: %s", f, uuid.text().c_str(), sqlite3_errmsg(db));
+            throw sqlite3_errcode(db);
+        }
+    }
+}
+
+void Database::forget_field_clocks(const UUID &uuid)
+{
+    sqlite3_stmt *stmt = prepare_cached("DELETE FROM field_clocks WHERE uuid = ?;");
+    if (!stmt)
+    {
+        LOGE("DB::forget_field_clocks", "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    bind_uuid(stmt, 1, uuid);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE("DB::forget_field_clocks", "Failed to drop the clocks of <%s>: %s", uuid.text().c_str(), sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
+void Database::load_field_clocks(const UUID &uuid, Hlc *clocks, int count)
+{
+    const char *TAG = "DB::load_field_clocks";
+
+    for (int f = 0; f < count; f++)
+        clocks[f] = 0;
+
+    sqlite3_stmt *stmt = prepare_cached("SELECT field, hlc FROM field_clocks WHERE uuid = ?;");
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    bind_uuid(stmt, 1, uuid);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        int f = sqlite3_column_int(stmt, 0);
+        if (f >= 0 && f < count)
+            clocks[f] = sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_reset(stmt);
+}
+
+bool Database::read_timeblock_row(const UUID &uuid, Timeblock &tb)
+{
+    sqlite3_stmt *stmt = prepare_cached("SELECT * FROM timeblocks WHERE uuid = ?;");
+    if (!stmt)
+    {
+        LOGE("DB::read_timeblock_row", "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    bind_uuid(stmt, 1, uuid);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found)
+    {
+        tb.uuid = column_uuid(stmt, 0);
+        tb.status = static_cast<TimeblockStatus>(sqlite3_column_int(stmt, 1));
+        tb.name = column_string(stmt, 2);
+        tb.desc = column_string(stmt, 3);
+        tb.day_frequency = GoalSpec::from_sql(sqlite3_column_int(stmt, 4));
+        tb.duration = sqlite3_column_int64(stmt, 5);
+        tb.start = sqlite3_column_int64(stmt, 6);
+        tb.day_start = sqlite3_column_int64(stmt, 7);
+        tb.completed_datetime = sqlite3_column_int64(stmt, 8);
+    }
+    sqlite3_reset(stmt);
+    return found;
+}
+
+bool Database::read_task_row(const UUID &uuid, Task &task)
+{
+    sqlite3_stmt *stmt = prepare_cached("SELECT * FROM tasks WHERE uuid = ?;");
+    if (!stmt)
+    {
+        LOGE("DB::read_task_row", "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    bind_uuid(stmt, 1, uuid);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found)
+    {
+        Task row;
+        row.uuid = column_uuid(stmt, 0);
+        row.timeblock_uuid = column_uuid(stmt, 1);
+        row.name = column_string(stmt, 2);
+        row.desc = column_string(stmt, 3);
+        row.due_date = sqlite3_column_int64(stmt, 4);
+        row.priority = static_cast<Priority>(sqlite3_column_int(stmt, 5));
+        row.scope = static_cast<Scope>(sqlite3_column_int(stmt, 6));
+        row.status = static_cast<TaskStatus>(sqlite3_column_int(stmt, 7));
+        row.goal_spec = GoalSpec::from_sql(sqlite3_column_int(stmt, 8));
+        row.completed_datetime = sqlite3_column_int64(stmt, 9);
+        task = std::move(row);
+    }
+    sqlite3_reset(stmt);
+    return found;
+}
+
+uint32_t Database::changed_timeblock_fields(const Timeblock &tb)
+{
+    Timeblock stored;
+    if (!read_timeblock_row(tb.uuid, stored))
+        return SYNC_FIELDS_ALL;
+
+    uint32_t changed = 0;
+    for (int f = 0; f < TIMEBLOCK_SYNC_FIELD_COUNT; f++)
+    {
+        if (compare_field(timeblock_field(tb, f), timeblock_field(stored, f)) != 0)
+            changed |= 1u << f;
+    }
+    return changed;
+}
+
+uint32_t Database::changed_task_fields(const Task &task)
+{
+    Task stored;
+    if (!read_task_row(task.uuid, stored))
+        return SYNC_FIELDS_ALL;
+
+    uint32_t changed = 0;
+    for (int f = 0; f < TASK_SYNC_FIELD_COUNT; f++)
+    {
+        if (compare_field(task_field(task, f), task_field(stored, f)) != 0)
+            changed |= 1u << f;
+    }
+    return changed;
+}
+
+void Database::update_fields(const char *table, const char *const *names, int count, const UUID &uuid,
+                             uint32_t fields, const FieldValue *values)
+{
+    const char *TAG = "DB::update_fields";
+
+    // One statement per combination of columns, cached like any other
+    std::string sql = std::string("UPDATE ") + table + " SET ";
+    bool first = true;
+    for (int f = 0; f < count; f++)
+    {
+        if (!(fields & (1u << f)))
+            continue;
+        sql += std::string(first ? "" : ", ") + names[f] + " = ?";
+        first = false;
+    }
+    sql += " WHERE uuid = ?;";
+
+    sqlite3_stmt *stmt = prepare_cached(sql.c_str());
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    int index = 1;
+    for (int f = 0; f < count; f++)
+    {
+        if (!(fields & (1u << f)))
+            continue;
+        if (values[f].uuid)
+            bind_uuid(stmt, index++, *values[f].uuid);
+        else if (values[f].text)
+            sqlite3_bind_text(stmt, index++, values[f].text, -1, SQLITE_STATIC);
+        else
+            sqlite3_bind_int64(stmt, index++, values[f].number);
+    }
+    bind_uuid(stmt, index, uuid);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE(TAG, "Failed to update %s <%s>: %s", table, uuid.text().c_str(), sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
+void Database::write_merged_fields(const char *table, const char *receipt_table, const char *const *names, int count,
+                                   const UUID &uuid, uint32_t won, const FieldValue *values, const Hlc *clocks)
+{
+    const char *TAG = "DB::write_merged_fields";
+
+    update_fields(table, names, count, uuid, won, values);
+    write_field_clocks(uuid, won, clocks, count);
+
+    // A pending local edit of a column the server won is superseded; a receipt left with no
+    // columns has nothing to send
+    std::string receipt = std::string("UPDATE ") + receipt_table + " SET changed = changed & ~? WHERE uuid = ?;";
+    std::string empty = std::string("DELETE FROM ") + receipt_table + " WHERE uuid = ? AND changed = 0 AND deleted_at IS NULL;";
+    sqlite3_stmt *mask = prepare_cached(receipt.c_str());
+    sqlite3_stmt *prune = prepare_cached(empty.c_str());
+    if (!mask || !prune)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    sqlite3_bind_int64(mask, 1, won);
+    bind_uuid(mask, 2, uuid);
+    int rc = sqlite3_step(mask);
+    sqlite3_reset(mask);
+    if (rc == SQLITE_DONE)
+    {
+        bind_uuid(prune, 1, uuid);
+        rc = sqlite3_step(prune);
+        sqlite3_reset(prune);
+    }
+    if (rc != SQLITE_DONE)
+    {
+        LOGE(TAG, "Failed to update the receipt of <%s>: %s", uuid.text().c_str(), sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
 /* -------------------------------------------------------------------------- */
 /*                          Receipt Tracking Helpers                          */
 /* -------------------------------------------------------------------------- */
 
-void Database::clear_receipts()
+sqlite3_int64 Database::next_receipt_seq()
+{
+    const char *TAG = "DB::next_receipt_seq";
+
+    // Runs inside the caller's write, so the bump and the receipt commit (or roll back) together
+    int rc = exec_cached("UPDATE client_sync_state SET receipt_seq = receipt_seq + 1 WHERE id = 1;");
+    if (rc != SQLITE_OK)
+    {
+        LOGE(TAG, "Failed to advance receipt sequence: %s", sqlite3_errmsg(db));
+        throw rc;
+    }
+    return receipt_seq();
+}
+
+sqlite3_int64 Database::receipt_seq()
 {
-    const char *TAG = "DB::clear_receipts";
+    const char *TAG = "DB::receipt_seq";
+
+    sqlite3_stmt *stmt = prepare_cached("SELECT receipt_seq FROM client_sync_state WHERE id = 1;");
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+    int rc = sqlite3_step(stmt);
+    sqlite3_int64 seq = rc == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_ROW)
+    {
+        LOGE(TAG, "Failed to read receipt sequence: %s", sqlite3_errmsg(db));
+        throw rc;
+    }
+    return seq;
+}
+
+void Database::prune_receipts(sqlite3_int64 through_seq)
+{
+    const char *TAG = "DB::prune_receipts";
     const char *sql[] = {
-        "DELETE FROM timeblock_change_receipts;",
-        "DELETE FROM task_change_receipts;",
-        "DELETE FROM habit_entry_change_receipts;",
-        "DELETE FROM entry_link_change_receipts;"};
+        "DELETE FROM timeblock_change_receipts WHERE seq <= ?;",
+        "DELETE FROM task_change_receipts WHERE seq <= ?;",
+        "DELETE FROM habit_entry_change_receipts WHERE seq <= ?;",
+        "DELETE FROM entry_link_change_receipts WHERE seq <= ?;"};
 
-    for (int i = 0; i < sizeof(sql) / sizeof(sql[0]); i++)
+    // A range over each table's seq index; receipts recorded after the acknowledged position stay
+    int pruned = 0;
+    for (const char *prune : sql)
     {
-        char *errmsg = NULL;
-        int rc = sqlite3_exec(db, sql[i], 0, 0, &errmsg);
-        if (rc != SQLITE_OK)
+        sqlite3_stmt *stmt = prepare_cached(prune);
+        if (!stmt)
         {
-            LOGE(TAG, "SQL error while clearing receipts: %s", errmsg);
-            sqlite3_free(errmsg);
+            LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+            throw sqlite3_errcode(db);
+        }
+        sqlite3_bind_int64(stmt, 1, through_seq);
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE)
+        {
+            LOGE(TAG, "Failed to prune receipts: %s", sqlite3_errmsg(db));
             throw rc;
         }
+        pruned += sqlite3_changes(db);
     }
-
-    LOGI(TAG, "Cleared all change receipts");
+    LOGI(TAG, "Pruned %d acknowledged receipts through seq %lld", pruned, (long long)through_seq);
 }
 
 // Store a snapshot of the given timeblock in the receipt table. If `deleted` is true
 // the deleted_at column is set so the sync logic will know this row has been removed.
-void Database::record_timeblock_receipt(const Timeblock &tb, bool deleted)
+// `changed` is added to the columns still pending from earlier edits, and those columns are
+// stamped with a new clock.
+void Database::record_timeblock_receipt(const Timeblock &tb, bool deleted, uint32_t changed)
 {
     const char *TAG = "DB::record_timeblock_receipt";
     const char *sql =
-        "INSERT OR REPLACE INTO timeblock_change_receipts "
-        "(uuid, status, name, description, day_frequency, duration, start, day_start, completed_datetime, modified_at, deleted_at) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+        "INSERT INTO timeblock_change_receipts "
+        "(uuid, status, name, description, day_frequency, duration, start, day_start, completed_datetime, modified_at, deleted_at, seq, changed) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(uuid) DO UPDATE SET status = excluded.status, name = excluded.name, description = excluded.description, "
+        "day_frequency = excluded.day_frequency, duration = excluded.duration, start = excluded.start, day_start = excluded.day_start, "
+        "completed_datetime = excluded.completed_datetime, modified_at = excluded.modified_at, deleted_at = excluded.deleted_at, "
+        "seq = excluded.seq, changed = changed | excluded.changed;";
+    sqlite3_int64 seq = next_receipt_seq();
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, tb.uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, tb.uuid);
     sqlite3_bind_int(stmt, 2, static_cast<int>(tb.status));
     sqlite3_bind_text(stmt, 3, tb.name, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, tb.desc, -1, SQLITE_STATIC);
@@ -123,13 +1060,25 @@ void Database::record_timeblock_receipt(const Timeblock &tb, bool deleted)
     else
         sqlite3_bind_null(stmt, 11);
 
+    sqlite3_bind_int64(stmt, 12, seq);
+    sqlite3_bind_int64(stmt, 13, (int32_t)changed);
+
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc != SQLITE_DONE)
     {
-        LOGE(TAG, "Failed to record timeblock receipt for UUID <%s>: %s", tb.uuid, sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to record timeblock receipt for UUID <%s>: %s", tb.uuid.text().c_str(), sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
+
+    if (!deleted)
+    {
+        Hlc clocks[TIMEBLOCK_SYNC_FIELD_COUNT];
+        Hlc hlc = next_hlc();
+        for (Hlc &clock : clocks)
+            clock = hlc;
+        write_field_clocks(tb.uuid, changed, clocks, TIMEBLOCK_SYNC_FIELD_COUNT);
+    }
 }
 
 void Database::delete_timeblock_receipt(const Timeblock &tb)
@@ -137,23 +1086,27 @@ void Database::delete_timeblock_receipt(const Timeblock &tb)
     record_timeblock_receipt(tb, true);
 }
 
-void Database::record_task_receipt(const Task &task, bool deleted)
+void Database::record_task_receipt(const Task &task, bool deleted, uint32_t changed)
 {
     const char *TAG = "DB::record_task_receipt";
     const char *sql =
-        "INSERT OR REPLACE INTO task_change_receipts "
-        "(uuid, timeblock_uuid, name, description, due_date, priority, scope, status, goal_spec, completed_datetime, modified_at, deleted_at) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+        "INSERT INTO task_change_receipts "
+        "(uuid, timeblock_uuid, name, description, due_date, priority, scope, status, goal_spec, completed_datetime, modified_at, deleted_at, seq, changed) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(uuid) DO UPDATE SET timeblock_uuid = excluded.timeblock_uuid, name = excluded.name, description = excluded.description, "
+        "due_date = excluded.due_date, priority = excluded.priority, scope = excluded.scope, status = excluded.status, "
+        "goal_spec = excluded.goal_spec, completed_datetime = excluded.completed_datetime, modified_at = excluded.modified_at, "
+        "deleted_at = excluded.deleted_at, seq = excluded.seq, changed = changed | excluded.changed;";
+    sqlite3_int64 seq = next_receipt_seq();
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task.uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.timeblock_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task.uuid);
+    bind_uuid(stmt, 2, task.timeblock_uuid);
     sqlite3_bind_text(stmt, 3, task.name, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, task.desc, -1, SQLITE_STATIC);
     sqlite3_bind_int64(stmt, 5, task.due_date);
@@ -168,176 +1121,166 @@ void Database::record_task_receipt(const Task &task, bool deleted)
     else
         sqlite3_bind_null(stmt, 12);
 
+    sqlite3_bind_int64(stmt, 13, seq);
+    sqlite3_bind_int64(stmt, 14, (int32_t)changed);
+
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc != SQLITE_DONE)
     {
-        LOGE(TAG, "Failed to record task receipt for UUID <%s>: %s", task.uuid, sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to record task receipt for UUID <%s>: %s", task.uuid.text().c_str(), sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
-}
 
-void Database::delete_task_receipt(const Task &task)
-{
-    const char *TAG = "DB::record_task_receipt";
-    const char *sql =
-        "INSERT OR REPLACE INTO task_change_receipts "
-        "(uuid, timeblock_uuid, name, description, due_date, priority, scope, status, goal_spec, completed_datetime, modified_at, deleted_at) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    if (!deleted)
     {
-        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
-        throw sqlite3_errcode(db);
+        Hlc clocks[TASK_SYNC_FIELD_COUNT];
+        Hlc hlc = next_hlc();
+        for (Hlc &clock : clocks)
+            clock = hlc;
+        write_field_clocks(task.uuid, changed, clocks, TASK_SYNC_FIELD_COUNT);
     }
+}
 
-    sqlite3_bind_text(stmt, 1, task.uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.timeblock_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, task.name, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, task.desc, -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 5, task.due_date);
-    sqlite3_bind_int(stmt, 6, static_cast<int>(task.priority));
-    sqlite3_bind_int(stmt, 7, static_cast<int>(task.scope));
-    sqlite3_bind_int(stmt, 8, static_cast<int>(task.status));
-    sqlite3_bind_int(stmt, 9, task.goal_spec.to_sql());
-    sqlite3_bind_int64(stmt, 10, task.completed_datetime);
-    sqlite3_bind_int64(stmt, 11, get_current_epoch());
-    sqlite3_bind_int64(stmt, 12, get_current_epoch()); // Set deleted_at to current time to indicate deletion
-
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    if (rc != SQLITE_DONE)
-    {
-        LOGE(TAG, "Failed to record task receipt for UUID <%s>: %s", task.uuid, sqlite3_errmsg(db));
-        throw sqlite3_errcode(db);
-    }
+void Database::delete_task_receipt(const Task &task)
+{
+    record_task_receipt(task, true);
 }
 
-void Database::record_habit_entry_receipt(const char *task_uuid, const char *date_iso8601)
+void Database::record_habit_entry_receipt(const UUID &task_uuid, const char *date_iso8601)
 {
     const char *TAG = "DB::record_habit_entry_receipt";
-    const char *sql = "INSERT OR REPLACE INTO habit_entry_change_receipts (task_uuid, date, modified_at, deleted_at) VALUES (?, ?, ?, NULL);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    const char *sql = "INSERT OR REPLACE INTO habit_entry_change_receipts (task_uuid, date, modified_at, deleted_at, seq) VALUES (?, ?, ?, NULL, ?);";
+    sqlite3_int64 seq = next_receipt_seq();
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
     sqlite3_bind_text(stmt, 2, date_iso8601, -1, SQLITE_STATIC);
     sqlite3_bind_int64(stmt, 3, get_current_epoch());
 
+    sqlite3_bind_int64(stmt, 4, seq);
+
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc != SQLITE_DONE)
     {
-        LOGE(TAG, "Failed to record habit entry receipt for task UUID <%s> on date %s: %s", task_uuid, date_iso8601, sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to record habit entry receipt for task UUID <%s> on date %s: %s", task_uuid.text().c_str(), date_iso8601, sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 }
 
-void Database::delete_habit_entry_receipt(const char *task_uuid, const char *date_iso8601)
+void Database::delete_habit_entry_receipt(const UUID &task_uuid, const char *date_iso8601)
 {
     const char *TAG = "DB::delete_habit_entry_receipt";
-    const char *sql = "INSERT OR REPLACE INTO habit_entry_change_receipts (task_uuid, date, modified_at, deleted_at) VALUES (?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    const char *sql = "INSERT OR REPLACE INTO habit_entry_change_receipts (task_uuid, date, modified_at, deleted_at, seq) VALUES (?, ?, ?, ?, ?);";
+    sqlite3_int64 seq = next_receipt_seq();
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
     sqlite3_bind_text(stmt, 2, date_iso8601, -1, SQLITE_STATIC);
     sqlite3_bind_int64(stmt, 3, get_current_epoch());
     sqlite3_bind_int64(stmt, 4, get_current_epoch());
 
+    sqlite3_bind_int64(stmt, 5, seq);
+
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc != SQLITE_DONE)
     {
-        LOGE(TAG, "Failed to delete habit entry receipt for task UUID <%s> on date %s: %s", task_uuid, date_iso8601, sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to delete habit entry receipt for task UUID <%s> on date %s: %s", task_uuid.text().c_str(), date_iso8601, sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 }
 
-void Database::record_entry_link_receipt(const char *parent_uuid, const char *child_uuid, LinkType link_type)
+void Database::record_entry_link_receipt(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type)
 {
     const char *TAG = "DB::record_entry_link_receipt";
     const char *sql =
         "INSERT OR REPLACE INTO entry_link_change_receipts "
-        "(parent_uuid, child_uuid, link_type, modified_at, deleted_at) VALUES (?, ?, ?, ?, NULL);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+        "(parent_uuid, child_uuid, link_type, modified_at, deleted_at, seq) VALUES (?, ?, ?, ?, NULL, ?);";
+    sqlite3_int64 seq = next_receipt_seq();
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, parent_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, child_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, parent_uuid);
+    bind_uuid(stmt, 2, child_uuid);
     sqlite3_bind_int(stmt, 3, static_cast<int>(link_type));
     sqlite3_bind_int64(stmt, 4, get_current_epoch());
 
+    sqlite3_bind_int64(stmt, 5, seq);
+
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc != SQLITE_DONE)
     {
-        LOGE(TAG, "Failed to record entry link receipt from <%s> to <%s>: %s", parent_uuid, child_uuid, sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to record entry link receipt from <%s> to <%s>: %s", parent_uuid.text().c_str(), child_uuid.text().c_str(), sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 }
 
-void Database::delete_entry_link_receipt(const char *parent_uuid, const char *child_uuid, LinkType link_type)
+void Database::delete_entry_link_receipt(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type)
 {
     // simply reuse record routine with deleted flag
     const char *TAG = "DB::delete_entry_link_receipt";
     const char *sql =
         "INSERT OR REPLACE INTO entry_link_change_receipts "
-        "(parent_uuid, child_uuid, link_type, modified_at, deleted_at) VALUES (?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+        "(parent_uuid, child_uuid, link_type, modified_at, deleted_at, seq) VALUES (?, ?, ?, ?, ?, ?);";
+    sqlite3_int64 seq = next_receipt_seq();
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, parent_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, child_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, parent_uuid);
+    bind_uuid(stmt, 2, child_uuid);
     sqlite3_bind_int(stmt, 3, static_cast<int>(link_type));
     sqlite3_bind_int64(stmt, 4, get_current_epoch());
     sqlite3_bind_int64(stmt, 5, get_current_epoch());
 
+    sqlite3_bind_int64(stmt, 6, seq);
+
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc != SQLITE_DONE)
     {
-        LOGE(TAG, "Failed to delete entry link receipt from <%s> to <%s>: %s", parent_uuid, child_uuid, sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to delete entry link receipt from <%s> to <%s>: %s", parent_uuid.text().c_str(), child_uuid.text().c_str(), sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 }
 
-Database::Database()
+Database::Database(const char *path, const StorageProfile &profile)
 {
     const char *TAG = "DB::init_db";
 
-    int rc = sqlite3_open(DATABASE_PATH, &db);
+    int rc = sqlite3_open(path, &db);
     if (rc != SQLITE_OK)
     {
         LOGE(TAG, "Failed to open database: %s", sqlite3_errmsg(db));
         throw rc;
     }
 
+    apply_storage_profile(profile);
+
     // migration: drop old receipt tables when upgrading from version <3
     int old_version = 0;
     {
@@ -373,107 +1316,62 @@ Database::Database()
         // Increment this if we make breaking changes to the schema
         "PRAGMA schema_version = 3;", // Version 3: Denormalized sync receipts
         // Tables
-        "CREATE TABLE IF NOT EXISTS timeblocks ( \
-            uuid TEXT PRIMARY KEY, \
-            status INTEGER NOT NULL, \
-            name TEXT NOT NULL, \
-            description TEXT, \
-            day_frequency INTEGER NOT NULL, \
-            duration INTEGER NOT NULL, \
-            start INTEGER, \
-            day_start INTEGER, \
-            completed_datetime INTEGER \
-        ); \
-        CREATE TABLE IF NOT EXISTS tasks( \
-            uuid TEXT PRIMARY KEY, \
-            timeblock_uuid TEXT NOT NULL,  \
-            name TEXT NOT NULL, \
-            description TEXT, \
-            due_date INTEGER, \
-            priority INTEGER NOT NULL, \
-            scope INTEGER NOT NULL, \
-            status INTEGER NOT NULL, \
-            goal_spec INTEGER NOT NULL, \
-            completed_datetime INTEGER, \
-            FOREIGN KEY(timeblock_uuid) REFERENCES timeblocks(uuid) ON DELETE CASCADE); \
-        CREATE TABLE IF NOT EXISTS habit_entries( \
-            task_uuid TEXT NOT NULL, \
-            date TEXT NOT NULL, \
-            PRIMARY KEY(task_uuid, date), \
-            FOREIGN KEY(task_uuid) REFERENCES tasks(uuid) ON DELETE CASCADE); \
-        CREATE TABLE IF NOT EXISTS entry_links( \
-            parent_uuid TEXT NOT NULL, \
-            child_uuid TEXT NOT NULL, \
-            link_type INTEGER NOT NULL, \
-            PRIMARY KEY(parent_uuid, child_uuid), \
-            FOREIGN KEY(parent_uuid) REFERENCES tasks(uuid) ON DELETE CASCADE, \
-            FOREIGN KEY(child_uuid) REFERENCES tasks(uuid) ON DELETE CASCADE);",
+        SCHEMA_TABLES,
+        // Indexes
+        "CREATE INDEX IF NOT EXISTS habit_entries_date ON habit_entries(date);", // Bulk habit preview window
         // Receipts tables for syncing with external clients (denormalized snapshots)
-        "CREATE TABLE IF NOT EXISTS timeblock_change_receipts ( \
-            uuid TEXT PRIMARY KEY, \
-            status INTEGER NOT NULL, \
-            name TEXT NOT NULL, \
-            description TEXT, \
-            day_frequency INTEGER NOT NULL, \
-            duration INTEGER NOT NULL, \
-            start INTEGER, \
-            day_start INTEGER, \
-            completed_datetime INTEGER, \
-            modified_at INTEGER NOT NULL, \
-            deleted_at INTEGER \
-        ); \
-        CREATE TABLE IF NOT EXISTS task_change_receipts ( \
-            uuid TEXT PRIMARY KEY, \
-            timeblock_uuid TEXT NOT NULL,  \
-            name TEXT NOT NULL, \
-            description TEXT, \
-            due_date INTEGER, \
-            priority INTEGER NOT NULL, \
-            scope INTEGER NOT NULL, \
-            status INTEGER NOT NULL, \
-            goal_spec INTEGER NOT NULL, \
-            completed_datetime INTEGER, \
-            modified_at INTEGER NOT NULL, \
-            deleted_at INTEGER \
-        ); \
-        CREATE TABLE IF NOT EXISTS habit_entry_change_receipts ( \
-            task_uuid TEXT NOT NULL, \
-            date TEXT NOT NULL, \
-            modified_at INTEGER NOT NULL, \
-            deleted_at INTEGER, \
-            PRIMARY KEY(task_uuid, date) \
-        ); \
-        CREATE TABLE IF NOT EXISTS entry_link_change_receipts ( \
-            parent_uuid TEXT NOT NULL, \
-            child_uuid TEXT NOT NULL, \
-            link_type INTEGER NOT NULL, \
-            modified_at INTEGER NOT NULL, \
-            deleted_at INTEGER, \
-            PRIMARY KEY(parent_uuid, child_uuid) \
-        ); \
-        CREATE TABLE IF NOT EXISTS client_sync_state ( \
-            id INTEGER PRIMARY KEY CHECK (id = 1), \
-            last_server_version INTEGER NOT NULL DEFAULT 0 \
-        );"};
+        SCHEMA_SYNC_TABLES};
+
+    for (int i = 0; i < sizeof(sql) / sizeof(sql[0]); i++)
+    {
+        char *errmsg = NULL;
+        rc = sqlite3_exec(db, sql[i], 0, 0, &errmsg);
+        if (rc != SQLITE_OK)
+        {
+            LOGE(TAG, "SQL error: %s", errmsg);
+            sqlite3_free(errmsg);
+            sqlite3_close(db);
+            throw rc;
+        }
+    }
+
+    // Insert default client sync state if not exists
+    rc = sqlite3_exec(db, "INSERT OR IGNORE INTO client_sync_state (id, last_server_version) VALUES (1, 0);", 0, 0, 0);
+    if (rc != SQLITE_OK)
+    {
+        LOGE(TAG, "Failed to initialize client sync state: %s", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        throw rc;
+    }
+
+    rc = migrate_receipt_seq(db);
+    if (rc != SQLITE_OK)
+    {
+        LOGE(TAG, "Failed to add receipt sequence numbers: %s", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        throw rc;
+    }
+
+    rc = migrate_field_clocks(db);
+    if (rc != SQLITE_OK)
+    {
+        LOGE(TAG, "Failed to add field clocks: %s", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        throw rc;
+    }
 
-    for (int i = 0; i < sizeof(sql) / sizeof(sql[0]); i++)
+    rc = migrate_resume_state(db);
+    if (rc != SQLITE_OK)
     {
-        char *errmsg = NULL;
-        rc = sqlite3_exec(db, sql[i], 0, 0, &errmsg);
-        if (rc != SQLITE_OK)
-        {
-            LOGE(TAG, "SQL error: %s", errmsg);
-            sqlite3_free(errmsg);
-            sqlite3_close(db);
-            throw rc;
-        }
+        LOGE(TAG, "Failed to add sync resume state: %s", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        throw rc;
     }
 
-    // Insert default client sync state if not exists
-    rc = sqlite3_exec(db, "INSERT OR IGNORE INTO client_sync_state (id, last_server_version) VALUES (1, 0);", 0, 0, 0);
+    rc = migrate_binary_uuids(db);
     if (rc != SQLITE_OK)
     {
-        LOGE(TAG, "Failed to initialize client sync state: %s", sqlite3_errmsg(db));
+        LOGE(TAG, "Failed to convert UUID keys: %s", sqlite3_errmsg(db));
         sqlite3_close(db);
         throw rc;
     }
@@ -483,6 +1381,13 @@ Database::Database()
 
 Database::~Database()
 {
+    // Cached statements must be finalized before the connection can close
+    for (auto &[sql, stmt] : m_stmt_cache)
+    {
+        sqlite3_finalize(stmt);
+    }
+    m_stmt_cache.clear();
+
     if (db)
     {
         sqlite3_close(db);
@@ -498,6 +1403,8 @@ void Database::insert_timeblock(const Timeblock &tb)
 {
     const char *TAG = "DB::insert_timeblock";
 
+    Batch batch(*this);
+
     /**
      * Timeblock fields:
      * uuid
@@ -511,15 +1418,14 @@ void Database::insert_timeblock(const Timeblock &tb)
      * completed_datetime
      */
     const char *sql = "INSERT INTO timeblocks VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, tb.uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, tb.uuid);
     sqlite3_bind_int(stmt, 2, static_cast<int>(tb.status));
     sqlite3_bind_text(stmt, 3, tb.name, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, tb.desc, -1, SQLITE_STATIC);
@@ -530,13 +1436,14 @@ void Database::insert_timeblock(const Timeblock &tb)
     sqlite3_bind_int64(stmt, 9, tb.completed_datetime);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc == SQLITE_DONE)
     {
         LOGI(TAG, "Saved timeblock <%s> to database", tb.name);
         // Record receipt for this change
         record_timeblock_receipt(tb, false);
+        batch.commit();
         return;
     }
 
@@ -549,9 +1456,8 @@ void Database::load_timeblocks(std::vector<Timeblock> &timeblocks)
     const char *TAG = "DB::load_timeblocks";
 
     const char *sql = "SELECT * FROM timeblocks;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
@@ -564,10 +1470,10 @@ void Database::load_timeblocks(std::vector<Timeblock> &timeblocks)
         // problems if Timeblock manages dynamic memory).
         timeblocks.emplace_back();
         Timeblock &tb = timeblocks.back();
-        strncpy(tb.uuid.value, (const char *)sqlite3_column_text(stmt, 0), UUID_LEN);
+        tb.uuid = column_uuid(stmt, 0);
         tb.status = static_cast<TimeblockStatus>(sqlite3_column_int(stmt, 1));
-        tb.name = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-        tb.desc = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
+        tb.name = column_string(stmt, 2);
+        tb.desc = column_string(stmt, 3);
         tb.day_frequency = GoalSpec::from_sql(sqlite3_column_int(stmt, 4));
         tb.duration = sqlite3_column_int64(stmt, 5);
         tb.start = sqlite3_column_int64(stmt, 6);
@@ -575,7 +1481,7 @@ void Database::load_timeblocks(std::vector<Timeblock> &timeblocks)
         tb.completed_datetime = sqlite3_column_int64(stmt, 8);
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     LOGI(TAG, "Loaded %zu timeblocks from database", timeblocks.size());
 }
 
@@ -583,6 +1489,17 @@ void Database::update_timeblock(const Timeblock &tb)
 {
     const char *TAG = "DB::update_timeblock";
 
+    Batch batch(*this);
+
+    // Only the columns that differ get a receipt bit and a new clock
+    uint32_t changed = changed_timeblock_fields(tb);
+    if (!changed)
+    {
+        LOGI(TAG, "Timeblock <%s> unchanged", tb.name);
+        batch.commit();
+        return;
+    }
+
     /**
      * Timeblock fields:
      * uuid
@@ -596,9 +1513,8 @@ void Database::update_timeblock(const Timeblock &tb)
      * completed_datetime
      */
     const char *sql = "UPDATE timeblocks SET status = ?, name = ?, description = ?, day_frequency = ?, duration = ?, start = ?, day_start = ?, completed_datetime = ? WHERE uuid = ?;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
@@ -612,16 +1528,17 @@ void Database::update_timeblock(const Timeblock &tb)
     sqlite3_bind_int64(stmt, 6, tb.start);
     sqlite3_bind_int64(stmt, 7, tb.day_start);
     sqlite3_bind_int64(stmt, 8, tb.completed_datetime);
-    sqlite3_bind_text(stmt, 9, tb.uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 9, tb.uuid);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc == SQLITE_DONE)
     {
         LOGI(TAG, "Updated timeblock <%s> in database", tb.name);
         // Record receipt for this change
-        record_timeblock_receipt(tb, false);
+        record_timeblock_receipt(tb, false, changed);
+        batch.commit();
         return;
     }
 
@@ -629,10 +1546,9 @@ void Database::update_timeblock(const Timeblock &tb)
     throw sqlite3_errcode(db);
 }
 
-void Database::upsert_timeblock(const Timeblock &tb)
+// Shared by upsert_timeblock and apply_server_timeblock; returns the step result
+int Database::step_upsert_timeblock(const Timeblock &tb)
 {
-    const char *TAG = "DB::upsert_timeblock";
-
     // INSERT with ON CONFLICT clause to perform an upsert based on the UUID primary key.
     // Removes need for a separate existence check before deciding to insert or update.
     const char *sql =
@@ -648,15 +1564,11 @@ void Database::upsert_timeblock(const Timeblock &tb)
         "day_start = excluded.day_start, "
         "completed_datetime = excluded.completed_datetime;";
 
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
-    {
-        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
-        throw sqlite3_errcode(db);
-    }
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
+        return sqlite3_errcode(db);
 
-    sqlite3_bind_text(stmt, 1, tb.uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, tb.uuid);
     sqlite3_bind_int(stmt, 2, static_cast<int>(tb.status));
     sqlite3_bind_text(stmt, 3, tb.name, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, tb.desc, -1, SQLITE_STATIC);
@@ -667,12 +1579,28 @@ void Database::upsert_timeblock(const Timeblock &tb)
     sqlite3_bind_int64(stmt, 9, tb.completed_datetime);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
+    return rc;
+}
 
-    if (rc == SQLITE_DONE)
+void Database::upsert_timeblock(const Timeblock &tb)
+{
+    const char *TAG = "DB::upsert_timeblock";
+
+    Batch batch(*this);
+
+    uint32_t changed = changed_timeblock_fields(tb);
+    if (!changed)
+    {
+        batch.commit();
+        return;
+    }
+
+    if (step_upsert_timeblock(tb) == SQLITE_DONE)
     {
         LOGI(TAG, "Upserted timeblock <%s>", tb.name);
-        record_timeblock_receipt(tb, false);
+        record_timeblock_receipt(tb, false, changed);
+        batch.commit();
         return;
     }
 
@@ -680,25 +1608,26 @@ void Database::upsert_timeblock(const Timeblock &tb)
     throw sqlite3_errcode(db);
 }
 
-void Database::delete_timeblock(const char *uuid, bool ignore_failure)
+void Database::delete_timeblock(const UUID &uuid, bool ignore_failure)
 {
     const char *TAG = "DB::delete_timeblock";
 
+    Batch batch(*this);
+
     const char *sql =
         "DELETE FROM timeblocks "
         "WHERE uuid = ? "
         "RETURNING uuid, status, name, description, day_frequency, "
         "duration, start, day_start, completed_datetime;";
 
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, uuid);
 
     int rc = sqlite3_step(stmt);
 
@@ -706,46 +1635,45 @@ void Database::delete_timeblock(const char *uuid, bool ignore_failure)
     {
         Timeblock tb;
 
-        strncpy(tb.uuid.value,
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)),
-                UUID_LEN);
+        tb.uuid = column_uuid(stmt, 0);
 
         tb.status = static_cast<TimeblockStatus>(sqlite3_column_int(stmt, 1));
-        tb.name = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-        tb.desc = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
+        tb.name = column_string(stmt, 2);
+        tb.desc = column_string(stmt, 3);
         tb.day_frequency = GoalSpec::from_sql(sqlite3_column_int(stmt, 4));
         tb.duration = sqlite3_column_int64(stmt, 5);
         tb.start = sqlite3_column_int64(stmt, 6);
         tb.day_start = sqlite3_column_int64(stmt, 7);
         tb.completed_datetime = sqlite3_column_int64(stmt, 8);
 
-        sqlite3_finalize(stmt);
+        sqlite3_reset(stmt);
 
-        LOGI(TAG, "Deleted timeblock with UUID: %s", uuid);
+        LOGI(TAG, "Deleted timeblock with UUID: %s", uuid.text().c_str());
 
         delete_timeblock_receipt(tb);
+        forget_field_clocks(uuid);
 
-        free(tb.name);
-        free(tb.desc);
 
+        batch.commit();
         return;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc == SQLITE_DONE)
     {
         if (ignore_failure)
         {
-            LOGI(TAG, "Delete ignored (timeblock not found): %s", uuid);
+            LOGI(TAG, "Delete ignored (timeblock not found): %s", uuid.text().c_str());
+            batch.commit();
             return;
         }
 
-        LOGE(TAG, "No timeblock found with UUID: %s", uuid);
+        LOGE(TAG, "No timeblock found with UUID: %s", uuid.text().c_str());
         throw SQLITE_NOTFOUND;
     }
 
-    LOGE(TAG, "Failed to delete timeblock %s: %s", uuid, sqlite3_errmsg(db));
+    LOGE(TAG, "Failed to delete timeblock %s: %s", uuid.text().c_str(), sqlite3_errmsg(db));
     throw sqlite3_errcode(db);
 }
 
@@ -757,6 +1685,8 @@ void Database::insert_task(const Task &task)
 {
     const char *TAG = "DB::insert_task";
 
+    Batch batch(*this);
+
     /**
      * Task fields:
      * uuid
@@ -771,16 +1701,15 @@ void Database::insert_task(const Task &task)
      * completed_datetime
      */
     const char *sql = "INSERT INTO tasks VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task.uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.timeblock_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task.uuid);
+    bind_uuid(stmt, 2, task.timeblock_uuid);
     sqlite3_bind_text(stmt, 3, task.name, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, task.desc, -1, SQLITE_STATIC);
     sqlite3_bind_int64(stmt, 5, task.due_date);
@@ -792,12 +1721,13 @@ void Database::insert_task(const Task &task)
 
     // Execute
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc == SQLITE_DONE)
     {
         LOGI(TAG, "Saved task <%s> to database", task.name);
         // Record receipt for this change
         record_task_receipt(task, false);
+        batch.commit();
         return;
     }
 
@@ -818,9 +1748,8 @@ void Database::load_tasks(TaskHash &tasks)
     }
 
     const char *sql = "SELECT * FROM tasks;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGI(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
@@ -832,10 +1761,10 @@ void Database::load_tasks(TaskHash &tasks)
         // a stack-allocated Task into the map (which could cause shallow-copying of
         // dynamically allocated members and lead to dangling pointers / double frees).
         std::unique_ptr<Task> tptr = std::make_unique<Task>();
-        strncpy(tptr->uuid.value, (const char *)sqlite3_column_text(stmt, 0), UUID_LEN);
-        strncpy(tptr->timeblock_uuid.value, (const char *)sqlite3_column_text(stmt, 1), UUID_LEN);
-        tptr->name = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-        tptr->desc = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
+        tptr->uuid = column_uuid(stmt, 0);
+        tptr->timeblock_uuid = column_uuid(stmt, 1);
+        tptr->name = column_string(stmt, 2);
+        tptr->desc = column_string(stmt, 3);
         tptr->due_date = sqlite3_column_int64(stmt, 4);
         tptr->priority = static_cast<Priority>(sqlite3_column_int(stmt, 5));
         tptr->scope = static_cast<Scope>(sqlite3_column_int(stmt, 6));
@@ -846,7 +1775,7 @@ void Database::load_tasks(TaskHash &tasks)
         tasks[tptr->uuid] = std::move(tptr);
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     LOGI(TAG, "Loaded %zu tasks", tasks.size());
     return;
@@ -856,57 +1785,68 @@ void Database::update_task(const Task &task)
 {
     const char *TAG = "DB::update_task";
 
-    /**
-     * Task fields:
-     * uuid
-     * timeblock_uuid
-     * name
-     * description
-     * due_date
-     * priority
-     * status
-     * goal_spec
-     * completed_datetime
-     */
-    const char *sql = "UPDATE tasks SET timeblock_uuid = ?, name = ?, description = ?, due_date = ?, priority = ?, scope = ?, status = ?, goal_spec = ?, completed_datetime = ? WHERE uuid = ?;";
-    sqlite3_stmt *stmt;
+    Batch batch(*this);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    // Only the columns that differ get a receipt bit and a new clock
+    uint32_t changed = changed_task_fields(task);
+    if (!changed)
     {
-        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
-        throw sqlite3_errcode(db);
+        LOGI(TAG, "Task <%s> unchanged", task.name);
+        batch.commit();
+        return;
     }
 
-    sqlite3_bind_text(stmt, 1, task.timeblock_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.name, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, task.desc, -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 4, task.due_date);
-    sqlite3_bind_int(stmt, 5, static_cast<int>(task.priority));
-    sqlite3_bind_int(stmt, 6, static_cast<int>(task.scope));
-    sqlite3_bind_int(stmt, 7, static_cast<int>(task.status));
-    sqlite3_bind_int(stmt, 8, task.goal_spec.to_sql());
-    sqlite3_bind_int64(stmt, 9, task.completed_datetime);
-    sqlite3_bind_text(stmt, 10, task.uuid, -1, SQLITE_STATIC);
+    // Only those columns are written too
+    FieldValue values[TASK_SYNC_FIELD_COUNT];
+    for (int f = 0; f < TASK_SYNC_FIELD_COUNT; f++)
+        values[f] = task_field(task, f);
+    update_fields("tasks", TASK_SYNC_FIELDS, TASK_SYNC_FIELD_COUNT, task.uuid, changed, values);
+    LOGI(TAG, "Updated task <%s> in database", task.name);
 
-    // Execute
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    if (rc == SQLITE_DONE)
+    // Record receipt for this change
+    record_task_receipt(task, false, changed);
+    batch.commit();
+}
+
+void Database::patch_task(const UUID &uuid, const TaskPatch &patch)
+{
+    const char *TAG = "DB::patch_task";
+
+    Batch batch(*this);
+
+    Task stored;
+    if (!read_task_row(uuid, stored))
     {
-        LOGI(TAG, "Updated task <%s> in database", task.name);
-        // Record receipt for this change
-        record_task_receipt(task, false);
+        LOGE(TAG, "Task <%s> not found", uuid.text().c_str());
+        throw SQLITE_NOTFOUND;
+    }
+    Task task = stored;
+    patch.apply(task);
+
+    // Of the patched columns, only those that differ are written and get a new clock
+    FieldValue values[TASK_SYNC_FIELD_COUNT];
+    uint32_t changed = 0;
+    for (int f = 0; f < TASK_SYNC_FIELD_COUNT; f++)
+    {
+        values[f] = task_field(task, f);
+        if ((patch.fields & (1u << f)) && compare_field(values[f], task_field(stored, f)) != 0)
+            changed |= 1u << f;
+    }
+    if (!changed)
+    {
+        LOGI(TAG, "Task <%s> unchanged", task.name);
+        batch.commit();
         return;
     }
 
-    LOGE(TAG, "Failed to update task <%s>: %s", task.name, sqlite3_errmsg(db));
-    throw sqlite3_errcode(db);
+    update_fields("tasks", TASK_SYNC_FIELDS, TASK_SYNC_FIELD_COUNT, uuid, changed, values);
+    record_task_receipt(task, false, changed);
+    batch.commit();
 }
 
-void Database::upsert_task(const Task &task)
+// Shared by upsert_task and apply_server_task; returns the step result
+int Database::step_upsert_task(const Task &task)
 {
-    const char *TAG = "DB::upsert_task";
-
     // INSERT with ON CONFLICT clause to perform an upsert based on the UUID primary key.
     // Removes need for a separate existence check before deciding to insert or update.
     const char *sql =
@@ -923,16 +1863,12 @@ void Database::upsert_task(const Task &task)
         "goal_spec = excluded.goal_spec, "
         "completed_datetime = excluded.completed_datetime;";
 
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
-    {
-        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
-        throw sqlite3_errcode(db);
-    }
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
+        return sqlite3_errcode(db);
 
-    sqlite3_bind_text(stmt, 1, task.uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.timeblock_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task.uuid);
+    bind_uuid(stmt, 2, task.timeblock_uuid);
     sqlite3_bind_text(stmt, 3, task.name, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, task.desc, -1, SQLITE_STATIC);
     sqlite3_bind_int64(stmt, 5, task.due_date);
@@ -943,12 +1879,28 @@ void Database::upsert_task(const Task &task)
     sqlite3_bind_int64(stmt, 10, task.completed_datetime);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
+    return rc;
+}
 
-    if (rc == SQLITE_DONE)
+void Database::upsert_task(const Task &task)
+{
+    const char *TAG = "DB::upsert_task";
+
+    Batch batch(*this);
+
+    uint32_t changed = changed_task_fields(task);
+    if (!changed)
+    {
+        batch.commit();
+        return;
+    }
+
+    if (step_upsert_task(task) == SQLITE_DONE)
     {
         LOGI(TAG, "Upserted task <%s>", task.name);
-        record_task_receipt(task, false);
+        record_task_receipt(task, false, changed);
+        batch.commit();
         return;
     }
 
@@ -956,39 +1908,36 @@ void Database::upsert_task(const Task &task)
     throw sqlite3_errcode(db);
 }
 
-void Database::delete_task(const char *uuid, bool ignore_failure)
+void Database::delete_task(const UUID &uuid, bool ignore_failure)
 {
     const char *TAG = "DB::delete_task";
 
+    Batch batch(*this);
+
     const char *sql = "DELETE FROM tasks "
                       "WHERE uuid = ?"
                       "RETURNING uuid, timeblock_uuid, name, description, "
                       "due_date, priority, scope, status, goal_spec, completed_datetime;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, uuid);
     int rc = sqlite3_step(stmt);
 
     if (rc == SQLITE_ROW)
     {
         Task task;
 
-        strncpy(task.uuid.value,
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)),
-                UUID_LEN);
+        task.uuid = column_uuid(stmt, 0);
 
-        strncpy(task.timeblock_uuid.value,
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)),
-                UUID_LEN);
+        task.timeblock_uuid = column_uuid(stmt, 1);
 
-        task.name = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-        task.desc = strdup(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
+        task.name = column_string(stmt, 2);
+        task.desc = column_string(stmt, 3);
         task.due_date = sqlite3_column_int64(stmt, 4);
         task.priority = static_cast<Priority>(sqlite3_column_int(stmt, 5));
         task.scope = static_cast<Scope>(sqlite3_column_int(stmt, 6));
@@ -996,30 +1945,33 @@ void Database::delete_task(const char *uuid, bool ignore_failure)
         task.goal_spec = GoalSpec::from_sql(sqlite3_column_int(stmt, 8));
         task.completed_datetime = sqlite3_column_int64(stmt, 9);
 
-        sqlite3_finalize(stmt);
+        sqlite3_reset(stmt);
 
-        LOGI(TAG, "Deleted task with UUID: %s", uuid);
+        LOGI(TAG, "Deleted task with UUID: %s", uuid.text().c_str());
 
         delete_task_receipt(task);
+        forget_field_clocks(uuid);
 
+        batch.commit();
         return;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc == SQLITE_DONE)
     {
         if (ignore_failure)
         {
-            LOGI(TAG, "Delete ignored (task not found): %s", uuid);
+            LOGI(TAG, "Delete ignored (task not found): %s", uuid.text().c_str());
+            batch.commit();
             return;
         }
 
-        LOGE(TAG, "No task found with UUID: %s", uuid);
+        LOGE(TAG, "No task found with UUID: %s", uuid.text().c_str());
         throw SQLITE_NOTFOUND;
     }
 
-    LOGE(TAG, "Failed to delete task with UUID: %s", uuid);
+    LOGE(TAG, "Failed to delete task with UUID: %s", uuid.text().c_str());
     throw sqlite3_errcode(db);
 }
 
@@ -1027,92 +1979,96 @@ void Database::delete_task(const char *uuid, bool ignore_failure)
 /*                              Habit entry data                              */
 /* -------------------------------------------------------------------------- */
 
-void Database::add_habit_entry(const char *task_uuid, const char *date_iso8601)
+void Database::add_habit_entry(const UUID &task_uuid, const char *date_iso8601)
 {
     const char *TAG = "DB::add_habit_entry";
 
-    const char *sql = "INSERT OR IGNORE INTO habit_entries (task_uuid, date) VALUES (?, ?);";
-    sqlite3_stmt *stmt;
+    Batch batch(*this);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    const char *sql = "INSERT OR IGNORE INTO habit_entries (task_uuid, date) VALUES (?, ?);";
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
     sqlite3_bind_text(stmt, 2, date_iso8601, -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc == SQLITE_DONE)
     {
-        LOGI(TAG, "Added habit entry for task <%s> on date %s", task_uuid, date_iso8601);
+        LOGI(TAG, "Added habit entry for task <%s> on date %s", task_uuid.text().c_str(), date_iso8601);
         // Record receipt for this change
         record_habit_entry_receipt(task_uuid, date_iso8601);
+        batch.commit();
         return;
     }
-    LOGE(TAG, "Failed to add habit entry for task <%s> on date %s: %s", task_uuid, date_iso8601, sqlite3_errmsg(db));
+    LOGE(TAG, "Failed to add habit entry for task <%s> on date %s: %s", task_uuid.text().c_str(), date_iso8601, sqlite3_errmsg(db));
     throw sqlite3_errcode(db);
 }
 
-void Database::remove_habit_entry(const char *task_uuid, const char *date_iso8601)
+void Database::remove_habit_entry(const UUID &task_uuid, const char *date_iso8601)
 {
     const char *TAG = "DB::remove_habit_entry";
 
+    Batch batch(*this);
+
     // Check if the habit entry exists before trying to delete it, so we can return early without error if it doesn't exist
     if (!habit_entry_exists(task_uuid, date_iso8601))
     {
-        LOGW(TAG, "Habit entry for task <%s> on date %s does not exist, nothing to remove", task_uuid, date_iso8601);
+        LOGW(TAG, "Habit entry for task <%s> on date %s does not exist, nothing to remove", task_uuid.text().c_str(), date_iso8601);
+        batch.commit();
         return;
     }
 
     // We don't need to check if the deletion actually removed a row since either way the end result is that the habit entry doesn't exist, which is what we want.
     // We just need to make sure to record a deletion receipt if it did exist so that external clients can sync this change.
     const char *sql = "DELETE FROM habit_entries WHERE task_uuid = ? AND date = ?;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
     sqlite3_bind_text(stmt, 2, date_iso8601, -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc == SQLITE_DONE)
     {
-        LOGI(TAG, "Removed habit entry for task <%s> on date %s", task_uuid, date_iso8601);
+        LOGI(TAG, "Removed habit entry for task <%s> on date %s", task_uuid.text().c_str(), date_iso8601);
         // Record deletion receipt for this change
         delete_habit_entry_receipt(task_uuid, date_iso8601);
+        batch.commit();
         return;
     }
 
-    LOGE(TAG, "Failed to remove habit entry for task <%s> on date %s: %s", task_uuid, date_iso8601, sqlite3_errmsg(db));
+    LOGE(TAG, "Failed to remove habit entry for task <%s> on date %s: %s", task_uuid.text().c_str(), date_iso8601, sqlite3_errmsg(db));
     throw sqlite3_errcode(db);
 }
 
-bool Database::habit_entry_exists(const char *task_uuid, const char *date_iso8601)
+bool Database::habit_entry_exists(const UUID &task_uuid, const char *date_iso8601)
 {
     const char *sql = "SELECT 1 FROM habit_entries WHERE task_uuid = ? AND date = ?;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
         return sqlite3_errcode(db);
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
     sqlite3_bind_text(stmt, 2, date_iso8601, -1, SQLITE_STATIC);
 
     if (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        sqlite3_finalize(stmt);
+        sqlite3_reset(stmt);
         return true;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     return false;
 }
 
@@ -1136,8 +2092,8 @@ void Database::load_habit_completion_preview(Task &task, const char *current_dat
       ON he.task_uuid = ? AND he.date = d
     ORDER BY n;)";
 
-    sqlite3_stmt *stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
@@ -1146,7 +2102,7 @@ void Database::load_habit_completion_preview(Task &task, const char *current_dat
     // Bind params
     sqlite3_bind_text(stmt, 1, current_date_iso8601, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 2, static_cast<int>(len));
-    sqlite3_bind_text(stmt, 3, task.uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 3, task.uuid);
 
     size_t index = 0;
     while (sqlite3_step(stmt) == SQLITE_ROW && index < len)
@@ -1185,25 +2141,52 @@ void Database::load_habit_completion_preview(Task &task, const char *current_dat
         ++index;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     // LOGI(TAG, "Loaded %zu habit completions for task <%s>", index, task.name);
 }
 
-void Database::get_habit_entries(const char *task_uuid, std::vector<time_t> &outDates)
+void Database::load_habit_entries_in_window(const char *current_date_iso8601, int days, std::vector<std::pair<UUID, int>> &outEntries)
+{
+    const char *TAG = "DB::load_habit_entries_in_window";
+
+    // Day offset 0 is current_date_iso8601, matching the completed_days layout
+    const char *sql =
+        "SELECT task_uuid, CAST(julianday(?1) - julianday(date) AS INTEGER) FROM habit_entries "
+        "WHERE date <= date(?1) AND date > date(?1, printf('-%d days', ?2));";
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+
+    sqlite3_bind_text(stmt, 1, current_date_iso8601, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, days);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        outEntries.emplace_back(column_uuid(stmt, 0), sqlite3_column_int(stmt, 1));
+    }
+
+    sqlite3_reset(stmt);
+
+    LOGI(TAG, "Loaded %zu habit entries in the last %d days", outEntries.size(), days);
+}
+
+void Database::get_habit_entries(const UUID &task_uuid, std::vector<time_t> &outDates)
 {
     const char *TAG = "DB::get_habit_entries";
 
     const char *sql = "SELECT date FROM habit_entries WHERE task_uuid = ? ORDER BY date ASC;";
-    sqlite3_stmt *stmt = nullptr;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
 
     while (sqlite3_step(stmt) == SQLITE_ROW)
     {
@@ -1223,101 +2206,104 @@ void Database::get_habit_entries(const char *task_uuid, std::vector<time_t> &out
         }
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 }
 
 /* -------------------------------------------------------------------------- */
 /*                               Entry link data                              */
 /* -------------------------------------------------------------------------- */
 
-void Database::add_entry_link(const char *parent_uuid, const char *child_uuid, LinkType link_type)
+void Database::add_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type)
 {
     const char *TAG = "DB::add_entry_link";
 
-    const char *sql = "INSERT OR IGNORE INTO entry_links (parent_uuid, child_uuid, link_type) VALUES (?, ?, ?);";
-    sqlite3_stmt *stmt;
+    Batch batch(*this);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    const char *sql = "INSERT OR IGNORE INTO entry_links (parent_uuid, child_uuid, link_type) VALUES (?, ?, ?);";
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, parent_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, child_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, parent_uuid);
+    bind_uuid(stmt, 2, child_uuid);
     sqlite3_bind_int(stmt, 3, static_cast<int>(link_type));
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc == SQLITE_DONE)
     {
-        LOGI(TAG, "Added entry link from <%s> to <%s> with link type %d", parent_uuid, child_uuid, static_cast<int>(link_type));
+        LOGI(TAG, "Added entry link from <%s> to <%s> with link type %d", parent_uuid.text().c_str(), child_uuid.text().c_str(), static_cast<int>(link_type));
         record_entry_link_receipt(parent_uuid, child_uuid, link_type);
+        batch.commit();
         return;
     }
-    LOGE(TAG, "Failed to add entry link from <%s> to <%s>: %s", parent_uuid, child_uuid, sqlite3_errmsg(db));
+    LOGE(TAG, "Failed to add entry link from <%s> to <%s>: %s", parent_uuid.text().c_str(), child_uuid.text().c_str(), sqlite3_errmsg(db));
     throw sqlite3_errcode(db);
 }
 
-void Database::remove_entry_link(const char *parent_uuid, const char *child_uuid, LinkType link_type)
+void Database::remove_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type)
 {
     const char *TAG = "DB::remove_entry_link";
 
-    const char *sql = "DELETE FROM entry_links WHERE parent_uuid = ? AND child_uuid = ? AND link_type = ?;";
-    sqlite3_stmt *stmt;
+    Batch batch(*this);
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    const char *sql = "DELETE FROM entry_links WHERE parent_uuid = ? AND child_uuid = ? AND link_type = ?;";
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, parent_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, child_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, parent_uuid);
+    bind_uuid(stmt, 2, child_uuid);
     sqlite3_bind_int(stmt, 3, static_cast<int>(link_type));
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (rc == SQLITE_DONE)
     {
-        LOGI(TAG, "Removed entry link from <%s> to <%s> with link type %d", parent_uuid, child_uuid, static_cast<int>(link_type));
+        LOGI(TAG, "Removed entry link from <%s> to <%s> with link type %d", parent_uuid.text().c_str(), child_uuid.text().c_str(), static_cast<int>(link_type));
         delete_entry_link_receipt(parent_uuid, child_uuid, link_type);
+        batch.commit();
         return;
     }
-    LOGE(TAG, "Failed to remove entry link from <%s> to <%s>: %s", parent_uuid, child_uuid, sqlite3_errmsg(db));
+    LOGE(TAG, "Failed to remove entry link from <%s> to <%s>: %s", parent_uuid.text().c_str(), child_uuid.text().c_str(), sqlite3_errmsg(db));
     throw sqlite3_errcode(db);
 }
 
-void Database::remove_all_links_for_task(const char *task_uuid)
+void Database::remove_all_links_for_task(const UUID &task_uuid)
 {
     const char *TAG = "DB::remove_all_links_for_task";
 
+    Batch batch(*this);
+
     // Delete all links where the task is either the parent or child, and return the deleted links so we can record receipts for them
     const char *sql =
         "DELETE FROM entry_links "
         "WHERE parent_uuid = ? OR child_uuid = ? "
         "RETURNING parent_uuid, child_uuid, link_type;";
 
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
+    bind_uuid(stmt, 2, task_uuid);
 
     int rc;
     int count = 0;
 
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
     {
-        const char *parent_uuid =
-            reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-        const char *child_uuid =
-            reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        UUID parent_uuid = column_uuid(stmt, 0);
+        UUID child_uuid = column_uuid(stmt, 1);
         LinkType link_type = static_cast<LinkType>(sqlite3_column_int(stmt, 2));
 
         delete_entry_link_receipt(parent_uuid, child_uuid, link_type);
@@ -1325,23 +2311,26 @@ void Database::remove_all_links_for_task(const char *task_uuid)
         count++;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc != SQLITE_DONE)
     {
         LOGE(TAG, "Failed to remove entry links for task <%s>: %s",
-             task_uuid, sqlite3_errmsg(db));
+             task_uuid.text().c_str(), sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    LOGI(TAG, "Removed %d entry links for task <%s>", count, task_uuid);
+    batch.commit();
+    LOGI(TAG, "Removed %d entry links for task <%s>", count, task_uuid.text().c_str());
 }
 
 // Remove all links where the task is the parent of a child
-void Database::remove_all_child_links_for_task(const char *task_uuid)
+void Database::remove_all_child_links_for_task(const UUID &task_uuid)
 {
     const char *TAG = "DB::remove_all_links_for_task";
 
+    Batch batch(*this);
+
     // Delete all links where the task is either the parent of a child child
     // return the deleted links so we can record receipts for them
     const char *sql =
@@ -1349,26 +2338,23 @@ void Database::remove_all_child_links_for_task(const char *task_uuid)
         "WHERE parent_uuid = ? "
         "RETURNING parent_uuid, child_uuid, link_type;";
 
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, task_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task_uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, task_uuid);
+    bind_uuid(stmt, 2, task_uuid);
 
     int rc;
     int count = 0;
 
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
     {
-        const char *parent_uuid =
-            reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-        const char *child_uuid =
-            reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        UUID parent_uuid = column_uuid(stmt, 0);
+        UUID child_uuid = column_uuid(stmt, 1);
         LinkType link_type = static_cast<LinkType>(sqlite3_column_int(stmt, 2));
 
         delete_entry_link_receipt(parent_uuid, child_uuid, link_type);
@@ -1376,43 +2362,232 @@ void Database::remove_all_child_links_for_task(const char *task_uuid)
         count++;
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
 
     if (rc != SQLITE_DONE)
     {
         LOGE(TAG, "Failed to remove entry links for task <%s>: %s",
-             task_uuid, sqlite3_errmsg(db));
+             task_uuid.text().c_str(), sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    LOGI(TAG, "Removed %d child links for task <%s>", count, task_uuid);
+    batch.commit();
+    LOGI(TAG, "Removed %d child links for task <%s>", count, task_uuid.text().c_str());
 }
 
-void Database::get_linked_entries(const char *uuid, LinkType link_type, std::vector<char *> &outLinkedUuids)
+void Database::get_linked_entries(const UUID &uuid, LinkType link_type, std::vector<UUID> &outLinkedUuids)
 {
     const char *TAG = "DB::get_linked_entries";
 
     const char *sql = "SELECT child_uuid FROM entry_links WHERE parent_uuid = ? AND link_type = ?;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
     {
         LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
         throw sqlite3_errcode(db);
     }
 
-    sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_STATIC);
+    bind_uuid(stmt, 1, uuid);
     sqlite3_bind_int(stmt, 2, static_cast<int>(link_type));
 
     while (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        const unsigned char *linked_uuid = sqlite3_column_text(stmt, 0);
-        if (linked_uuid)
+        UUID linked_uuid = column_uuid(stmt, 0);
+        if (!linked_uuid.empty())
         {
-            outLinkedUuids.push_back(strdup(reinterpret_cast<const char *>(linked_uuid)));
-            LOGI(TAG, "Found linked entry <%s> with link type %d", linked_uuid, static_cast<int>(link_type));
+            outLinkedUuids.push_back(linked_uuid);
+            LOGI(TAG, "Found linked entry <%s> with link type %d", linked_uuid.text().c_str(), static_cast<int>(link_type));
         }
     }
 
-    sqlite3_finalize(stmt);
-}
\ No newline at end of file
+    sqlite3_reset(stmt);
+}
+
+void Database::load_entry_links(LinkType link_type, std::vector<std::pair<UUID, UUID>> &outLinks)
+{
+    const char *TAG = "DB::load_entry_links";
+
+    const char *sql = "SELECT parent_uuid, child_uuid FROM entry_links WHERE link_type = ?;";
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+
+    sqlite3_bind_int(stmt, 1, static_cast<int>(link_type));
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        outLinks.emplace_back(column_uuid(stmt, 0), column_uuid(stmt, 1));
+    }
+
+    sqlite3_reset(stmt);
+
+    LOGI(TAG, "Loaded %zu links with link type %d", outLinks.size(), static_cast<int>(link_type));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Server changes                               */
+/* -------------------------------------------------------------------------- */
+
+// Rows from the sync server, applied by Synchronizer inside its own Batch. None of these record a
+// receipt, so what the server sent is not queued to be sent back to it.
+
+void Database::apply_server_timeblock(const Timeblock &tb)
+{
+    if (step_upsert_timeblock(tb) != SQLITE_DONE)
+    {
+        LOGE("DB::apply_server_timeblock", "Failed to apply timeblock <%s>: %s", tb.uuid.text().c_str(), sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
+void Database::apply_server_task(const Task &task)
+{
+    if (step_upsert_task(task) != SQLITE_DONE)
+    {
+        LOGE("DB::apply_server_task", "Failed to apply task <%s>: %s", task.uuid.text().c_str(), sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
+// Run one cached statement binding the given UUIDs, then an optional text value and integer
+void Database::step_server_change(const char *TAG, const char *sql, std::initializer_list<UUID> uuids, const char *text, int integer)
+{
+    sqlite3_stmt *stmt = prepare_cached(sql);
+    if (!stmt)
+    {
+        LOGE(TAG, "Failed to prepare statement: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+
+    int col = 1;
+    for (const UUID &uuid : uuids)
+        bind_uuid(stmt, col++, uuid);
+    if (text)
+        sqlite3_bind_text(stmt, col++, text, -1, SQLITE_STATIC);
+    if (integer >= 0)
+        sqlite3_bind_int(stmt, col, integer);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE(TAG, "Failed to apply server change: %s", sqlite3_errmsg(db));
+        throw sqlite3_errcode(db);
+    }
+}
+
+// Deletes cascade to the rows that reference the timeblock / task, as local ones do
+void Database::apply_server_timeblock_delete(const UUID &uuid)
+{
+    step_server_change("DB::apply_server_timeblock_delete", "DELETE FROM timeblocks WHERE uuid = ?;", {uuid});
+    forget_field_clocks(uuid);
+}
+
+void Database::apply_server_task_delete(const UUID &uuid)
+{
+    step_server_change("DB::apply_server_task_delete", "DELETE FROM tasks WHERE uuid = ?;", {uuid});
+    forget_field_clocks(uuid);
+}
+
+void Database::apply_server_habit_entry(const UUID &task_uuid, const char *date_iso8601, bool deleted)
+{
+    if (deleted)
+        step_server_change("DB::apply_server_habit_entry", "DELETE FROM habit_entries WHERE task_uuid = ? AND date = ?;", {task_uuid}, date_iso8601);
+    else
+        step_server_change("DB::apply_server_habit_entry", "INSERT OR IGNORE INTO habit_entries (task_uuid, date) VALUES (?, ?);", {task_uuid}, date_iso8601);
+}
+
+void Database::apply_server_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type, bool deleted)
+{
+    if (deleted)
+        step_server_change("DB::apply_server_entry_link", "DELETE FROM entry_links WHERE parent_uuid = ? AND child_uuid = ?;", {parent_uuid, child_uuid});
+    else
+        step_server_change("DB::apply_server_entry_link",
+                           "INSERT INTO entry_links (parent_uuid, child_uuid, link_type) VALUES (?, ?, ?) "
+                           "ON CONFLICT(parent_uuid, child_uuid) DO UPDATE SET link_type = excluded.link_type;",
+                           {parent_uuid, child_uuid}, nullptr, static_cast<int>(link_type));
+}
+
+uint32_t Database::merge_server_timeblock(Timeblock &tb, const Hlc *clocks)
+{
+    const uint32_t all = (1u << TIMEBLOCK_SYNC_FIELD_COUNT) - 1;
+    Hlc latest = 0;
+    for (int f = 0; f < TIMEBLOCK_SYNC_FIELD_COUNT; f++)
+        latest = clocks[f] > latest ? clocks[f] : latest;
+
+    Timeblock stored;
+    if (!read_timeblock_row(tb.uuid, stored))
+    {
+        // Not here yet: the whole row is the server's
+        apply_server_timeblock(tb);
+        write_field_clocks(tb.uuid, all, clocks, TIMEBLOCK_SYNC_FIELD_COUNT);
+        observe_hlc(latest);
+        return all;
+    }
+
+    Hlc local[TIMEBLOCK_SYNC_FIELD_COUNT];
+    FieldValue values[TIMEBLOCK_SYNC_FIELD_COUNT];
+    load_field_clocks(tb.uuid, local, TIMEBLOCK_SYNC_FIELD_COUNT);
+    uint32_t won = 0;
+    for (int f = 0; f < TIMEBLOCK_SYNC_FIELD_COUNT; f++)
+    {
+        values[f] = timeblock_field(tb, f);
+        if (server_field_wins(clocks[f], values[f], local[f], timeblock_field(stored, f)))
+            won |= 1u << f;
+    }
+
+    if (won)
+        write_merged_fields("timeblocks", "timeblock_change_receipts", TIMEBLOCK_SYNC_FIELDS, TIMEBLOCK_SYNC_FIELD_COUNT,
+                            tb.uuid, won, values, clocks);
+    observe_hlc(latest);
+
+    if (won != all)
+    {
+        UUID uuid = tb.uuid;
+        read_timeblock_row(uuid, tb);
+    }
+    return won;
+}
+
+uint32_t Database::merge_server_task(Task &task, const Hlc *clocks)
+{
+    const uint32_t all = (1u << TASK_SYNC_FIELD_COUNT) - 1;
+    Hlc latest = 0;
+    for (int f = 0; f < TASK_SYNC_FIELD_COUNT; f++)
+        latest = clocks[f] > latest ? clocks[f] : latest;
+
+    Task stored;
+    if (!read_task_row(task.uuid, stored))
+    {
+        apply_server_task(task);
+        write_field_clocks(task.uuid, all, clocks, TASK_SYNC_FIELD_COUNT);
+        observe_hlc(latest);
+        return all;
+    }
+
+    Hlc local[TASK_SYNC_FIELD_COUNT];
+    FieldValue values[TASK_SYNC_FIELD_COUNT];
+    load_field_clocks(task.uuid, local, TASK_SYNC_FIELD_COUNT);
+    uint32_t won = 0;
+    for (int f = 0; f < TASK_SYNC_FIELD_COUNT; f++)
+    {
+        values[f] = task_field(task, f);
+        if (server_field_wins(clocks[f], values[f], local[f], task_field(stored, f)))
+            won |= 1u << f;
+    }
+
+    if (won)
+        write_merged_fields("tasks", "task_change_receipts", TASK_SYNC_FIELDS, TASK_SYNC_FIELD_COUNT,
+                            task.uuid, won, values, clocks);
+    observe_hlc(latest);
+
+    if (won != all)
+    {
+        UUID uuid = task.uuid;
+        read_task_row(uuid, task);
+    }
+    return won;
+}
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <sqlite3.h>
+#include <cstdint>
+#include <ctime>
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <initializer_list>
 
 #include "uuid.h"
 #include "timeblock.h"
@@ -12,6 +18,32 @@
 
 // Utility: Generate UUID string (defined in database.cpp)
 void generate_uuid(char *uuid_buf);
+void generate_uuid(UUID &uuid); // Binary form, for keys
+
+/**
+ * Hybrid logical clock stamped on every synced column when it changes: milliseconds since
+ * HLC_EPOCH_MS in the high bits and a counter in the low HLC_COUNTER_BITS. A clock always
+ * advances past every clock issued or received before it, and fits the 53 bits a JSON number
+ * holds exactly until 2089. The server merges a row field by field on these: the later clock
+ * wins, and equal clocks fall back to the greater value, so every replica picks the same one.
+ */
+typedef sqlite3_int64 Hlc;
+#define HLC_EPOCH_MS 1577836800000LL // 2020-01-01T00:00:00Z
+#define HLC_COUNTER_BITS 12
+Hlc hlc_from_seconds(time_t seconds); // Clock of an edit only known by its modified_at
+
+// Synced columns of timeblocks and tasks, in change-mask bit order
+#define TIMEBLOCK_SYNC_FIELD_COUNT 8
+#define TASK_SYNC_FIELD_COUNT 9
+#define SYNC_FIELDS_ALL 0xFFFFFFFFu
+extern const char *const TIMEBLOCK_SYNC_FIELDS[TIMEBLOCK_SYNC_FIELD_COUNT];
+extern const char *const TASK_SYNC_FIELDS[TASK_SYNC_FIELD_COUNT];
+struct FieldValue // One synced column: a UUID when uuid is set, text when text is set, otherwise number
+{
+    const char *text;
+    sqlite3_int64 number;
+    const UUID *uuid = nullptr;
+};
 
 // --- Hash function for UUID to allow use in unordered_map ---
 namespace std
@@ -21,73 +53,194 @@ namespace std
     {
         std::size_t operator()(const UUID &u) const noexcept
         {
-            // FNV-1a hash (fast and good for fixed strings)
-            std::size_t h = 1469598103934665603ull;
-            for (int i = 0; i < UUID_LEN - 1 && u.value[i]; ++i)
-            {
-                h ^= static_cast<unsigned char>(u.value[i]);
-                h *= 1099511628211ull;
-            }
-            return h;
+            // Random UUIDs are already uniform; one multiply folds both halves into the low bits
+            uint64_t h = (u.word(0) ^ u.word(1)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(h ^ (h >> 32));
         }
     };
 }
 
+// UUID columns hold the UUID's 16 bytes as a BLOB. The UUID must outlive the statement's step.
+inline int bind_uuid(sqlite3_stmt *stmt, int index, const UUID &uuid)
+{
+    return sqlite3_bind_blob(stmt, index, uuid.bytes, UUID_BYTES, SQLITE_STATIC);
+}
+
+// The empty UUID for NULL or a value that is not 16 bytes
+inline UUID column_uuid(sqlite3_stmt *stmt, int col)
+{
+    const void *data = sqlite3_column_blob(stmt, col);
+    if (!data || sqlite3_column_bytes(stmt, col) != UUID_BYTES)
+        return UUID();
+    return UUID::from_bytes(data);
+}
+
+// Text column interned in StringPool::global(); nullptr for NULL
+inline const char *column_string(sqlite3_stmt *stmt, int col)
+{
+    const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, col));
+    return StringPool::global().intern(text, sqlite3_column_bytes(stmt, col));
+}
+
+/**
+ * SQLite tuning applied when the database is opened. The named presets trade durability for
+ * write latency:
+ *   durable  - WAL, synchronous=FULL: every commit is fsynced before it returns
+ *   balanced - WAL, synchronous=NORMAL: a power loss may drop the last commits, never corrupts
+ *   fast     - WAL, synchronous=OFF: commits are left to the OS to flush
+ */
+struct StorageProfile
+{
+    std::string journal_mode = "WAL";    // DELETE, TRUNCATE, PERSIST, MEMORY, WAL or OFF
+    std::string synchronous = "NORMAL";  // OFF, NORMAL, FULL or EXTRA
+    int cache_size = -16384;             // Pages when positive, KiB when negative
+    long long mmap_size = 64LL << 20;    // Bytes of memory-mapped I/O (0 disables it)
+    std::string temp_store = "MEMORY";   // DEFAULT, FILE or MEMORY
+    int page_size = 4096;                // Only takes effect when the database file is created
+    int busy_timeout = 5000;             // Milliseconds to wait on another connection's lock before SQLITE_BUSY
+
+    // Returns the preset called name ("durable", "balanced" or "fast"); unknown names give balanced
+    static StorageProfile preset(const std::string &name);
+};
+
 class Database
 {
     friend class Synchronizer; // Allow synchronizer to access private members for sync operations
 private:
     sqlite3 *db = nullptr;
 
+    // Prepared statements keyed by their SQL text. Each is prepared once, reset and rebound on
+    // every call, and finalized in ~Database().
+    std::unordered_map<std::string, sqlite3_stmt *> m_stmt_cache;
+    sqlite3_stmt *prepare_cached(const char *sql);
+    int exec_cached(const char *sql);
+
+    int m_batch_depth = 0; // Number of open Batch scopes
+
+    void apply_storage_profile(const StorageProfile &profile);
+
+    // Statement steps shared by the local modifiers and the server-change appliers
+    int step_upsert_timeblock(const Timeblock &tb);
+    int step_upsert_task(const Task &task);
+    void step_server_change(const char *TAG, const char *sql, std::initializer_list<UUID> uuids, const char *text = nullptr, int integer = -1);
+
     // Helper functions for receipt tracking
     // For timeblocks and tasks we store a snapshot of the object so receipts are self-contained.
-    void record_timeblock_receipt(const Timeblock &tb, bool deleted = false);
+    // Every receipt is stamped with the next value of a counter kept in client_sync_state, so
+    // receipts are ordered across all four tables and sequence numbers are never reused.
+    // Timeblock and task receipts also keep a mask of the columns changed since the server last
+    // acknowledged them, and stamp those columns' field clocks.
+    sqlite3_int64 next_receipt_seq();
+    void record_timeblock_receipt(const Timeblock &tb, bool deleted = false, uint32_t changed = SYNC_FIELDS_ALL);
     void delete_timeblock_receipt(const Timeblock &tb); // convenience wrapper
-    void record_task_receipt(const Task &task, bool deleted = false);
+    void record_task_receipt(const Task &task, bool deleted = false, uint32_t changed = SYNC_FIELDS_ALL);
     void delete_task_receipt(const Task &task); // convenience wrapper
-    void record_habit_entry_receipt(const char *task_uuid, const char *date_iso8601);
-    void delete_habit_entry_receipt(const char *task_uuid, const char *date_iso8601);
-    void record_entry_link_receipt(const char *parent_uuid, const char *child_uuid, LinkType link_type);
-    void delete_entry_link_receipt(const char *parent_uuid, const char *child_uuid, LinkType link_type);
+    void record_habit_entry_receipt(const UUID &task_uuid, const char *date_iso8601);
+    void delete_habit_entry_receipt(const UUID &task_uuid, const char *date_iso8601);
+    void record_entry_link_receipt(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type);
+    void delete_entry_link_receipt(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type);
+
+    // Field clocks
+    Hlc next_hlc();            // Clock for a local edit
+    void observe_hlc(Hlc hlc); // Keep later local edits after a clock received from the server
+    void write_field_clocks(const UUID &uuid, uint32_t fields, const Hlc *clocks, int count); // clocks indexed by field
+    void forget_field_clocks(const UUID &uuid); // Row deleted
+    bool read_timeblock_row(const UUID &uuid, Timeblock &tb);
+    bool read_task_row(const UUID &uuid, Task &task);
+    // Stored row's columns that differ from the given one; every column if none is stored
+    uint32_t changed_timeblock_fields(const Timeblock &tb);
+    uint32_t changed_task_fields(const Task &task);
+    // UPDATE only the given columns of one row; values indexed by field
+    void update_fields(const char *table, const char *const *names, int count, const UUID &uuid,
+                       uint32_t fields, const FieldValue *values);
+    // Write the won columns of a merged server row and take over their clocks
+    void write_merged_fields(const char *table, const char *receipt_table, const char *const *names, int count,
+                             const UUID &uuid, uint32_t won, const FieldValue *values, const Hlc *clocks);
 
 public:
     // -------------------------------------- Initialization ----------------------------------------
-    Database();
+    Database(const char *path = DATABASE_PATH, const StorageProfile &profile = StorageProfile());
     ~Database();
 
+    /**
+     * RAII write transaction. Every mutation made while a Batch is alive, together with the
+     * receipts it records, is written in a single commit when commit() is called. Batches nest
+     * (inner ones become savepoints); a Batch destroyed without commit() is rolled back.
+     */
+    class Batch
+    {
+    public:
+        explicit Batch(Database &db);
+        ~Batch();
+        void commit();
+
+        Batch(const Batch &) = delete;
+        Batch &operator=(const Batch &) = delete;
+
+    private:
+        Database &m_db;
+        bool m_nested = false;
+        bool m_done = false;
+    };
+
     // ---------------------------------------- Receipt data ------------------------------------------
-    void clear_receipts(); // Clear all receipts (on completed sync)
+    sqlite3_int64 receipt_seq(); // Sequence number of the newest receipt recorded so far
+    void prune_receipts(sqlite3_int64 through_seq); // Drop the receipts the server acknowledged: seq <= through_seq in every table
 
     // --------------------------------------- Timeblock Data -----------------------------------------
     void insert_timeblock(const Timeblock &tb);
     void load_timeblocks(std::vector<Timeblock> &timeblocks);
     void update_timeblock(const Timeblock &tb);
     void upsert_timeblock(const Timeblock &tb);
-    void delete_timeblock(const char *uuid, bool ignore_failure = false);
+    void delete_timeblock(const UUID &uuid, bool ignore_failure = false);
 
     // ----------------------------------------- Task Data --------------------------------------------
     void insert_task(const Task &task);
     void load_tasks(TaskHash &tasks);
     void update_task(const Task &task);
+    void patch_task(const UUID &uuid, const TaskPatch &patch); // write only the patched columns that changed
     void upsert_task(const Task &task);
-    void delete_task(const char *uuid, bool ignore_failure = false);
+    void delete_task(const UUID &uuid, bool ignore_failure = false);
 
     // -------------------------------------- Habit Entry Data ----------------------------------------
-    void add_habit_entry(const char *task_uuid, const char *date_iso8601);
-    void upsert_habit_entry(const char *task_uuid, const char *date_iso8601);
-    void remove_habit_entry(const char *task_uuid, const char *date_iso8601);
-    bool habit_entry_exists(const char *task_uuid, const char *date_iso8601);
+    void add_habit_entry(const UUID &task_uuid, const char *date_iso8601);
+    void upsert_habit_entry(const UUID &task_uuid, const char *date_iso8601);
+    void remove_habit_entry(const UUID &task_uuid, const char *date_iso8601);
+    bool habit_entry_exists(const UUID &task_uuid, const char *date_iso8601);
 
     // Preview last N habit completions for a task and fill task.completed_days
     void load_habit_completion_preview(Task &task, const char *current_date_iso8601);
+    // Bulk preview load: every habit entry in the `days` days ending at current_date_iso8601,
+    // as (task uuid, day offset) pairs where offset 0 is the current date
+    void load_habit_entries_in_window(const char *current_date_iso8601, int days, std::vector<std::pair<UUID, int>> &outEntries);
     // Load all habit entry dates for a task (ISO date strings -> time_t)
-    void get_habit_entries(const char *task_uuid, std::vector<time_t> &outDates);
+    void get_habit_entries(const UUID &task_uuid, std::vector<time_t> &outDates);
 
     // -------------------------------------- Entry Link Data ----------------------------------------
-    void add_entry_link(const char *parent_uuid, const char *child_uuid, LinkType link_type);
-    // void upsert_entry_link(const char *parent_uuid, const char *child_uuid, LinkType link_type);
-    void remove_entry_link(const char *parent_uuid, const char *child_uuid, LinkType link_type);
-    void remove_all_links_for_task(const char *task_uuid);
-    void remove_all_child_links_for_task(const char *task_uuid);
-    void get_linked_entries(const char *uuid, LinkType link_type, std::vector<char *> &outLinkedUuids);
+    void add_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type);
+    // void upsert_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type);
+    void remove_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type);
+    void remove_all_links_for_task(const UUID &task_uuid);
+    void remove_all_child_links_for_task(const UUID &task_uuid);
+    void get_linked_entries(const UUID &uuid, LinkType link_type, std::vector<UUID> &outLinkedUuids);
+    // Bulk load: every (parent, child) link of link_type in one query
+    void load_entry_links(LinkType link_type, std::vector<std::pair<UUID, UUID>> &outLinks);
+
+    // --------------------------------------- Server changes -----------------------------------------
+    // Write rows received from the sync server. These record no receipts and open no batch:
+    // the caller applies a whole page of them inside one Batch.
+    void apply_server_timeblock(const Timeblock &tb);
+    void apply_server_task(const Task &task);
+    void apply_server_timeblock_delete(const UUID &uuid);
+    void apply_server_task_delete(const UUID &uuid);
+    void apply_server_habit_entry(const UUID &task_uuid, const char *date_iso8601, bool deleted);
+    void apply_server_entry_link(const UUID &parent_uuid, const UUID &child_uuid, LinkType link_type, bool deleted);
+
+    // Merge a server row carrying field clocks into the stored one: each column takes the server's
+    // value only if its clock wins. Only won columns are written, and they are dropped from any
+    // pending receipt. Returns the won columns and leaves the merged row in tb / task.
+    uint32_t merge_server_timeblock(Timeblock &tb, const Hlc *clocks);
+    uint32_t merge_server_task(Task &task, const Hlc *clocks);
+    // Clocks of a row's synced columns; 0 for a column never stamped
+    void load_field_clocks(const UUID &uuid, Hlc *clocks, int count);
 };
\ No newline at end of file
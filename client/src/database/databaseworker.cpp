@@ -0,0 +1,81 @@
+#include "databaseworker.h"
+#include "log.h"
+
+DatabaseWorker::DatabaseWorker(const char *path, const StorageProfile &profile)
+    : m_thread(&DatabaseWorker::run, this, std::string(path), profile)
+{
+}
+
+DatabaseWorker::~DatabaseWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void DatabaseWorker::enqueue(std::function<void(Database *)> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+void DatabaseWorker::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]()
+                { return m_jobs.empty() && !m_busy; });
+}
+
+size_t DatabaseWorker::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size() + (m_busy ? 1 : 0);
+}
+
+// Worker thread: the connection is opened and closed here so it is only ever used on this thread
+void DatabaseWorker::run(std::string path, StorageProfile profile)
+{
+    const char *TAG = "DatabaseWorker::run";
+
+    std::unique_ptr<Database> db;
+    try
+    {
+        db = std::make_unique<Database>(path.c_str(), profile);
+    }
+    catch (int err)
+    {
+        // Keep draining the queue so every job's future receives the error
+        LOGE(TAG, "Failed to open worker connection to %s: %d", path.c_str(), err);
+        m_open_error = err;
+    }
+
+    for (;;)
+    {
+        std::function<void(Database *)> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]()
+                        { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty())
+                break; // Stopping, and nothing left to run
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            m_busy = true;
+        }
+
+        job(db.get()); // Errors are captured in the job's future
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+            if (m_jobs.empty())
+                m_idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/** databaseworker.h
+ * Runs Database calls on a dedicated thread. The worker opens its own connection to the same
+ * file with the same StorageProfile and runs queued jobs one at a time, in submission order,
+ * so callers never wait on SQLite (or an fsync) themselves.
+ */
+#pragma once
+
+#include "database.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+class DatabaseWorker
+{
+public:
+    explicit DatabaseWorker(const char *path = DATABASE_PATH, const StorageProfile &profile = StorageProfile());
+    ~DatabaseWorker(); // Runs every job still queued, then closes the connection
+
+    DatabaseWorker(const DatabaseWorker &) = delete;
+    DatabaseWorker &operator=(const DatabaseWorker &) = delete;
+
+    // Queue job(Database &) behind every job submitted before it. The future holds the job's
+    // result, or rethrows the SQLite error code it threw.
+    template <typename Job>
+    auto submit(Job job) -> std::future<decltype(job(std::declval<Database &>()))>
+    {
+        using Result = decltype(job(std::declval<Database &>()));
+        auto task = std::make_shared<std::packaged_task<Result(Database *)>>(
+            [this, job = std::move(job)](Database *db) mutable
+            {
+                if (!db)
+                    throw m_open_error;
+                return job(*db);
+            });
+        std::future<Result> result = task->get_future();
+        enqueue([task](Database *db)
+                { (*task)(db); });
+        return result;
+    }
+
+    void wait_idle();      // Block until every job submitted so far has finished
+    size_t pending() const; // Jobs queued or running
+
+private:
+    void enqueue(std::function<void(Database *)> job);
+    void run(std::string path, StorageProfile profile);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake; // Job queued or stopping
+    std::condition_variable m_idle; // Queue drained
+    std::deque<std::function<void(Database *)>> m_jobs;
+    bool m_busy = false;
+    bool m_stopping = false;
+    int m_open_error = SQLITE_OK; // Why the worker's connection failed to open; only touched on the worker thread
+
+    std::thread m_thread; // Last, so the state above exists before the thread starts
+};
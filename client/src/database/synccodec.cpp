@@ -0,0 +1,261 @@
+#include "synccodec.h"
+
+#include <QCborStreamWriter>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QStringList>
+#include <QUuid>
+
+#include <utility>
+#include <vector>
+
+#define CBOR_CONTENT_TYPE "application/cbor"
+#define JSON_CONTENT_TYPE "application/json"
+
+static bool is_uuid_field(const QString &field)
+{
+    return field == QLatin1String("uuid") || field.endsWith(QLatin1String("_uuid"));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Encode                                   */
+/* -------------------------------------------------------------------------- */
+
+static void write_value(QCborStreamWriter &writer, const QString &field, const QJsonValue &value)
+{
+    switch (value.type())
+    {
+    case QJsonValue::Null:
+        writer.append(nullptr);
+        break;
+    case QJsonValue::Bool:
+        writer.append(value.toBool());
+        break;
+    case QJsonValue::Double:
+    {
+        // JSON numbers are doubles; integers go out as CBOR integers (1-9 bytes)
+        double d = value.toDouble();
+        qint64 i = static_cast<qint64>(d);
+        if (static_cast<double>(i) == d)
+            writer.append(i);
+        else
+            writer.append(d);
+        break;
+    }
+    case QJsonValue::String:
+    {
+        QString text = value.toString();
+        if (is_uuid_field(field))
+        {
+            // Only canonical UUIDs, so decoding gives back exactly the same text
+            QUuid uuid(text);
+            if (!uuid.isNull() && uuid.toString(QUuid::WithoutBraces) == text)
+            {
+                writer.append(uuid.toRfc4122());
+                break;
+            }
+        }
+        writer.append(QStringView(text));
+        break;
+    }
+    default:
+        QCborValue::fromJsonValue(value).toCbor(writer);
+        break;
+    }
+}
+
+// entries[begin, end) all belong to `table`
+static void write_block(QCborStreamWriter &writer, const QString &table, const QJsonArray &entries, int begin, int end)
+{
+    // The block's field dictionary: every field any of its entries has, in first-seen order
+    QStringList fields;
+    for (int i = begin; i < end; i++)
+    {
+        QJsonObject data = entries[i].toObject().value("data").toObject();
+        for (auto it = data.constBegin(); it != data.constEnd(); ++it)
+        {
+            if (!fields.contains(it.key()))
+                fields.append(it.key());
+        }
+    }
+
+    writer.startArray(3);
+    writer.append(QStringView(table));
+    writer.startArray(fields.size());
+    for (const QString &field : fields)
+        writer.append(QStringView(field));
+    writer.endArray();
+
+    writer.startArray(end - begin);
+    for (int i = begin; i < end; i++)
+    {
+        QJsonObject data = entries[i].toObject().value("data").toObject();
+        writer.startArray(fields.size());
+        for (const QString &field : fields)
+        {
+            auto it = data.constFind(field);
+            if (it == data.constEnd())
+                writer.append(QCborSimpleType::Undefined);
+            else
+                write_value(writer, field, it.value());
+        }
+        writer.endArray();
+    }
+    writer.endArray();
+    writer.endArray();
+}
+
+static QByteArray encode_cbor(const QJsonObject &page)
+{
+    QByteArray out;
+    QCborStreamWriter writer(&out);
+
+    writer.startMap(page.size());
+    for (auto it = page.constBegin(); it != page.constEnd(); ++it)
+    {
+        writer.append(QStringView(it.key()));
+        if (it.key() != QLatin1String("entries"))
+        {
+            QCborValue::fromJsonValue(it.value()).toCbor(writer);
+            continue;
+        }
+
+        // Split the entries into runs from the same table
+        const QJsonArray entries = it.value().toArray();
+        std::vector<std::pair<int, int>> runs;
+        QString previous;
+        for (int i = 0; i < entries.size(); i++)
+        {
+            QString table = entries[i].toObject().value("table").toString();
+            if (i == 0 || table != previous)
+                runs.emplace_back(i, i + 1);
+            else
+                runs.back().second = i + 1;
+            previous = table;
+        }
+
+        writer.startArray(runs.size());
+        for (const auto &[begin, end] : runs)
+            write_block(writer, entries[begin].toObject().value("table").toString(), entries, begin, end);
+        writer.endArray();
+    }
+    writer.endMap();
+
+    return out;
+}
+
+QByteArray SyncCodec::encode(const QJsonObject &page, SyncEncoding encoding)
+{
+    if (encoding == SyncEncoding::CBOR)
+        return encode_cbor(page);
+    return QJsonDocument(page).toJson(QJsonDocument::Compact);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Decode                                   */
+/* -------------------------------------------------------------------------- */
+
+static QJsonValue read_value(const QCborValue &value)
+{
+    if (value.isByteArray() && value.toByteArray().size() == 16)
+        return QUuid::fromRfc4122(value.toByteArray()).toString(QUuid::WithoutBraces);
+    if (value.isInteger())
+        return QJsonValue(value.toInteger());
+    return value.toJsonValue();
+}
+
+static bool decode_entries(const QCborArray &blocks, QJsonArray &entries)
+{
+    for (const QCborValue &blockValue : blocks)
+    {
+        QCborArray block = blockValue.toArray();
+        if (block.size() != 3 || !block[0].isString() || !block[1].isArray() || !block[2].isArray())
+            return false;
+
+        QString table = block[0].toString();
+        QCborArray fieldValues = block[1].toArray();
+        QStringList fields;
+        for (const QCborValue &field : fieldValues)
+            fields.append(field.toString());
+
+        for (const QCborValue &rowValue : block[2].toArray())
+        {
+            QCborArray row = rowValue.toArray();
+            if (row.size() != fields.size())
+                return false;
+
+            QJsonObject data;
+            for (int i = 0; i < fields.size(); i++)
+            {
+                if (!row[i].isUndefined())
+                    data.insert(fields[i], read_value(row[i]));
+            }
+
+            QJsonObject entry;
+            entry["table"] = table;
+            entry["data"] = data;
+            entries.append(entry);
+        }
+    }
+    return true;
+}
+
+bool SyncCodec::decode(const QByteArray &data, SyncEncoding encoding, QJsonObject &page)
+{
+    if (encoding == SyncEncoding::JSON)
+    {
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject())
+            return false;
+        page = doc.object();
+        return true;
+    }
+
+    QCborParserError error;
+    QCborValue root = QCborValue::fromCbor(data, &error);
+    if (error.error != QCborError::NoError || !root.isMap())
+        return false;
+
+    page = QJsonObject();
+    QCborMap map = root.toMap();
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+    {
+        QString key = it.key().toString();
+        if (key != QLatin1String("entries"))
+        {
+            page.insert(key, it.value().toJsonValue());
+            continue;
+        }
+
+        QJsonArray entries;
+        if (!decode_entries(it.value().toArray(), entries))
+            return false;
+        page.insert(key, entries);
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Headers                                  */
+/* -------------------------------------------------------------------------- */
+
+const char *SyncCodec::contentType(SyncEncoding encoding)
+{
+    return encoding == SyncEncoding::CBOR ? CBOR_CONTENT_TYPE : JSON_CONTENT_TYPE;
+}
+
+SyncEncoding SyncCodec::encodingFor(const QByteArray &contentType)
+{
+    return contentType.startsWith(CBOR_CONTENT_TYPE) ? SyncEncoding::CBOR : SyncEncoding::JSON;
+}
+
+QByteArray SyncCodec::deflate(const QByteArray &data)
+{
+    // qCompress prefixes the zlib stream with its uncompressed length
+    return qCompress(data).mid(4);
+}
@@ -0,0 +1,35 @@
+/** synccodec.h
+ * Wire formats for sync pages. Synchronizer builds and consumes a page as a QJsonObject
+ * ({client_id, last_server_version, entries: [{table, data}], ...}); this turns it into bytes
+ * and back.
+ *
+ * JSON sends the object as is. CBOR carries the same top-level keys, but "entries" becomes a
+ * list of blocks, one per run of consecutive entries from the same table:
+ *   [table, [field names], [[row values in field order], ...]]
+ * so field names are written once per block instead of once per entry. A field an entry lacks
+ * is CBOR undefined, and a canonical UUID in a "uuid" or "*_uuid" field is a 16-byte string.
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+
+enum class SyncEncoding
+{
+    JSON,
+    CBOR
+};
+
+class SyncCodec
+{
+public:
+    static QByteArray encode(const QJsonObject &page, SyncEncoding encoding);
+    // False if data is not a page in that encoding
+    static bool decode(const QByteArray &data, SyncEncoding encoding, QJsonObject &page);
+
+    static const char *contentType(SyncEncoding encoding);
+    static SyncEncoding encodingFor(const QByteArray &contentType); // JSON unless it names CBOR
+
+    // HTTP "deflate" content coding (a zlib stream) for request bodies
+    static QByteArray deflate(const QByteArray &data);
+};
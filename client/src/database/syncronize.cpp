@@ -1,5 +1,6 @@
 #include "syncronize.h"
 #include "clientconfig.h"
+#include "synccodec.h"
 #include "log.h"
 
 // Networking
@@ -10,11 +11,13 @@
 #include <QSslKey>
 #include <QUrl>
 #include <QFile>
+#include <QTimer>
 
 // Parsing
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QUuid>
 #include <QDebug>
 #include <QEventLoop>
 
@@ -24,7 +27,9 @@ Synchronizer::Synchronizer(Database &db, QObject *parent)
     const char *TAG = "Synchronizer::Constructor";
 
     // Get server URL and client ID from config
-    serverUrl = ClientConfig::serverAddress();
+    endpoint = QUrl(ClientConfig::serverAddress());
+    endpoint.setScheme("https");
+    endpoint.setPort(ClientConfig::serverPort());
     clientId = ClientConfig::clientId();
 
     connect(networkManager, &QNetworkAccessManager::finished, this, &Synchronizer::onSyncReply);
@@ -70,47 +75,154 @@ Synchronizer::Synchronizer(Database &db, QObject *parent)
     QSslConfiguration::setDefaultConfiguration(sslConfig);
 }
 
+// Request attributes that route a reply back to its exchange and, for a manifest fetch, its table
+static const QNetworkRequest::Attribute SESSION_ATTRIBUTE = QNetworkRequest::User;
+static const QNetworkRequest::Attribute FETCH_ATTRIBUTE = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+
 void Synchronizer::sync()
 {
     const char *TAG = "Synchronizer::sync";
 
-    if (!ClientConfig::syncEnabled())
+    if (session.active)
+    {
+        LOGI(TAG, "Sync already in progress (page %d), skipping sync.", session.pages);
+        return;
+    }
+
+    session = Session();
+    session.id = ++sessionCount;
+    session.active = true;
+    pageSize = ClientConfig::syncPageSize();
+    try
+    {
+        session.uploadThrough = db.receipt_seq();
+        loadResumeState();
+    }
+    catch (int err)
     {
-        LOGI(TAG, "Sync is disabled in config, skipping sync.");
+        LOGE(TAG, "Failed to read the sync state: %d", err);
+        failSession();
         return;
     }
+    sendPage();
+}
 
-    QJsonArray changes = collectLocalChanges();
+// The exchange stopped early. Replies still in flight are dropped when they arrive.
+void Synchronizer::failSession()
+{
+    session.active = false;
+    session.fetches.clear();
+    emit syncFailed();
+}
+
+// Post the next page of the exchange: up to pageSize local receipts while any are left, then
+// empty pages carrying the server's cursor until it has sent everything
+void Synchronizer::sendPage()
+{
+    const char *TAG = "Synchronizer::sendPage";
 
     QJsonObject payload;
     payload["client_id"] = clientId;
     payload["last_server_version"] = lastServerVersion;
-    payload["entries"] = changes;
 
-    QJsonDocument doc(payload);
-    QByteArray data = doc.toJson();
+    // First ask whether the page the last exchange lost was committed, so it is not sent twice
+    if (!session.resumeBatch.isEmpty())
+    {
+        payload["entries"] = QJsonArray();
+        payload["page_size"] = pageSize;
+        payload["more"] = true;
+        payload["resume_batch"] = session.resumeBatch;
+        post(payload, -1);
+        return;
+    }
 
-    // Construct https request to server
-    QUrl url(serverUrl);
-    url.setScheme("https");
-    url.setPort(ClientConfig::serverPort());
+    QJsonArray changes;
+    session.ackPending = !session.uploadDone;
+    if (session.ackPending)
+        changes = collectLocalChanges(pageSize);
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    payload["entries"] = changes;
+    payload["page_size"] = pageSize;
+    payload["more"] = !session.uploadDone;
+    if (!session.downloadCursor.isEmpty())
+        payload["cursor"] = session.downloadCursor;
+    else if (session.uploadDone)
+        payload["manifest"] = true; // The server's changes by table, instead of its first page
+    if (session.ackPending)
+        payload["receipt_seq"] = (qint64)session.ackSeq;
+    if (!changes.isEmpty())
+    {
+        // Stored before it is sent; cleared with the receipts its reply acknowledges
+        QString batch = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        try
+        {
+            storeInflightBatch(batch, session.ackSeq);
+        }
+        catch (int err)
+        {
+            LOGE(TAG, "Failed to record upload page %d: %d", session.pages + 1, err);
+            failSession();
+            return;
+        }
+        payload["batch_id"] = batch;
+    }
+
+    post(payload, -1);
+}
+
+void Synchronizer::post(const QJsonObject &payload, int fetch)
+{
+    const char *TAG = "Synchronizer::post";
+
+    QByteArray data = SyncCodec::encode(payload, encoding);
+    bool deflated = encoding == SyncEncoding::CBOR && ClientConfig::syncCompression();
+    if (deflated)
+        data = SyncCodec::deflate(data);
+
+    session.pages++;
+    LOGI(TAG, "Sending sync page %d%s%s with %d entries (%d bytes, %s%s)", session.pages, fetch >= 0 ? " for " : "",
+         fetch >= 0 ? qPrintable(session.fetches[fetch].table) : "", (int)payload["entries"].toArray().size(), (int)data.size(),
+         SyncCodec::contentType(encoding), deflated ? ", deflate" : "");
+
+    QNetworkRequest request(endpoint);
+    request.setAttribute(SESSION_ATTRIBUTE, session.id);
+    request.setAttribute(FETCH_ATTRIBUTE, fetch);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, SyncCodec::contentType(encoding));
+    if (deflated)
+        request.setRawHeader("Content-Encoding", "deflate");
+
+    // Offer the binary format; a server that does not know it answers in JSON
+    if (ClientConfig::syncEncoding() == SyncEncoding::CBOR)
+        request.setRawHeader("Accept", "application/cbor, application/json;q=0.5");
+    else
+        request.setRawHeader("Accept", "application/json");
 
     // Set SSL configuration for the request
-    QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-    sslConfig.setPeerVerifyMode(QSslSocket::VerifyPeer);
-    request.setSslConfiguration(sslConfig);
+    if (endpoint.scheme() == "https")
+    {
+        QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+        sslConfig.setPeerVerifyMode(QSslSocket::VerifyPeer);
+        request.setSslConfiguration(sslConfig);
+    }
 
+    // A server that accepts the connection but never answers would otherwise hold the exchange,
+    // and with it every later sync, open for good. The abort finishes the reply with an error.
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    request.setTransferTimeout(requestTimeoutMs);
     networkManager->post(request, data);
+#else
+    // No transfer timeout before Qt 5.15, so the whole request gets that long
+    QNetworkReply *reply = networkManager->post(request, data);
+    QTimer::singleShot(requestTimeoutMs, reply, [reply]()
+                       { reply->abort(); });
+#endif
 }
 
 void Synchronizer::onSyncReply(QNetworkReply *reply)
 {
     const char *TAG = "Synchronizer::onSyncReply";
 
-    QUrl expected(serverUrl);
+    const QUrl &expected = endpoint;
     QUrl actual = reply->url();
 
     if (expected.scheme() != actual.scheme() ||
@@ -124,235 +236,731 @@ void Synchronizer::onSyncReply(QNetworkReply *reply)
         return;
     }
 
+    // Table fetches running alongside one that failed finish after their exchange has ended
+    if (!session.active || reply->request().attribute(SESSION_ATTRIBUTE).toInt() != session.id)
+    {
+        reply->deleteLater();
+        return;
+    }
+    int fetch = reply->request().attribute(FETCH_ATTRIBUTE, -1).toInt();
+
     if (reply->error() != QNetworkReply::NoError)
     {
-        LOGE(TAG, "Sync request failed: %s", qPrintable(reply->errorString()));
+        // A server that stopped accepting the binary format gets JSON from the next sync on
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 415 && encoding != SyncEncoding::JSON)
+        {
+            LOGW(TAG, "Server rejected %s, falling back to JSON", SyncCodec::contentType(encoding));
+            encoding = SyncEncoding::JSON;
+        }
+        // A cursor the server no longer accepts (its database was replaced, say) is not resumed
+        if (status == 422)
+        {
+            try
+            {
+                storeDownloadState(0, QString(), QJsonArray());
+            }
+            catch (int err)
+            {
+                LOGE(TAG, "Failed to clear the download state: %d", err);
+            }
+        }
+        LOGE(TAG, "Sync request failed on page %d: %s", session.pages, qPrintable(reply->errorString()));
         reply->deleteLater();
+        failSession();
         return;
     }
 
+    // A reply is a single page, so its size is bounded by the page size we asked for
+    SyncEncoding replyEncoding = SyncCodec::encodingFor(reply->header(QNetworkRequest::ContentTypeHeader).toByteArray());
     QByteArray responseData = reply->readAll();
-    QJsonDocument responseDoc = QJsonDocument::fromJson(responseData);
-    QJsonObject responseObj = responseDoc.object();
+    reply->deleteLater();
+
+    QJsonObject responseObj;
+    if (!SyncCodec::decode(responseData, replyEncoding, responseObj))
+    {
+        LOGE(TAG, "Malformed %s reply on page %d", SyncCodec::contentType(replyEncoding), session.pages);
+        failSession();
+        return;
+    }
+    responseData.clear();
+
+    // The server answers in the binary format only when it can read it too
+    if (replyEncoding != encoding)
+    {
+        LOGI(TAG, "Switching sync encoding to %s", SyncCodec::contentType(replyEncoding));
+        encoding = replyEncoding;
+    }
+
+    // Uploads carry only changed columns, with their clocks, once the server is known to merge them
+    if (!fieldMerge && responseObj["field_merge"] == true)
+    {
+        LOGI(TAG, "Server merges field clocks, sending changed columns only");
+        fieldMerge = true;
+    }
+
+    if (!session.resumeBatch.isEmpty())
+    {
+        resumeUpload(responseObj["acked_seq"]);
+        return;
+    }
+
+    if (fetch >= 0)
+    {
+        TableFetch &tableFetch = session.fetches[fetch];
+        tableFetch.inFlight = false;
+        tableFetch.cursor = responseObj["cursor"].toString(); // Absent on the table's last page
+        tableFetch.entries = responseObj["entries"].toArray();
+        tableFetch.held = true;
+        drainTableFetches();
+        return;
+    }
 
     int newServerVersion = responseObj["new_server_version"].toInt();
     QJsonArray entries = responseObj["entries"].toArray();
+    if (session.uploadDone)
+        session.downloadCursor = responseObj["cursor"].toString(); // Absent on the last page
+    QJsonArray manifest = responseObj["manifest"].toArray();
+    bool hasManifest = session.uploadDone && responseObj["manifest"].isArray();
+    bool lastPage = session.uploadDone && session.downloadCursor.isEmpty() && (!hasManifest || manifest.isEmpty());
+
+    // Servers that predate acknowledgements commit a page before answering it, so their reply
+    // stands in for the acknowledgement
+    bool acknowledged = false;
+    if (session.ackPending)
+    {
+        qint64 sent = session.ackSeq;
+        QJsonValue acked = responseObj["acked_seq"];
+        acknowledged = acked.isNull() || acked.isUndefined() || acked.toVariant().toLongLong() == sent;
+        if (!acknowledged)
+            LOGW(TAG, "Server acknowledged seq %lld for page %d, expected %lld; keeping its receipts",
+                 (long long)acked.toVariant().toLongLong(), session.pages, (long long)sent);
+    }
 
-    applyServerChanges(entries, newServerVersion);
+    // Tables are set up before the manifest's page is applied, so the page stores them to resume
+    // from. Tables left by an interrupted exchange carry on where they stopped; anything newer
+    // waits for the next sync.
+    if (!lastPage && hasManifest)
+    {
+        if (!session.resumeTables.isEmpty())
+            startTableFetches(session.resumeTables, session.resumeVersion);
+        else
+            startTableFetches(manifest, newServerVersion);
+    }
+    if (session.uploadDone)
+        session.resumeTables = QJsonArray();
 
-    reply->deleteLater();
+    try
+    {
+        applyServerChanges(entries, newServerVersion, lastPage, acknowledged);
+    }
+    catch (int err)
+    {
+        // The page has been rolled back along with its download state, so the next sync resumes
+        // from the page before it. The upload page stays recorded as in flight, so the next sync
+        // asks whether the server committed it rather than sending it again.
+        LOGE(TAG, "Failed to apply server changes on page %d: %d", session.pages, err);
+        failSession();
+        return;
+    }
+    session.ackPending = false;
 
+    if (!lastPage && hasManifest)
+    {
+        drainTableFetches();
+        return;
+    }
+    if (!lastPage)
+    {
+        sendPage();
+        return;
+    }
+
+    LOGI(TAG, "Sync completed in %d pages at server version %d", session.pages, newServerVersion);
+    session.active = false;
     emit syncCompleted();
 }
 
-QJsonArray Synchronizer::collectLocalChanges()
+/* -------------------------------------------------------------------------- */
+/*                               Table fetches                                */
+/* -------------------------------------------------------------------------- */
+
+// Request the first page of every table in the manifest at once
+void Synchronizer::startTableFetches(const QJsonArray &manifest, int upto)
 {
-    QJsonArray entries;
+    const char *TAG = "Synchronizer::startTableFetches";
 
-    // Collect timeblock changes by reading snapshots from receipt table
+    session.manifestVersion = upto;
+    session.fetches.clear();
+    for (const QJsonValue &value : manifest)
     {
-        const char *sql = "SELECT uuid, status, name, description, day_frequency, duration, start, day_start, completed_datetime, modified_at, deleted_at "
-                          "FROM timeblock_change_receipts WHERE modified_at > ?";
-        sqlite3_stmt *stmt;
-        if (sqlite3_prepare_v2(db.db, sql, -1, &stmt, nullptr) == SQLITE_OK)
-        {
-            sqlite3_bind_int64(stmt, 1, lastServerVersion);
-            while (sqlite3_step(stmt) == SQLITE_ROW)
-            {
-                QJsonObject data;
-                data["uuid"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 0));
-                data["status"] = sqlite3_column_int(stmt, 1);
-                data["name"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 2));
-                data["description"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 3));
-                data["day_frequency"] = sqlite3_column_int(stmt, 4);
-                data["duration"] = (qint64)sqlite3_column_int64(stmt, 5);
-                data["start"] = (qint64)sqlite3_column_int64(stmt, 6);
-                data["day_start"] = (qint64)sqlite3_column_int64(stmt, 7);
-                data["completed_datetime"] = (qint64)sqlite3_column_int64(stmt, 8);
-                data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 9);
-                data["deleted_at"] = sqlite3_column_type(stmt, 10) == SQLITE_NULL ? QJsonValue::Null : (qint64)sqlite3_column_int64(stmt, 10);
-
-                QJsonObject entry;
-                entry["table"] = "timeblocks";
-                entry["data"] = data;
-                entries.append(entry);
-            }
-            sqlite3_finalize(stmt);
-        }
+        QJsonObject range = value.toObject();
+        TableFetch tableFetch;
+        tableFetch.table = range["table"].toString();
+        tableFetch.cursor = range["cursor"].toString();
+        tableFetch.resume = tableFetch.cursor;
+        LOGI(TAG, "Fetching %d `%s` changes up to server version %d", range["count"].toInt(), qPrintable(tableFetch.table), upto);
+        session.fetches.push_back(tableFetch);
     }
+}
+
+// Apply held pages in manifest order, as far as every table before them is complete, and
+// request the next page of each table that has none held or in flight. Ends the exchange once
+// every table is applied.
+void Synchronizer::drainTableFetches()
+{
+    const char *TAG = "Synchronizer::drainTableFetches";
 
-    // Collect task changes from receipt table
+    bool blocked = false; // A table before this one is still arriving
+    for (size_t i = 0; i < session.fetches.size(); i++)
     {
-        const char *sql = "SELECT uuid, timeblock_uuid, name, description, due_date, priority, scope, status, goal_spec, completed_datetime, modified_at, deleted_at "
-                          "FROM task_change_receipts WHERE modified_at > ?";
-        sqlite3_stmt *stmt;
-        if (sqlite3_prepare_v2(db.db, sql, -1, &stmt, nullptr) == SQLITE_OK)
+        TableFetch &tableFetch = session.fetches[i];
+        if (tableFetch.held && !blocked)
         {
-            sqlite3_bind_int64(stmt, 1, lastServerVersion);
-            while (sqlite3_step(stmt) == SQLITE_ROW)
+            // The server version is stored with the page that leaves nothing to apply after it
+            bool lastPage = tableFetch.cursor.isEmpty();
+            for (size_t j = i + 1; j < session.fetches.size(); j++)
+                lastPage = lastPage && session.fetches[j].cursor.isEmpty() && !session.fetches[j].held;
+
+            tableFetch.resume = tableFetch.cursor;
+            try
+            {
+                applyServerChanges(tableFetch.entries, session.manifestVersion, lastPage, false);
+            }
+            catch (int err)
             {
-                QJsonObject data;
-                data["uuid"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 0));
-                data["timeblock_uuid"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 1));
-                data["name"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 2));
-                data["description"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 3));
-                data["due_date"] = (qint64)sqlite3_column_int64(stmt, 4);
-                data["priority"] = sqlite3_column_int(stmt, 5);
-                data["scope"] = sqlite3_column_int(stmt, 6);
-                data["status"] = sqlite3_column_int(stmt, 7);
-                data["goal_spec"] = sqlite3_column_int(stmt, 8);
-                data["completed_datetime"] = (qint64)sqlite3_column_int64(stmt, 9);
-                data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 10);
-                data["deleted_at"] = sqlite3_column_type(stmt, 11) == SQLITE_NULL ? QJsonValue::Null : (qint64)sqlite3_column_int64(stmt, 11);
-
-                QJsonObject entry;
-                entry["table"] = "tasks";
-                entry["data"] = data;
-                entries.append(entry);
+                LOGE(TAG, "Failed to apply `%s` changes on page %d: %d", qPrintable(tableFetch.table), session.pages, err);
+                failSession();
+                return;
             }
-            sqlite3_finalize(stmt);
+            tableFetch.held = false;
+            tableFetch.entries = QJsonArray();
+        }
+
+        if (!tableFetch.cursor.isEmpty() && !tableFetch.inFlight && !tableFetch.held)
+        {
+            QJsonObject payload;
+            payload["client_id"] = clientId;
+            payload["last_server_version"] = lastServerVersion;
+            payload["entries"] = QJsonArray();
+            payload["page_size"] = pageSize;
+            payload["table"] = tableFetch.table;
+            payload["cursor"] = tableFetch.cursor;
+            tableFetch.inFlight = true;
+            post(payload, (int)i);
         }
+        blocked = blocked || !tableFetch.cursor.isEmpty() || tableFetch.held;
     }
 
-    // Collect habit entry changes directly from receipts
+    if (blocked)
+        return;
+    LOGI(TAG, "Sync completed in %d pages at server version %d", session.pages, session.manifestVersion);
+    session.fetches.clear();
+    session.active = false;
+    emit syncCompleted();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Local receipts                               */
+/* -------------------------------------------------------------------------- */
+
+// Receipt rows are read with the seq in column 0 and the snapshot from column 1
+static QJsonValue column_time_or_null(sqlite3_stmt *stmt, int col)
+{
+    return sqlite3_column_type(stmt, col) == SQLITE_NULL ? QJsonValue(QJsonValue::Null) : QJsonValue((qint64)sqlite3_column_int64(stmt, col));
+}
+
+// UUID columns go out as their canonical text
+static QJsonValue column_uuid_text(sqlite3_stmt *stmt, int col)
+{
+    return QString::fromLatin1(column_uuid(stmt, col).text());
+}
+
+static QJsonObject read_timeblock_receipt(sqlite3_stmt *stmt)
+{
+    QJsonObject data;
+    data["uuid"] = column_uuid_text(stmt, 1);
+    data["status"] = sqlite3_column_int(stmt, 2);
+    data["name"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 3));
+    data["description"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 4));
+    data["day_frequency"] = sqlite3_column_int(stmt, 5);
+    data["duration"] = (qint64)sqlite3_column_int64(stmt, 6);
+    data["start"] = (qint64)sqlite3_column_int64(stmt, 7);
+    data["day_start"] = (qint64)sqlite3_column_int64(stmt, 8);
+    data["completed_datetime"] = (qint64)sqlite3_column_int64(stmt, 9);
+    data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 10);
+    data["deleted_at"] = column_time_or_null(stmt, 11);
+    return data;
+}
+
+static QJsonObject read_task_receipt(sqlite3_stmt *stmt)
+{
+    QJsonObject data;
+    data["uuid"] = column_uuid_text(stmt, 1);
+    data["timeblock_uuid"] = column_uuid_text(stmt, 2);
+    data["name"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 3));
+    data["description"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 4));
+    data["due_date"] = (qint64)sqlite3_column_int64(stmt, 5);
+    data["priority"] = sqlite3_column_int(stmt, 6);
+    data["scope"] = sqlite3_column_int(stmt, 7);
+    data["status"] = sqlite3_column_int(stmt, 8);
+    data["goal_spec"] = sqlite3_column_int(stmt, 9);
+    data["completed_datetime"] = (qint64)sqlite3_column_int64(stmt, 10);
+    data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 11);
+    data["deleted_at"] = column_time_or_null(stmt, 12);
+    return data;
+}
+
+static QJsonObject read_habit_entry_receipt(sqlite3_stmt *stmt)
+{
+    QJsonObject data;
+    data["task_uuid"] = column_uuid_text(stmt, 1);
+    data["date"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 2));
+    data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 3);
+    data["deleted_at"] = column_time_or_null(stmt, 4);
+    return data;
+}
+
+static QJsonObject read_entry_link_receipt(sqlite3_stmt *stmt)
+{
+    QJsonObject data;
+    data["parent_uuid"] = column_uuid_text(stmt, 1);
+    data["child_uuid"] = column_uuid_text(stmt, 2);
+    data["link_type"] = sqlite3_column_int(stmt, 3);
+    data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 4);
+    data["deleted_at"] = column_time_or_null(stmt, 5);
+    return data;
+}
+
+// One query per receipt table, each walking that table's seq index. Timeblock and task rows end
+// with their changed mask.
+static const struct
+{
+    const char *table;
+    const char *sql; // Binds (after seq, through seq, limit)
+    QJsonObject (*read)(sqlite3_stmt *stmt);
+    const char *const *fields; // Synced columns with field clocks; null for tables without
+    int fieldCount;
+} RECEIPT_TABLES[] = {
+    {"timeblocks",
+     "SELECT seq, uuid, status, name, description, day_frequency, duration, start, day_start, completed_datetime, modified_at, deleted_at, changed "
+     "FROM timeblock_change_receipts WHERE seq > ? AND seq <= ? ORDER BY seq LIMIT ?",
+     read_timeblock_receipt, TIMEBLOCK_SYNC_FIELDS, TIMEBLOCK_SYNC_FIELD_COUNT},
+    {"tasks",
+     "SELECT seq, uuid, timeblock_uuid, name, description, due_date, priority, scope, status, goal_spec, completed_datetime, modified_at, deleted_at, changed "
+     "FROM task_change_receipts WHERE seq > ? AND seq <= ? ORDER BY seq LIMIT ?",
+     read_task_receipt, TASK_SYNC_FIELDS, TASK_SYNC_FIELD_COUNT},
+    {"habit_entries",
+     "SELECT seq, task_uuid, date, modified_at, deleted_at "
+     "FROM habit_entry_change_receipts WHERE seq > ? AND seq <= ? ORDER BY seq LIMIT ?",
+     read_habit_entry_receipt, nullptr, 0},
+    {"entry_links",
+     "SELECT seq, parent_uuid, child_uuid, link_type, modified_at, deleted_at "
+     "FROM entry_link_change_receipts WHERE seq > ? AND seq <= ? ORDER BY seq LIMIT ?",
+     read_entry_link_receipt, nullptr, 0},
+};
+static const int RECEIPT_TABLE_COUNT = sizeof(RECEIPT_TABLES) / sizeof(RECEIPT_TABLES[0]);
+
+// Cut a receipt snapshot down to the columns changed since the last acknowledged sync, with the
+// clock of each; a column never stamped goes with the receipt's modified_at. A delete only needs
+// its key and times.
+static void keep_changed_fields(QJsonObject &data, const char *const *fields, const Hlc *clocks, int count, uint32_t changed)
+{
+    const bool deleted = !data["deleted_at"].isNull();
+    const Hlc fallback = hlc_from_seconds(data["modified_at"].toVariant().toLongLong());
+
+    QJsonObject fieldClocks;
+    for (int f = 0; f < count; f++)
     {
-        const char *sql = "SELECT task_uuid, date, modified_at, deleted_at FROM habit_entry_change_receipts WHERE modified_at > ?";
-        sqlite3_stmt *stmt;
-        if (sqlite3_prepare_v2(db.db, sql, -1, &stmt, nullptr) == SQLITE_OK)
+        if (deleted || !(changed & (1u << f)))
+            data.remove(fields[f]);
+        else
+            fieldClocks[fields[f]] = (qint64)(clocks[f] ? clocks[f] : fallback);
+    }
+    if (!deleted)
+        data["clocks"] = fieldClocks;
+}
+
+// Next page of at most limit receipts after the session's upload cursor, in seq order across all
+// four tables, advancing the cursor and the position the page asks to have acknowledged. Each
+// table's query is stepped only as far as the merge takes rows from it, so a page reads about
+// `limit` index entries however many receipts are pending. Marks the upload done once no table
+// has a receipt left.
+QJsonArray Synchronizer::collectLocalChanges(int limit)
+{
+    const char *TAG = "Synchronizer::collectLocalChanges";
+
+    sqlite3_stmt *cursors[RECEIPT_TABLE_COUNT] = {};
+    bool hasRow[RECEIPT_TABLE_COUNT] = {};
+    for (int i = 0; i < RECEIPT_TABLE_COUNT; i++)
+    {
+        cursors[i] = db.prepare_cached(RECEIPT_TABLES[i].sql);
+        if (!cursors[i])
         {
-            sqlite3_bind_int64(stmt, 1, lastServerVersion);
-            while (sqlite3_step(stmt) == SQLITE_ROW)
-            {
-                QJsonObject data;
-                data["task_uuid"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 0));
-                data["date"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 1));
-                data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 2);
-                data["deleted_at"] = sqlite3_column_type(stmt, 3) == SQLITE_NULL ? QJsonValue::Null : (qint64)sqlite3_column_int64(stmt, 3);
-
-                QJsonObject entry;
-                entry["table"] = "habit_entries";
-                entry["data"] = data;
-                entries.append(entry);
-            }
-            sqlite3_finalize(stmt);
+            LOGE(TAG, "Failed to prepare %s receipt query: %s", RECEIPT_TABLES[i].table, sqlite3_errmsg(db.db));
+            continue;
         }
+        sqlite3_bind_int64(cursors[i], 1, session.uploadSeq);
+        sqlite3_bind_int64(cursors[i], 2, session.uploadThrough);
+        sqlite3_bind_int(cursors[i], 3, limit + 1); // One past the page tells whether the table has more
+        hasRow[i] = sqlite3_step(cursors[i]) == SQLITE_ROW;
     }
 
-    // Collect entry link changes directly from receipts
+    QJsonArray entries;
+    while (entries.size() < limit)
     {
-        const char *sql = "SELECT parent_uuid, child_uuid, link_type, modified_at, deleted_at FROM entry_link_change_receipts WHERE modified_at > ?";
-        sqlite3_stmt *stmt;
-        if (sqlite3_prepare_v2(db.db, sql, -1, &stmt, nullptr) == SQLITE_OK)
+        int next = -1;
+        for (int i = 0; i < RECEIPT_TABLE_COUNT; i++)
+        {
+            if (hasRow[i] && (next < 0 || sqlite3_column_int64(cursors[i], 0) < sqlite3_column_int64(cursors[next], 0)))
+                next = i;
+        }
+        if (next < 0)
+            break;
+
+        session.uploadSeq = sqlite3_column_int64(cursors[next], 0);
+        QJsonObject entry;
+        entry["table"] = RECEIPT_TABLES[next].table;
+        QJsonObject data = RECEIPT_TABLES[next].read(cursors[next]);
+        if (fieldMerge && RECEIPT_TABLES[next].fields)
         {
-            sqlite3_bind_int64(stmt, 1, lastServerVersion);
-            while (sqlite3_step(stmt) == SQLITE_ROW)
+            const int count = RECEIPT_TABLES[next].fieldCount;
+            Hlc clocks[TASK_SYNC_FIELD_COUNT] = {}; // The longer of the two lists
+            uint32_t changed = (uint32_t)sqlite3_column_int64(cursors[next], sqlite3_column_count(cursors[next]) - 1);
+            try
             {
-                QJsonObject data;
-                data["parent_uuid"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 0));
-                data["child_uuid"] = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 1));
-                data["link_type"] = sqlite3_column_int(stmt, 2);
-                data["modified_at"] = (qint64)sqlite3_column_int64(stmt, 3);
-                data["deleted_at"] = sqlite3_column_type(stmt, 4) == SQLITE_NULL ? QJsonValue::Null : (qint64)sqlite3_column_int64(stmt, 4);
-
-                QJsonObject entry;
-                entry["table"] = "entry_links";
-                entry["data"] = data;
-                entries.append(entry);
+                db.load_field_clocks(column_uuid(cursors[next], 1), clocks, count);
             }
-            sqlite3_finalize(stmt);
+            catch (int err)
+            {
+                LOGW(TAG, "Failed to read field clocks, sending modified_at instead: %d", err);
+            }
+            keep_changed_fields(data, RECEIPT_TABLES[next].fields, clocks, count, changed);
         }
+        entry["data"] = data;
+        entries.append(entry);
+        hasRow[next] = sqlite3_step(cursors[next]) == SQLITE_ROW;
     }
 
+    session.uploadDone = true;
+    for (int i = 0; i < RECEIPT_TABLE_COUNT; i++)
+    {
+        session.uploadDone = session.uploadDone && !hasRow[i];
+        if (cursors[i])
+            sqlite3_reset(cursors[i]);
+    }
+    session.ackSeq = session.uploadDone ? session.uploadThrough : session.uploadSeq;
     return entries;
 }
 
-void Synchronizer::applyServerChanges(const QJsonArray &entries, int newServerVersion)
+/* -------------------------------------------------------------------------- */
+/*                               Server changes                               */
+/* -------------------------------------------------------------------------- */
+
+// Field clocks of the timeblocks and tasks in a SyncChanges, by index; empty for a row the server
+// sent without them
+struct ServerClocks
+{
+    std::vector<std::vector<Hlc>> timeblocks;
+    std::vector<std::vector<Hlc>> tasks;
+};
+
+static std::vector<Hlc> read_field_clocks(const QJsonObject &data, const char *const *fields, int count)
+{
+    std::vector<Hlc> clocks;
+    if (!data["clocks"].isObject())
+        return clocks;
+    QJsonObject fieldClocks = data["clocks"].toObject();
+    for (int f = 0; f < count; f++)
+        clocks.push_back(fieldClocks[fields[f]].toVariant().toLongLong());
+    return clocks;
+}
+
+// Sort a page's entries into SyncChanges by table and operation
+static void parse_server_changes(const QJsonArray &entries, SyncChanges &changes, ServerClocks &clocks)
 {
     for (const QJsonValue &value : entries)
     {
         QJsonObject entry = value.toObject();
         QString table = entry["table"].toString();
         QJsonObject data = entry["data"].toObject();
+        const bool deleted = data["deleted"] == true;
 
         if (table == "timeblocks")
         {
-            QString uuid = data["uuid"].toString();
-            if (data["deleted"] == true)
+            QByteArray uuid = data["uuid"].toString().toUtf8();
+            if (deleted)
             {
-                // Delete
-                db.delete_timeblock(uuid.toUtf8().constData());
-            }
-            else
-            {
-                // Insert or update
-                Timeblock tb;
-                strncpy(tb.uuid.value, uuid.toUtf8().constData(), UUID_LEN);
-                tb.status = static_cast<TimeblockStatus>(data["status"].toInt());
-                tb.name = strdup(data["name"].toString().toUtf8().constData());
-                tb.desc = strdup(data["description"].toString().toUtf8().constData());
-                tb.day_frequency = GoalSpec::from_sql(data["day_frequency"].toInt());
-                tb.duration = data["duration"].toVariant().toLongLong();
-                tb.start = data["start"].toVariant().toLongLong();
-                tb.day_start = data["day_start"].toVariant().toLongLong();
-                tb.completed_datetime = data["completed_datetime"].toVariant().toLongLong();
-
-                db.upsert_timeblock(tb); // Update or insert
+                changes.removedTimeblocks.emplace_back(uuid.constData());
+                continue;
             }
+
+            Timeblock tb;
+            tb.uuid = UUID(uuid.constData());
+            tb.status = static_cast<TimeblockStatus>(data["status"].toInt());
+            tb.name = intern_string(data["name"].toString().toUtf8().constData());
+            tb.desc = intern_string(data["description"].toString().toUtf8().constData());
+            tb.day_frequency = GoalSpec::from_sql(data["day_frequency"].toInt());
+            tb.duration = data["duration"].toVariant().toLongLong();
+            tb.start = data["start"].toVariant().toLongLong();
+            tb.day_start = data["day_start"].toVariant().toLongLong();
+            tb.completed_datetime = data["completed_datetime"].toVariant().toLongLong();
+            changes.timeblocks.push_back(std::move(tb));
+            clocks.timeblocks.push_back(read_field_clocks(data, TIMEBLOCK_SYNC_FIELDS, TIMEBLOCK_SYNC_FIELD_COUNT));
         }
         else if (table == "tasks")
         {
-            QString uuid = data["uuid"].toString();
-            if (data["deleted"] == true)
+            QByteArray uuid = data["uuid"].toString().toUtf8();
+            if (deleted)
             {
-                db.delete_task(uuid.toUtf8().constData());
-            }
-            else
-            {
-                Task task;
-                strncpy(task.uuid.value, uuid.toUtf8().constData(), UUID_LEN);
-                strncpy(task.timeblock_uuid.value, data["timeblock_uuid"].toString().toUtf8().constData(), UUID_LEN);
-                task.name = strdup(data["name"].toString().toUtf8().constData());
-                task.desc = strdup(data["description"].toString().toUtf8().constData());
-                task.due_date = data["due_date"].toVariant().toLongLong();
-                task.priority = static_cast<Priority>(data["priority"].toInt());
-                task.scope = static_cast<Scope>(data["scope"].toInt());
-                task.status = static_cast<TaskStatus>(data["status"].toInt());
-                task.goal_spec = GoalSpec::from_sql(data["goal_spec"].toInt());
-                task.completed_datetime = data["completed_datetime"].toVariant().toLongLong();
-
-                db.upsert_task(task); // Update or insert
+                changes.removedTasks.emplace_back(uuid.constData());
+                continue;
             }
+
+            Task task;
+            task.uuid = UUID(uuid.constData());
+            task.timeblock_uuid = UUID(data["timeblock_uuid"].toString().toUtf8().constData());
+            task.name = intern_string(data["name"].toString().toUtf8().constData());
+            task.desc = intern_string(data["description"].toString().toUtf8().constData());
+            task.due_date = data["due_date"].toVariant().toLongLong();
+            task.priority = static_cast<Priority>(data["priority"].toInt());
+            task.scope = static_cast<Scope>(data["scope"].toInt());
+            task.status = static_cast<TaskStatus>(data["status"].toInt());
+            task.goal_spec = GoalSpec::from_sql(data["goal_spec"].toInt());
+            task.completed_datetime = data["completed_datetime"].toVariant().toLongLong();
+            changes.tasks.push_back(std::move(task));
+            clocks.tasks.push_back(read_field_clocks(data, TASK_SYNC_FIELDS, TASK_SYNC_FIELD_COUNT));
         }
         else if (table == "habit_entries")
         {
-            QString taskUuid = data["task_uuid"].toString();
-            QString date = data["date"].toString();
-            if (data["deleted"] == true)
-            {
-                db.remove_habit_entry(taskUuid.toUtf8().constData(), date.toUtf8().constData());
-            }
-            else
-            {
-                db.add_habit_entry(taskUuid.toUtf8().constData(), date.toUtf8().constData());
-            }
+            SyncChanges::HabitEntry habitEntry{UUID(data["task_uuid"].toString().toUtf8().constData()),
+                                               data["date"].toString().toStdString()};
+            (deleted ? changes.removedHabitEntries : changes.habitEntries).push_back(habitEntry);
         }
         else if (table == "entry_links")
         {
-            QString parentUuid = data["parent_uuid"].toString();
-            QString childUuid = data["child_uuid"].toString();
-            LinkType linkType = static_cast<LinkType>(data["link_type"].toInt());
-            if (data["deleted"] == true)
-            {
-                db.remove_entry_link(parentUuid.toUtf8().constData(), childUuid.toUtf8().constData(), linkType);
-            }
-            else
-            {
-                db.add_entry_link(parentUuid.toUtf8().constData(), childUuid.toUtf8().constData(), linkType);
-            }
+            SyncChanges::EntryLink link{UUID(data["parent_uuid"].toString().toUtf8().constData()),
+                                        UUID(data["child_uuid"].toString().toUtf8().constData()),
+                                        static_cast<LinkType>(data["link_type"].toInt())};
+            (deleted ? changes.removedLinks : changes.links).push_back(link);
+        }
+        else
+        {
+            LOGW("Synchronizer::parse_server_changes", "Ignoring entry for unknown table `%s`", qPrintable(table));
+        }
+    }
+}
+
+void Synchronizer::applyServerChanges(const QJsonArray &entries, int newServerVersion, bool lastPage, bool acknowledged)
+{
+    const char *TAG = "Synchronizer::applyServerChanges";
+
+    SyncChanges changes;
+    ServerClocks clocks;
+    parse_server_changes(entries, changes, clocks);
+
+    // One transaction for the page, the receipts it acknowledged, and the new server version once
+    // the last page is in. Parents are written before the rows that reference them and deleted
+    // after them.
+    Database::Batch batch(db);
+
+    if (acknowledged)
+        db.prune_receipts(session.ackSeq);
+
+    // Rows with field clocks are merged into the stored ones and reported as merged, along with
+    // the columns they won; rows that won no column are left out of the changes. Rows without
+    // clocks replace the stored ones whole.
+    size_t kept = 0;
+    for (size_t i = 0; i < changes.timeblocks.size(); i++)
+    {
+        Timeblock &tb = changes.timeblocks[i];
+        uint32_t won = SYNC_FIELDS_ALL;
+        if (clocks.timeblocks[i].empty())
+            db.apply_server_timeblock(tb);
+        else if (!(won = db.merge_server_timeblock(tb, clocks.timeblocks[i].data())))
+            continue;
+        changes.timeblocks[kept++] = tb;
+        changes.timeblockFields.push_back(won);
+    }
+    changes.timeblocks.resize(kept);
+
+    kept = 0;
+    for (size_t i = 0; i < changes.tasks.size(); i++)
+    {
+        Task &task = changes.tasks[i];
+        uint32_t won = SYNC_FIELDS_ALL;
+        if (clocks.tasks[i].empty())
+            db.apply_server_task(task);
+        else if (!(won = db.merge_server_task(task, clocks.tasks[i].data())))
+            continue;
+        if (kept != i)
+            changes.tasks[kept] = std::move(task);
+        changes.taskFields.push_back(won);
+        kept++;
+    }
+    changes.tasks.erase(changes.tasks.begin() + kept, changes.tasks.end());
+    for (const SyncChanges::HabitEntry &habitEntry : changes.habitEntries)
+        db.apply_server_habit_entry(habitEntry.taskUuid, habitEntry.date.c_str(), false);
+    for (const SyncChanges::EntryLink &link : changes.links)
+        db.apply_server_entry_link(link.parentUuid, link.childUuid, link.linkType, false);
+
+    for (const SyncChanges::EntryLink &link : changes.removedLinks)
+        db.apply_server_entry_link(link.parentUuid, link.childUuid, link.linkType, true);
+    for (const SyncChanges::HabitEntry &habitEntry : changes.removedHabitEntries)
+        db.apply_server_habit_entry(habitEntry.taskUuid, habitEntry.date.c_str(), true);
+    for (const UUID &uuid : changes.removedTasks)
+        db.apply_server_task_delete(uuid);
+    for (const UUID &uuid : changes.removedTimeblocks)
+        db.apply_server_timeblock_delete(uuid);
+
+    // The reply to the upload page is in, and the download resumes after this page
+    if (session.ackPending)
+        storeInflightBatch(QString(), 0);
+    if (lastPage)
+    {
+        storeLastServerVersion(newServerVersion);
+        storeDownloadState(0, QString(), QJsonArray());
+    }
+    else if (!session.fetches.empty())
+    {
+        QJsonArray tables;
+        for (const TableFetch &tableFetch : session.fetches)
+        {
+            if (!tableFetch.resume.isEmpty())
+                tables.append(QJsonObject{{"table", tableFetch.table}, {"cursor", tableFetch.resume}});
         }
+        storeDownloadState(session.manifestVersion, QString(), tables);
+    }
+    else if (session.uploadDone)
+    {
+        storeDownloadState(newServerVersion, session.downloadCursor, QJsonArray());
     }
+    batch.commit();
+
+    // Only once the page is in: a page that rolls back is asked for again from the old version
+    if (lastPage)
+        lastServerVersion = newServerVersion;
 
-    setLastServerVersion(newServerVersion);
+    LOGI(TAG, "Applied %d server entries", (int)entries.size());
+    if (!changes.empty())
+        emit serverChangesApplied(changes);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Resume state                                */
+/* -------------------------------------------------------------------------- */
+
+// Pick up where an exchange that stopped early left off: the upload page it never heard back
+// about, and the server pages still to fetch
+void Synchronizer::loadResumeState()
+{
+    const char *TAG = "Synchronizer::loadResumeState";
+
+    sqlite3_stmt *stmt = db.prepare_cached(
+        "SELECT download_upto, download_cursor, download_tables, inflight_batch FROM client_sync_state WHERE id = 1;");
+    if (!stmt)
+        throw sqlite3_errcode(db.db);
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        int upto = sqlite3_column_int(stmt, 0);
+        const char *cursor = (const char *)sqlite3_column_text(stmt, 1);
+        const char *tables = (const char *)sqlite3_column_text(stmt, 2);
+        const char *batch = (const char *)sqlite3_column_text(stmt, 3);
+        if (cursor)
+        {
+            session.downloadCursor = QString::fromUtf8(cursor);
+            LOGI(TAG, "Resuming server changes up to version %d from cursor %s", upto, cursor);
+        }
+        if (tables)
+        {
+            session.resumeTables = QJsonDocument::fromJson(tables).array();
+            session.resumeVersion = upto;
+            LOGI(TAG, "Resuming %d manifest tables up to version %d", (int)session.resumeTables.size(), upto);
+        }
+        if (batch)
+            session.resumeBatch = QString::fromUtf8(batch);
+    }
+    sqlite3_reset(stmt);
+}
+
+// Reply to the question about the lost upload page: the server names the receipt seq it
+// committed that page through, or nothing if it never got it, in which case it is sent again
+void Synchronizer::resumeUpload(const QJsonValue &acked)
+{
+    const char *TAG = "Synchronizer::resumeUpload";
+
+    try
+    {
+        Database::Batch batch(db);
+        if (!acked.isNull() && !acked.isUndefined())
+        {
+            LOGI(TAG, "Server committed lost page %s, not sending it again", qPrintable(session.resumeBatch));
+            db.prune_receipts(acked.toVariant().toLongLong());
+        }
+        storeInflightBatch(QString(), 0);
+        batch.commit();
+    }
+    catch (int err)
+    {
+        LOGE(TAG, "Failed to resume the upload: %d", err);
+        failSession();
+        return;
+    }
+    session.resumeBatch.clear();
+    sendPage();
+}
+
+// Where the download resumes: the server version it runs up to and the stream cursor or the
+// manifest tables left. Empty once the last page is applied.
+void Synchronizer::storeDownloadState(int upto, const QString &cursor, const QJsonArray &tables)
+{
+    sqlite3_stmt *stmt = db.prepare_cached(
+        "UPDATE client_sync_state SET download_upto = ?, download_cursor = ?, download_tables = ? WHERE id = 1;");
+    if (!stmt)
+        throw sqlite3_errcode(db.db);
+
+    QByteArray cursorText = cursor.toUtf8();
+    QByteArray tablesText = QJsonDocument(tables).toJson(QJsonDocument::Compact);
+    sqlite3_bind_int(stmt, 1, upto);
+    if (cursor.isEmpty())
+        sqlite3_bind_null(stmt, 2);
+    else
+        sqlite3_bind_text(stmt, 2, cursorText.constData(), -1, SQLITE_STATIC);
+    if (tables.isEmpty())
+        sqlite3_bind_null(stmt, 3);
+    else
+        sqlite3_bind_text(stmt, 3, tablesText.constData(), -1, SQLITE_STATIC);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE("Synchronizer::storeDownloadState", "Failed to store the download state: %s", sqlite3_errmsg(db.db));
+        throw rc;
+    }
+}
+
+// The upload page in flight, or none once its reply is handled
+void Synchronizer::storeInflightBatch(const QString &batch, sqlite3_int64 seq)
+{
+    sqlite3_stmt *stmt = db.prepare_cached("UPDATE client_sync_state SET inflight_batch = ?, inflight_seq = ? WHERE id = 1;");
+    if (!stmt)
+        throw sqlite3_errcode(db.db);
+
+    QByteArray batchText = batch.toUtf8();
+    if (batch.isEmpty())
+        sqlite3_bind_null(stmt, 1);
+    else
+        sqlite3_bind_text(stmt, 1, batchText.constData(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, seq);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        LOGE("Synchronizer::storeInflightBatch", "Failed to store the upload page in flight: %s", sqlite3_errmsg(db.db));
+        throw rc;
+    }
 }
 
 int Synchronizer::getLastServerVersion()
@@ -371,15 +979,19 @@ int Synchronizer::getLastServerVersion()
     return 0;
 }
 
-void Synchronizer::setLastServerVersion(int version)
+// Written inside the page's transaction; lastServerVersion follows once that commits
+void Synchronizer::storeLastServerVersion(int version)
 {
-    const char *sql = "UPDATE client_sync_state SET last_server_version = ? WHERE id = 1;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db.db, sql, -1, &stmt, 0) == SQLITE_OK)
+    sqlite3_stmt *stmt = db.prepare_cached("UPDATE client_sync_state SET last_server_version = ? WHERE id = 1;");
+    if (!stmt)
+        throw sqlite3_errcode(db.db);
+
+    sqlite3_bind_int(stmt, 1, version);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE)
     {
-        sqlite3_bind_int(stmt, 1, version);
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+        LOGE("Synchronizer::storeLastServerVersion", "Failed to store the server version: %s", sqlite3_errmsg(db.db));
+        throw rc;
     }
-    lastServerVersion = version;
 }
\ No newline at end of file
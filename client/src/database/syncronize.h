@@ -1,35 +1,154 @@
 #pragma once
 
 #include <QtNetwork/QNetworkAccessManager>
+#include <QMetaType>
 #include <QObject>
 #include <QJsonArray>
+#include <QUrl>
+
+#include <string>
+#include <vector>
 
 #include "database.h"
+#include "synccodec.h"
+
+/**
+ * Rows one page of server changes wrote to the database, by table and operation, so the
+ * repository can apply the same rows to its in-memory model.
+ */
+struct SyncChanges
+{
+    struct HabitEntry
+    {
+        UUID taskUuid;
+        std::string date; // YYYY-MM-DD
+    };
+    struct EntryLink
+    {
+        UUID parentUuid;
+        UUID childUuid;
+        LinkType linkType;
+    };
+
+    std::vector<Timeblock> timeblocks;     // Inserted or updated
+    std::vector<Task> tasks;               // Inserted or updated; prerequisites and habit previews are not filled
+    std::vector<uint32_t> timeblockFields; // Per timeblock, the columns the server won (TIMEBLOCK_SYNC_FIELDS bits)
+    std::vector<uint32_t> taskFields;      // Per task, the columns the server won (TASK_SYNC_FIELDS bits)
+    std::vector<HabitEntry> habitEntries;
+    std::vector<EntryLink> links;
+    std::vector<UUID> removedTimeblocks;
+    std::vector<UUID> removedTasks;
+    std::vector<HabitEntry> removedHabitEntries;
+    std::vector<EntryLink> removedLinks;
+
+    bool empty() const
+    {
+        return timeblocks.empty() && tasks.empty() && habitEntries.empty() && links.empty() &&
+               removedTimeblocks.empty() && removedTasks.empty() && removedHabitEntries.empty() && removedLinks.empty();
+    }
+};
+Q_DECLARE_METATYPE(SyncChanges)
+
+// Default number of entries per page in either direction, overridden by [Sync]/page_size
+#define SYNC_PAGE_SIZE 500
+// A request with no data moving for this long is aborted, which fails the exchange
+#define SYNC_REQUEST_TIMEOUT_MS 30000
 
 class Synchronizer : public QObject {
     Q_OBJECT
 
 private:
     Database& db;
-    QString serverUrl = "http://127.0.0.1:8001/sync";
+    QUrl endpoint; // Configured server over https, unless overridden
     QString clientId = "mcal2-client";
     QNetworkAccessManager* networkManager;
     int lastServerVersion;
+    int pageSize = SYNC_PAGE_SIZE;
+    int requestTimeoutMs = SYNC_REQUEST_TIMEOUT_MS;
+    SyncEncoding encoding = SyncEncoding::JSON; // Until the server answers in the binary format
+    bool fieldMerge = false; // Server merges by field clock; until it says so, receipts go as whole rows
+
+    /**
+     * One table of a server manifest: its pages are requested one after another, alongside the
+     * other tables' requests. A page is applied once every table before it in the manifest is
+     * complete, so parents land before the rows that reference them; until then it is held, and
+     * the table's next page is not requested.
+     */
+    struct TableFetch
+    {
+        QString table;
+        QString cursor; // Next page to request; empty once the table's last page has arrived
+        QString resume; // First page not yet applied; empty once the table is applied through
+        bool inFlight = false;
+        bool held = false;
+        QJsonArray entries; // The held page
+    };
+
+    /**
+     * One sync exchange. Local receipts are streamed out a page per request, in seq order across
+     * the four receipt tables. Once the last one is sent the server either answers with a
+     * manifest of the tables that changed, fetched side by side, or (servers without manifests)
+     * streams its changes back a page per reply, each carrying the cursor to request the next
+     * with. At most one page per table is held in memory at a time.
+     */
+    struct Session
+    {
+        int id = 0; // Replies to requests from an earlier exchange are dropped
+        bool active = false;
+        sqlite3_int64 uploadThrough = 0; // Receipts up to this seq are sent; later ones wait for the next exchange
+        sqlite3_int64 uploadSeq = 0;     // Merged upload cursor: last seq sent from any table
+        bool uploadDone = false;
+        QString downloadCursor; // Server's cursor for its next page; empty before the first
+        int pages = 0;
+
+        // The page in flight asks the server to acknowledge every receipt up to ackSeq (its last
+        // receipt, or uploadThrough once the whole upload is in)
+        bool ackPending = false;
+        sqlite3_int64 ackSeq = 0;
+
+        std::vector<TableFetch> fetches; // In manifest order; empty without a manifest
+        int manifestVersion = 0;         // Server version the manifest runs up to
+
+        // Left by an exchange that stopped early (see client_sync_state): an upload page whose
+        // reply never arrived, asked about before anything is re-sent, and the manifest tables
+        // still to apply. A stream cursor left behind resumes as downloadCursor.
+        QString resumeBatch;
+        QJsonArray resumeTables;
+        int resumeVersion = 0;
+    } session;
+    int sessionCount = 0;
 
 public:
     Synchronizer(Database& db, QObject* parent = nullptr);
 
     void sync();
+    bool syncing() const { return session.active; }
+
+    // Post pages somewhere other than the configured server, e.g. a loopback test server over http
+    void setEndpoint(const QUrl &url) { endpoint = url; }
+    void setClientId(const QString &id) { clientId = id; }
+    void setRequestTimeout(int ms) { requestTimeoutMs = ms; }
 
 signals:
     void syncCompleted();
+    void syncFailed(); // The exchange stopped early; pages already applied stay committed
+    void serverChangesApplied(const SyncChanges &changes); // After each page commits
 
 private slots:
     void onSyncReply(QNetworkReply* reply);
 
 private:
-    QJsonArray collectLocalChanges();
-    void applyServerChanges(const QJsonArray& entries, int newServerVersion);
+    void sendPage();
+    void post(const QJsonObject &payload, int fetch); // fetch indexes session.fetches, or is -1
+    void failSession();
+    void startTableFetches(const QJsonArray &manifest, int upto);
+    void drainTableFetches();
+    void loadResumeState();
+    void resumeUpload(const QJsonValue &acked);
+    void storeDownloadState(int upto, const QString &cursor, const QJsonArray &tables);
+    void storeInflightBatch(const QString &batch, sqlite3_int64 seq);
+    QJsonArray collectLocalChanges(int limit);
+    void applyServerChanges(const QJsonArray& entries, int newServerVersion, bool lastPage, bool acknowledged);
     int getLastServerVersion();
-    void setLastServerVersion(int version);
+    void storeLastServerVersion(int version);
 };
@@ -0,0 +1,171 @@
+#include "syncscheduler.h"
+#include "clientconfig.h"
+#include "log.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+// A constant stream of edits restarts the debounce at most until the oldest one has waited this
+// many debounce periods
+#define SYNC_DEBOUNCE_LIMIT 4
+
+SyncScheduler::SyncScheduler(const char *path, const StorageProfile &profile, QObject *parent)
+    : QObject(parent), m_path(path), m_profile(profile)
+{
+    qRegisterMetaType<SyncChanges>("SyncChanges");
+
+    m_debounce.setSingleShot(true);
+    m_pull.setSingleShot(true);
+    m_retry.setSingleShot(true);
+    connect(&m_debounce, &QTimer::timeout, this, &SyncScheduler::requestSync);
+    connect(&m_pull, &QTimer::timeout, this, &SyncScheduler::requestSync);
+    connect(&m_retry, &QTimer::timeout, this, &SyncScheduler::requestSync);
+}
+
+SyncScheduler::~SyncScheduler()
+{
+    if (!m_thread.isRunning())
+        return;
+
+    // The sync thread's objects are destroyed on it; the context itself once the thread is gone
+    QMetaObject::invokeMethod(m_context, [this]()
+                              {
+        delete m_synchronizer;
+        delete m_db; }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+}
+
+void SyncScheduler::start()
+{
+    const char *TAG = "SyncScheduler::start";
+
+    if (m_thread.isRunning())
+        return;
+    if (!ClientConfig::syncEnabled())
+    {
+        LOGI(TAG, "Sync is disabled in config, not scheduling sync.");
+        return;
+    }
+
+    m_debounceMs = ClientConfig::syncDebounceMs();
+    m_pull.setInterval(ClientConfig::syncPullInterval() * 1000);
+    m_maxBackoffMs = ClientConfig::syncMaxBackoff() * 1000;
+
+    m_context = new QObject();
+    m_context->moveToThread(&m_thread);
+    m_thread.setObjectName("SyncThread");
+    m_thread.start();
+
+    // The connection and the network manager are created on the thread that uses them
+    QMetaObject::invokeMethod(m_context, [this]()
+                              {
+        try
+        {
+            m_db = new Database(m_path.c_str(), m_profile);
+        }
+        catch (int err)
+        {
+            LOGE("SyncScheduler::start", "Failed to open sync connection to %s: %d", m_path.c_str(), err);
+            return;
+        }
+        m_synchronizer = new Synchronizer(*m_db); }, Qt::BlockingQueuedConnection);
+    if (!m_synchronizer)
+        return;
+
+    // Queued back to this thread, in the order the sync thread emitted them
+    connect(m_synchronizer, &Synchronizer::serverChangesApplied, this, &SyncScheduler::serverChangesApplied);
+    connect(m_synchronizer, &Synchronizer::syncCompleted, this, [this]()
+            {
+        emit syncCompleted();
+        onFinished(true); });
+    connect(m_synchronizer, &Synchronizer::syncFailed, this, [this]()
+            { onFinished(false); });
+
+    LOGI(TAG, "Scheduling sync: %d ms debounce, %d s pull interval", m_debounceMs, m_pull.interval() / 1000);
+    requestSync(); // Catch up with the server on startup
+}
+
+void SyncScheduler::localChange()
+{
+    if (!m_synchronizer)
+        return;
+    if (m_running)
+    {
+        m_pending = true;
+        return;
+    }
+    if (m_retry.isActive())
+        return; // The retry pushes it
+
+    if (!m_debounce.isActive())
+        m_firstChange.start();
+    qint64 limit = (qint64)m_debounceMs * SYNC_DEBOUNCE_LIMIT - m_firstChange.elapsed();
+    m_debounce.start((int)std::max<qint64>(0, std::min<qint64>(m_debounceMs, limit)));
+}
+
+void SyncScheduler::syncNow()
+{
+    requestSync();
+}
+
+void SyncScheduler::requestSync()
+{
+    const char *TAG = "SyncScheduler::requestSync";
+
+    if (!m_synchronizer)
+        return;
+    if (m_running)
+    {
+        m_pending = true;
+        return;
+    }
+
+    m_debounce.stop();
+    m_pull.stop();
+    m_retry.stop();
+    if (!ClientConfig::syncEnabled())
+    {
+        LOGI(TAG, "Sync was disabled in config, no further syncs scheduled.");
+        return;
+    }
+
+    m_running = true;
+    m_pending = false;
+    Synchronizer *synchronizer = m_synchronizer;
+    QMetaObject::invokeMethod(synchronizer, [synchronizer]()
+                              { synchronizer->sync(); }, Qt::QueuedConnection);
+}
+
+void SyncScheduler::onFinished(bool success)
+{
+    const char *TAG = "SyncScheduler::onFinished";
+
+    m_running = false;
+    if (success)
+    {
+        m_failures = 0;
+        if (m_pending)
+        {
+            // Committed while the exchange was in flight; the debounce gives the next edit a chance to join
+            m_pending = false;
+            m_firstChange.start();
+            m_debounce.start(m_debounceMs);
+        }
+        m_pull.start();
+        return;
+    }
+
+    // Anything pending goes with the retry. Jitter keeps clients that failed together (a server
+    // restart) from retrying together.
+    m_pending = false;
+    m_failures++;
+    qint64 delay = std::min<qint64>((qint64)SYNC_BACKOFF_BASE_MS << std::min(m_failures - 1, 16), m_maxBackoffMs);
+    delay += QRandomGenerator::global()->bounded((int)(delay / 5) + 1);
+    m_retry.start((int)delay);
+
+    LOGW(TAG, "Sync failed %d time(s) in a row, retrying in %lld ms", m_failures, (long long)delay);
+    emit syncFailed(m_failures, (int)delay);
+}
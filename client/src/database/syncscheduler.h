@@ -0,0 +1,63 @@
+/** syncscheduler.h
+ * Decides when the client syncs and runs each exchange on a dedicated thread. Local edits
+ * schedule a debounced sync, an idle client pulls on a fixed interval, and a failed exchange is
+ * retried with exponential backoff. The Synchronizer and its own database connection live on the
+ * sync thread, so neither network replies nor sync writes are handled on the GUI thread.
+ */
+#pragma once
+
+#include "syncronize.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+
+// Defaults, overridden by [Sync]/debounce_ms, [Sync]/pull_interval and [Sync]/max_backoff
+#define SYNC_DEBOUNCE_MS 2000      // Quiet time after the last local edit before it is pushed
+#define SYNC_PULL_INTERVAL_S 300   // Pull after this long without a sync
+#define SYNC_MAX_BACKOFF_S 600     // Longest wait between retries of a failing sync
+#define SYNC_BACKOFF_BASE_MS 5000  // First retry delay, doubled per consecutive failure
+
+class SyncScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    SyncScheduler(const char *path, const StorageProfile &profile, QObject *parent = nullptr);
+    ~SyncScheduler(); // Drops any exchange in flight; what was not committed is sent again next time
+
+    void start();       // Sync now, then keep syncing; does nothing while sync is disabled in config
+    void localChange(); // A local write has been committed and needs pushing
+    void syncNow();     // Sync as soon as possible, skipping the debounce and any backoff wait
+
+    bool running() const { return m_running; }
+
+signals:
+    void serverChangesApplied(const SyncChanges &changes); // Each committed page, on the GUI thread
+    void syncCompleted();
+    void syncFailed(int failures, int retryMs); // Consecutive failures and the wait before the retry
+
+private:
+    void requestSync();           // Start an exchange now, or once the running one finishes
+    void onFinished(bool success); // Exchange ended; arm the next pull or the retry
+
+    QThread m_thread;
+    QObject *m_context = nullptr;            // Lives on m_thread; owns the objects below
+    Database *m_db = nullptr;                // Sync thread's connection
+    Synchronizer *m_synchronizer = nullptr;  // Null until start(), or if the connection failed
+
+    QTimer m_debounce; // Single shot, restarted by each local change
+    QTimer m_pull;     // Single shot, restarted after each exchange
+    QTimer m_retry;    // Single shot, armed after a failure
+    QElapsedTimer m_firstChange; // Oldest change not yet pushed, so constant edits cannot hold a sync off forever
+
+    bool m_running = false; // An exchange is in flight on the sync thread
+    bool m_pending = false; // Changes arrived while it was
+    int m_failures = 0;     // Consecutive failed exchanges
+    int m_debounceMs = SYNC_DEBOUNCE_MS;
+    int m_maxBackoffMs = SYNC_MAX_BACKOFF_S * 1000;
+
+    const std::string m_path;
+    const StorageProfile m_profile;
+};
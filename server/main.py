@@ -1,20 +1,75 @@
-from fastapi import FastAPI
+import json
 
+from fastapi import FastAPI, HTTPException, Request, Response
+from fastapi.concurrency import run_in_threadpool
+from fastapi.middleware.gzip import GZipMiddleware
+
+from . import wire
 from .database import init_db
 from .models import SyncRequest, SyncResponse
-from .sync import process_sync
+from .sync import committed_batch_seq, process_sync
 
 app = FastAPI()
 
+# Replies larger than a packet are gzipped for clients that accept it
+app.add_middleware(GZipMiddleware, minimum_size=1024)
+
 init_db()
 
 @app.post("/sync", response_model=SyncResponse)
-def sync(request: SyncRequest):
-    new_version, deltas = process_sync(request)
+async def sync(http_request: Request):
+    content_type = http_request.headers.get("content-type", "")
+    if content_type.startswith(wire.CBOR_CONTENT_TYPE):
+        decode = wire.decode_page
+    elif content_type.startswith("application/json") or not content_type:
+        decode = json.loads
+    else:
+        raise HTTPException(status_code=415, detail=f"Unsupported sync encoding {content_type}")
+
+    try:
+        body = await http_request.body()
+        if http_request.headers.get("content-encoding") == "deflate":
+            body = wire.inflate(body)
+        request = SyncRequest(**decode(body))
+    except ValueError as e:
+        raise HTTPException(status_code=422, detail=f"Malformed sync page: {e}")
+
+    # process_sync has committed the page's entries by the time it returns, so the client may
+    # drop its receipts up to the position it sent. The database work blocks, so it runs on the
+    # thread pool rather than holding up every other request on the event loop
+    try:
+        new_version, deltas, cursor, manifest = await run_in_threadpool(process_sync, request)
+    except ValueError as e:
+        raise HTTPException(status_code=422, detail=f"Bad sync cursor: {e}")
+    if request.resume_batch is not None:
+        acked_seq = await run_in_threadpool(committed_batch_seq, request.client_id, request.resume_batch)
+    else:
+        acked_seq = request.receipt_seq
+    response = SyncResponse(
+        new_server_version=new_version,
+        entries=deltas,
+        cursor=cursor,
+        acked_seq=acked_seq,
+        manifest=manifest,
+    )
+
+    # Answer in the binary format when the client offers it, which also tells it we read it
+    if wire.CBOR_CONTENT_TYPE in http_request.headers.get("accept", ""):
+        return Response(content=wire.encode_page(response_dict(response)), media_type=wire.CBOR_CONTENT_TYPE)
+    return response
+
 
-    return SyncResponse(new_server_version=new_version, entries=deltas)
+def response_dict(response):
+    return {
+        "new_server_version": response.new_server_version,
+        "entries": [{"table": e.table, "data": e.data} for e in response.entries],
+        "cursor": response.cursor,
+        "acked_seq": response.acked_seq,
+        "manifest": [m.dict() for m in response.manifest] if response.manifest is not None else None,
+        "field_merge": response.field_merge,
+    }
 
 
 @app.get("/")
 def root():
-    return {"status": "mCal2 sync server running"}
\ No newline at end of file
+    return {"status": "mCal2 sync server running"}
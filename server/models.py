@@ -1,5 +1,5 @@
 from pydantic import BaseModel
-from typing import List, Dict, Any
+from typing import List, Dict, Any, Optional
 
 class Entry(BaseModel):
     table: str
@@ -9,7 +9,33 @@ class SyncRequest(BaseModel):
     client_id: str
     last_server_version: int
     entries: List[Entry]
+    # Paging: 0 sends every delta in one reply. Otherwise the client sets `more` while it still
+    # has entries to upload, then echoes back each reply's `cursor` until a reply has none.
+    page_size: int = 0
+    more: bool = False
+    cursor: Optional[str] = None
+    # Position of the client's upload after this page, in its local receipt sequence
+    receipt_seq: Optional[int] = None
+    # Asked on the last upload page: reply with a manifest instead of the first delta page
+    manifest: bool = False
+    # Fetch one table of a manifest, starting from its cursor
+    table: Optional[str] = None
+    # Random id of an upload page, recorded with its receipt_seq when the page commits
+    batch_id: Optional[str] = None
+    # The client lost the reply to this batch: acked_seq says whether it was committed
+    resume_batch: Optional[str] = None
+
+class TableRange(BaseModel):
+    table: str
+    after: int  # Versions (after, upto] have changes in this table
+    upto: int
+    count: int
+    cursor: str  # Pages through this table alone
 
 class SyncResponse(BaseModel):
     new_server_version: int
-    entries: List[Entry]
\ No newline at end of file
+    entries: List[Entry]
+    cursor: Optional[str] = None  # Set while more pages follow
+    acked_seq: Optional[int] = None  # The request's receipt_seq, once its entries are committed
+    manifest: Optional[List[TableRange]] = None  # Tables with changes, parents first
+    field_merge: bool = True  # Timeblock and task entries with "clocks" are merged field by field
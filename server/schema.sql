@@ -92,4 +92,28 @@ CREATE TABLE IF NOT EXISTS entry_links_ledger (
     modified_at INTEGER NOT NULL,
     deleted BOOLEAN NOT NULL DEFAULT 0,
     PRIMARY KEY(parent_uuid, child_uuid)
-);
\ No newline at end of file
+);
+
+-- Deltas are read from each ledger by server_version range
+CREATE INDEX IF NOT EXISTS timeblocks_ledger_server_version ON timeblocks_ledger(server_version);
+CREATE INDEX IF NOT EXISTS tasks_ledger_server_version ON tasks_ledger(server_version);
+CREATE INDEX IF NOT EXISTS habit_entries_ledger_server_version ON habit_entries_ledger(server_version);
+CREATE INDEX IF NOT EXISTS entry_links_ledger_server_version ON entry_links_ledger(server_version);
+
+-- Clock of the last change to each synced column of a timeblock or task (see FIELDS in sync.py).
+-- Rows without one fall back to their ledger modified_at.
+CREATE TABLE IF NOT EXISTS field_clocks (
+    table_name TEXT NOT NULL,
+    pk TEXT NOT NULL,
+    field TEXT NOT NULL,
+    hlc INTEGER NOT NULL,
+    PRIMARY KEY(table_name, pk, field)
+) WITHOUT ROWID;
+
+-- Last upload page committed for each client, so a client that lost the reply can ask about it
+-- instead of sending the page again
+CREATE TABLE IF NOT EXISTS client_batches (
+    client_id TEXT PRIMARY KEY,
+    batch_id TEXT NOT NULL,
+    receipt_seq INTEGER NOT NULL
+);
@@ -1,3 +1,5 @@
+import json
+
 from .database import get_db
 
 TABLES = {
@@ -10,6 +12,29 @@ TABLES = {
     },
 }
 
+# Columns merged field by field on their hybrid logical clocks, for the tables whose entries carry
+# "clocks". Matches TIMEBLOCK_SYNC_FIELDS / TASK_SYNC_FIELDS in client/src/database/database.h.
+FIELDS = {
+    "timeblocks": ["status", "name", "description", "day_frequency", "duration", "start", "day_start", "completed_datetime"],
+    "tasks": ["timeblock_uuid", "name", "description", "due_date", "priority", "scope", "status", "goal_spec", "completed_datetime"],
+}
+TEXT_FIELDS = {"timeblock_uuid", "name", "description"}
+
+# A clock is milliseconds since 2020-01-01 shifted left by the counter bits, as on the client
+HLC_EPOCH_MS = 1577836800000
+HLC_COUNTER_BITS = 12
+
+
+def hlc_from_seconds(seconds):
+    return max(0, seconds * 1000 - HLC_EPOCH_MS) << HLC_COUNTER_BITS
+
+
+# Tie-break order for equal clocks, the same as the client's: numbers below text, text by UTF-8 bytes
+def field_order(field, value):
+    if field in TEXT_FIELDS:
+        return (1, (value or "").encode("utf-8"))
+    return (0, value or 0)
+
 
 def get_global_version(conn):
     return conn.execute(
@@ -17,14 +42,16 @@ def get_global_version(conn):
     ).fetchone()[0]
 
 
-def increment_global_version(conn):
-    conn.execute(
-        "UPDATE server_state SET global_version = global_version + 1 WHERE id = 1"
-    )
-    return get_global_version(conn)
+def set_global_version(conn, version):
+    conn.execute("UPDATE server_state SET global_version = ? WHERE id = 1", (version,))
 
 
-def apply_entry(conn, table, data):
+# Applies one entry under the given server version; the caller advances the global version
+# once for the whole page
+def apply_entry(conn, table, data, version):
+    if table in FIELDS and isinstance(data.get("clocks"), dict):
+        return merge_entry(conn, table, data, version)
+
     config = TABLES[table]
     pk_fields = config["pk"]
     ledger_table = config["ledger"]
@@ -74,13 +101,10 @@ def apply_entry(conn, table, data):
             list(main_data.values()),
         )
 
-    # Increment version
-    new_version = increment_global_version(conn)
-
     # Update ledger
     ledger_columns = pk_fields + ["server_version", "modified_at", "deleted"]
     ledger_values = pk_values + [
-        new_version,
+        version,
         data["modified_at"],
         1 if data.get("deleted_at") else 0,
     ]
@@ -97,9 +121,120 @@ def apply_entry(conn, table, data):
         ledger_values,
     )
 
+    # A whole-row write leaves no column newer than the row's modified_at
+    if table in FIELDS:
+        conn.execute(
+            "DELETE FROM field_clocks WHERE table_name = ? AND pk = ?", (table, data["uuid"])
+        )
+
+    return True
+
+
+# Applies the columns of an entry whose clocks beat the stored ones (or tie with a greater value).
+# The entry holds only the columns its client changed; it can only create a row it has in full.
+def merge_entry(conn, table, data, version):
+    ledger_table = TABLES[table]["ledger"]
+    pk = data["uuid"]
+    clocks = data["clocks"]
+    fields = [f for f in FIELDS[table] if f in data and f in clocks]
+
+    ledger = conn.execute(
+        f"SELECT modified_at, deleted FROM {ledger_table} WHERE uuid = ?", (pk,)
+    ).fetchone()
+    row = conn.execute(f"SELECT * FROM {table} WHERE uuid = ?", (pk,)).fetchone()
+
+    if row is None:
+        if ledger and ledger["modified_at"] >= data["modified_at"]:
+            return False  # deleted after this edit
+        if len(fields) < len(FIELDS[table]):
+            print(f"Ignoring partial `{table}` entry for missing row {pk}")
+            return False
+        won = fields
+        columns = ["uuid"] + won
+        conn.execute(
+            f"INSERT INTO {table} ({', '.join(columns)}) VALUES ({', '.join(['?'] * len(columns))})",
+            [pk] + [data[f] for f in won],
+        )
+    else:
+        stored = dict(
+            conn.execute(
+                "SELECT field, hlc FROM field_clocks WHERE table_name = ? AND pk = ?", (table, pk)
+            ).fetchall()
+        )
+        fallback = hlc_from_seconds(ledger["modified_at"]) if ledger else 0
+        won = []
+        for f in fields:
+            local = stored.get(f, fallback)
+            if clocks[f] > local or (
+                clocks[f] == local and field_order(f, data[f]) > field_order(f, row[f])
+            ):
+                won.append(f)
+        if not won:
+            return False
+        conn.execute(
+            f"UPDATE {table} SET {', '.join(f'{f} = ?' for f in won)} WHERE uuid = ?",
+            [data[f] for f in won] + [pk],
+        )
+
+    print(f"Merged `{table}` {pk} fields {won}")
+    conn.executemany(
+        "INSERT OR REPLACE INTO field_clocks (table_name, pk, field, hlc) VALUES (?, ?, ?, ?)",
+        [(table, pk, f, clocks[f]) for f in won],
+    )
+    modified_at = max(data["modified_at"], ledger["modified_at"]) if ledger else data["modified_at"]
+    conn.execute(
+        f"REPLACE INTO {ledger_table} (uuid, server_version, modified_at, deleted) VALUES (?, ?, ?, 0)",
+        (pk, version, modified_at),
+    )
     return True
 
 
+def ledger_row_to_entry(table, pk_fields, row):
+    row_dict = dict(row)
+    data = {}
+
+    # Add primary key fields
+    for pk in pk_fields:
+        data[pk] = row_dict[pk]
+
+    # Add metadata
+    data["modified_at"] = row_dict["modified_at"]
+    data["server_version"] = row_dict["server_version"]
+
+    # Check if this is a deletion
+    if row_dict["deleted"]:
+        data["deleted"] = True
+    else:
+        data["deleted"] = False
+        # Add all other fields from main table
+        for k, v in row_dict.items():
+            if k not in pk_fields and k not in {
+                "modified_at",
+                "server_version",
+                "deleted",
+                "clocks",
+            }:
+                data[k] = v
+
+        # Every column's clock, so the client can merge the row as the server did
+        if table in FIELDS:
+            stored = json.loads(row_dict["clocks"] or "{}")
+            fallback = hlc_from_seconds(row_dict["modified_at"])
+            data["clocks"] = {f: stored.get(f, fallback) for f in FIELDS[table]}
+
+    return {"table": table, "data": data}
+
+
+# Extra select column with a row's field clocks as a JSON object, for the tables that have them
+def clocks_column(table):
+    if table not in FIELDS:
+        return ""
+    return (
+        ", (SELECT json_group_object(c.field, c.hlc) FROM field_clocks c"
+        f" WHERE c.table_name = '{table}' AND c.pk = l.uuid) AS clocks"
+    )
+
+
 def collect_deltas(conn, last_version):
     results = []
 
@@ -110,7 +245,7 @@ def collect_deltas(conn, last_version):
         # Collect both active and deleted records from ledger
         ledger_rows = conn.execute(
             f"""
-            SELECT l.*, t.*
+            SELECT l.*, t.*{clocks_column(table)}
             FROM {ledger} l
             LEFT JOIN {table} t
             ON {" AND ".join([f"l.{k}=t.{k}" for k in pk_fields])}
@@ -120,32 +255,7 @@ def collect_deltas(conn, last_version):
         ).fetchall()
 
         for row in ledger_rows:
-            row_dict = dict(row)
-            data = {}
-
-            # Add primary key fields
-            for pk in pk_fields:
-                data[pk] = row_dict[pk]
-
-            # Add metadata
-            data["modified_at"] = row_dict["modified_at"]
-            data["server_version"] = row_dict["server_version"]
-
-            # Check if this is a deletion
-            if row_dict["deleted"]:
-                data["deleted"] = True
-            else:
-                data["deleted"] = False
-                # Add all other fields from main table
-                for k, v in row_dict.items():
-                    if k not in pk_fields and k not in {
-                        "modified_at",
-                        "server_version",
-                        "deleted",
-                    }:
-                        data[k] = v
-
-            results.append({"table": table, "data": data})
+            results.append(ledger_row_to_entry(table, pk_fields, row))
 
     print(
         f"Collected {len(results)} deltas since version {last_version} -> {get_global_version(conn)}"
@@ -153,22 +263,172 @@ def collect_deltas(conn, last_version):
     return results
 
 
+# A page cursor is "<table index>:<after version>:<upto version>". Tables are walked in TABLES
+# order (parents first) and each by server_version; upto is the global version when the first
+# page was collected, so rows written during the exchange wait for the next sync.
+def parse_cursor(cursor, conn):
+    if not cursor:
+        return 0, 0, get_global_version(conn)
+    table_index, after, upto = (int(part) for part in cursor.split(":"))
+    return table_index, after, upto
+
+
+# Ledger rows of one table in (after, upto], oldest first, joined with their current values
+def collect_ledger_rows(conn, table, after, upto, limit):
+    config = TABLES[table]
+    pk_fields = config["pk"]
+    return conn.execute(
+        f"""
+        SELECT l.*, t.*{clocks_column(table)}
+        FROM {config["ledger"]} l
+        LEFT JOIN {table} t
+        ON {" AND ".join([f"l.{k}=t.{k}" for k in pk_fields])}
+        WHERE l.server_version > ? AND l.server_version <= ?
+        ORDER BY l.server_version
+        LIMIT ?
+        """,
+        (after, upto, limit),
+    ).fetchall()
+
+
+def collect_delta_page(conn, last_version, cursor, page_size):
+    table_index, after, upto = parse_cursor(cursor, conn)
+    tables = list(TABLES.items())
+    results = []
+
+    while table_index < len(tables) and len(results) < page_size:
+        table, config = tables[table_index]
+        pk_fields = config["pk"]
+        remaining = page_size - len(results)
+
+        # One row past the page tells whether the table has more
+        ledger_rows = collect_ledger_rows(
+            conn, table, max(last_version, after), upto, remaining + 1
+        )
+
+        for row in ledger_rows[:remaining]:
+            results.append(ledger_row_to_entry(table, pk_fields, row))
+
+        if len(ledger_rows) > remaining:
+            after = ledger_rows[remaining - 1]["server_version"]
+            return results, f"{table_index}:{after}:{upto}", upto
+
+        table_index += 1
+        after = 0
+
+    if table_index < len(tables):
+        return results, f"{table_index}:{after}:{upto}", upto
+    return results, None, upto
+
+
+# Per-table version ranges for a client at last_version: each table with changes up to the
+# current global version, with a cursor that pages through that table alone. The client can
+# fetch the tables side by side and apply them in this order (parents first).
+def collect_manifest(conn, last_version):
+    upto = get_global_version(conn)
+    manifest = []
+    for table_index, (table, config) in enumerate(TABLES.items()):
+        count = conn.execute(
+            f"SELECT COUNT(*) FROM {config['ledger']} WHERE server_version > ? AND server_version <= ?",
+            (last_version, upto),
+        ).fetchone()[0]
+        if count:
+            manifest.append(
+                {
+                    "table": table,
+                    "after": last_version,
+                    "upto": upto,
+                    "count": count,
+                    "cursor": f"{table_index}:{last_version}:{upto}",
+                }
+            )
+    return upto, manifest
+
+
+# A page of one table from a manifest cursor; the cursor is None once the table is done
+def collect_table_page(conn, last_version, table, cursor, page_size):
+    table_index, after, upto = parse_cursor(cursor, conn)
+    tables = list(TABLES)
+    if table_index >= len(tables) or tables[table_index] != table:
+        raise ValueError(f"cursor {cursor} does not page through table {table}")
+
+    ledger_rows = collect_ledger_rows(
+        conn, table, max(last_version, after), upto, page_size + 1
+    )
+    pk_fields = TABLES[table]["pk"]
+    results = [ledger_row_to_entry(table, pk_fields, row) for row in ledger_rows[:page_size]]
+    if len(ledger_rows) > page_size:
+        return results, f"{table_index}:{ledger_rows[page_size - 1]['server_version']}:{upto}", upto
+    return results, None, upto
+
+
+# Receipt seq the client's upload page batch_id was committed through, or None if it is not the
+# client's last committed page
+def committed_batch_seq(client_id, batch_id):
+    conn = get_db()
+    try:
+        row = conn.execute(
+            "SELECT receipt_seq FROM client_batches WHERE client_id = ? AND batch_id = ?",
+            (client_id, batch_id),
+        ).fetchone()
+        return row["receipt_seq"] if row else None
+    finally:
+        conn.close()
+
+
+# Returns (new_version, deltas, cursor, manifest); manifest is None unless the request asked for one
 def process_sync(request):
     conn = get_db()
     try:
-        conn.execute("BEGIN")
+        # Immediate, so the global version read below cannot be advanced by another writer
+        conn.execute("BEGIN IMMEDIATE")
 
         print(
             f"Processing sync for client {request.client_id} with last_server_version {request.last_server_version}"
         )
         print(f"Received {len(request.entries)} entries from client")
 
+        # Every applied entry takes the next version; the global version is written once
+        version = start_version = get_global_version(conn)
         for entry in request.entries:
             print(f"Applying entry for table `{entry.table}` with data {entry.data}")
-            apply_entry(conn, entry.table, entry.data)
-
-        new_version = get_global_version(conn)
-        deltas = collect_deltas(conn, request.last_server_version)
+            if apply_entry(conn, entry.table, entry.data, version + 1):
+                version += 1
+        if version != start_version:
+            set_global_version(conn, version)
+
+        # Committed with the entries, so a client that lost the reply can find out
+        if request.batch_id is not None and request.receipt_seq is not None:
+            conn.execute(
+                "REPLACE INTO client_batches (client_id, batch_id, receipt_seq) VALUES (?, ?, ?)",
+                (request.client_id, request.batch_id, request.receipt_seq),
+            )
+
+        cursor = None
+        manifest = None
+        if request.table is not None and request.page_size > 0:
+            # One table of a manifest, fetched alongside the others
+            deltas, cursor, new_version = collect_table_page(
+                conn, request.last_server_version, request.table, request.cursor, request.page_size
+            )
+        elif request.page_size <= 0:
+            new_version = get_global_version(conn)
+            deltas = collect_deltas(conn, request.last_server_version)
+        elif request.more:
+            # The client is still uploading; its changes come back once it has sent them all
+            new_version = request.last_server_version
+            deltas = []
+        elif request.manifest and not request.cursor:
+            new_version, manifest = collect_manifest(conn, request.last_server_version)
+            deltas = []
+            print(f"Manifest since version {request.last_server_version}: {manifest}")
+        else:
+            deltas, cursor, new_version = collect_delta_page(
+                conn, request.last_server_version, request.cursor, request.page_size
+            )
+            print(
+                f"Collected {len(deltas)} deltas since version {request.last_server_version} (next cursor {cursor})"
+            )
 
         print(
             f"Sync processed for client {request.client_id}. New version: {new_version}"
@@ -178,7 +438,7 @@ def process_sync(request):
 
         conn.commit()
 
-        return new_version, deltas
+        return new_version, deltas, cursor, manifest
 
     except Exception as e:
         conn.rollback()
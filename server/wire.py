@@ -0,0 +1,98 @@
+"""Binary (CBOR) form of sync pages, matching client/src/database/synccodec.h.
+
+A page has the same top-level keys as the JSON one, except that "entries" is a list of blocks,
+one per run of consecutive entries from the same table: [table, [field names], [rows]]. Each
+row lists its values in field order, with CBOR undefined for a field the entry lacks. Canonical
+UUIDs in "uuid" / "*_uuid" fields travel as 16-byte strings.
+"""
+
+import uuid
+import zlib
+
+import cbor2
+
+CBOR_CONTENT_TYPE = "application/cbor"
+
+
+def is_uuid_field(field):
+    return field == "uuid" or field.endswith("_uuid")
+
+
+def encode_value(field, value):
+    if isinstance(value, str) and is_uuid_field(field):
+        try:
+            parsed = uuid.UUID(value)
+        except ValueError:
+            return value
+        if str(parsed) == value:
+            return parsed.bytes
+    return value
+
+
+def decode_value(value):
+    if isinstance(value, bytes) and len(value) == 16:
+        return str(uuid.UUID(bytes=value))
+    return value
+
+
+def encode_entries(entries):
+    blocks = []
+    for entry in entries:
+        if not blocks or blocks[-1][0] != entry["table"]:
+            blocks.append([entry["table"], [], []])
+        blocks[-1][2].append(entry["data"])
+
+    for block in blocks:
+        fields = []
+        for data in block[2]:
+            for k in data:
+                if k not in fields:
+                    fields.append(k)
+        block[1] = fields
+        block[2] = [
+            [
+                encode_value(f, data[f]) if f in data else cbor2.undefined
+                for f in fields
+            ]
+            for data in block[2]
+        ]
+    return blocks
+
+
+def decode_entries(blocks):
+    entries = []
+    for table, fields, rows in blocks:
+        for row in rows:
+            if len(row) != len(fields):
+                raise ValueError("row does not match its field list")
+            data = {
+                f: decode_value(v)
+                for f, v in zip(fields, row)
+                if v is not cbor2.undefined
+            }
+            entries.append({"table": table, "data": data})
+    return entries
+
+
+def encode_page(page):
+    out = dict(page)
+    out["entries"] = encode_entries(page["entries"])
+    return cbor2.dumps(out)
+
+
+def decode_page(body):
+    try:
+        page = cbor2.loads(body)
+    except cbor2.CBORDecodeError as e:
+        raise ValueError(f"bad CBOR: {e}")
+    if not isinstance(page, dict):
+        raise ValueError("page is not a map")
+    page["entries"] = decode_entries(page.get("entries", []))
+    return page
+
+
+def inflate(body):
+    try:
+        return zlib.decompress(body)
+    except zlib.error as e:
+        raise ValueError(f"bad deflate body: {e}")
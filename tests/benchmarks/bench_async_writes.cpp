@@ -0,0 +1,112 @@
+/** bench_async_writes.cpp
+ * Time the GUI thread spends per edit and per reload, with the database on the GUI thread
+ * (updateTask, loadAll) and on the repository's worker thread (updateTaskAsync, loadAllAsync),
+ * for a small and a large database under the durable storage profile. Checks the worker's
+ * writes all reached the database.
+ *
+ * Usage: bench_async_writes [small_count] [large_count] [edits]
+ */
+#include "bench_util.h"
+
+#include "calendarrepository.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Per-call latency plus the worst single call, which is what a user feels as a stall
+static void report_latency(const char *name, const std::vector<double> &seconds)
+{
+    double total = 0, worst = 0;
+    for (double s : seconds)
+    {
+        total += s;
+        worst = std::max(worst, s);
+    }
+    printf("  %-32s %10.1f us/call %10.1f us worst\n", name, seconds.empty() ? 0.0 : total * 1e6 / seconds.size(), worst * 1e6);
+}
+
+// Flip each task's priority through the given modifier, timing each call
+template <typename Update>
+static std::vector<double> edit_tasks(CalendarRepository &repo, const std::vector<UUID> &uuids, int round, Update update)
+{
+    std::vector<double> seconds;
+    for (size_t i = 0; i < uuids.size(); i++)
+    {
+        Task edited = *repo.findTaskByUuid(uuids[i]);
+        edited.priority = static_cast<Priority>((i + round) % 5);
+        BenchTimer t;
+        update(edited);
+        seconds.push_back(t.seconds());
+    }
+    return seconds;
+}
+
+int main(int argc, char **argv)
+{
+    const long sizes[] = {bench_arg(argc, argv, 1, 1000), bench_arg(argc, argv, 2, 100000)};
+    const long edits = bench_arg(argc, argv, 3, 200);
+
+    bench_silence_logs();
+    QCoreApplication app(argc, argv);
+
+    printf("Async write benchmark (durable profile, %ld edits; GUI thread time)\n", edits);
+    for (long taskCount : sizes)
+    {
+        if (!bench_build_fixture(taskCount))
+            return 1;
+        printf("%ld tasks\n", taskCount);
+
+        BenchTimer loadTimer;
+        CalendarRepository repo(StorageProfile::preset("durable")); // runs loadAll
+        printf("  %-32s %10.1f ms\n", "loadAll", loadTimer.seconds() * 1e3);
+
+        std::vector<UUID> uuids;
+        for (auto &[uuid, taskPtr] : repo.tasks())
+        {
+            uuids.push_back(uuid);
+            if ((long)uuids.size() == edits)
+                break;
+        }
+
+        report_latency("updateTask", edit_tasks(repo, uuids, 1, [&repo](const Task &t)
+                                                { repo.updateTask(t); }));
+        report_latency("updateTaskAsync", edit_tasks(repo, uuids, 2, [&repo](const Task &t)
+                                                     { repo.updateTaskAsync(t); }));
+        BenchTimer drainTimer;
+        repo.waitForWorker();
+        printf("  %-32s %10.1f ms (worker thread)\n", "queued writes drained", drainTimer.seconds() * 1e3);
+
+        if (!bench_database_matches(repo))
+        {
+            printf("Database does not match memory after the queued writes\n");
+            return 1;
+        }
+
+        // The GUI thread only pays for queueing the read and swapping the snapshot in
+        bool loaded = false;
+        QObject::connect(&repo, &CalendarRepository::modelChanged, &repo, [&loaded]()
+                         { loaded = true; });
+        BenchTimer asyncTimer;
+        BenchTimer callTimer;
+        repo.loadAllAsync();
+        double guiSeconds = callTimer.seconds();
+        repo.waitForWorker(); // Snapshot read and posted back
+        BenchTimer applyTimer;
+        while (!loaded)
+            QCoreApplication::processEvents();
+        guiSeconds += applyTimer.seconds();
+        printf("  %-32s %10.1f ms (%.1f ms on the GUI thread)\n", "loadAllAsync", asyncTimer.seconds() * 1e3, guiSeconds * 1e3);
+
+        if (repo.tasks().size() != (size_t)taskCount)
+        {
+            printf("loadAllAsync loaded %zu tasks, expected %ld\n", repo.tasks().size(), taskCount);
+            return 1;
+        }
+    }
+
+    bench_remove_db_files();
+    return 0;
+}
@@ -0,0 +1,142 @@
+/** bench_bulk_load.cpp
+ * Startup relational loading: per-task link and habit preview queries (1 + T + H round trips)
+ * against the bulk load_entry_links / load_habit_entries_in_window path joined in memory.
+ * Both paths must produce the same prerequisites and habit previews.
+ *
+ * Usage: bench_bulk_load [task_count]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char *DB_PATH = "bench_bulk_load.db";
+static const int PREVIEW_DAYS = sizeof(Task::completed_days) / sizeof(Task::completed_days[0]);
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 5000);
+
+    bench_silence_logs();
+    remove(DB_PATH);
+
+    char today[11];
+    time_t now = time(nullptr);
+    struct tm local_tm = *localtime(&now);
+    strftime(today, sizeof(today), "%Y-%m-%d", &local_tm);
+
+    try
+    {
+        Database db(DB_PATH);
+        TaskHash tasks;
+
+        // --- Fixture: every third task is a habit with entries on alternate days; tasks are
+        // chained by dependency links ---
+        {
+            Database::Batch batch(db);
+            Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+            db.insert_timeblock(tb);
+
+            std::vector<UUID> uuids;
+            for (long i = 0; i < taskCount; i++)
+            {
+                Task task("Task", "Benchmark task", Priority::MEDIUM, now + i * 60);
+                task.set_timeblock_uuid(tb.uuid);
+                if (i % 3 == 0)
+                    task.status = TaskStatus::HABIT;
+                db.insert_task(task);
+                uuids.push_back(task.uuid);
+
+                if (i % 3 == 0)
+                {
+                    for (int d = i % 2; d < PREVIEW_DAYS + 5; d += 2)
+                    {
+                        time_t day = now - d * 86400;
+                        struct tm day_tm = *localtime(&day);
+                        char date[11];
+                        strftime(date, sizeof(date), "%Y-%m-%d", &day_tm);
+                        db.add_habit_entry(task.uuid, date);
+                    }
+                }
+                if (i > 0)
+                    db.add_entry_link(uuids[i], uuids[i - 1], LinkType::DEPENDENCY);
+            }
+            batch.commit();
+        }
+        db.load_tasks(tasks);
+
+        printf("Bulk load benchmark (%ld tasks)\n", taskCount);
+
+        // --- Per-task queries ---
+        std::vector<size_t> perTaskLinks;
+        std::vector<std::string> perTaskPreview;
+        {
+            BenchTimer t;
+            for (auto &[uuid, task] : tasks)
+            {
+                std::vector<UUID> linked;
+                db.get_linked_entries(uuid, LinkType::DEPENDENCY, linked);
+                perTaskLinks.push_back(linked.size());
+
+                if (task->status == TaskStatus::HABIT)
+                {
+                    db.load_habit_completion_preview(*task, today);
+                    perTaskPreview.emplace_back(reinterpret_cast<const char *>(task->completed_days), sizeof(task->completed_days));
+                }
+            }
+            bench_report("per-task queries", taskCount, t.seconds());
+        }
+
+        // --- Bulk queries joined in memory ---
+        std::vector<size_t> bulkLinks;
+        std::vector<std::string> bulkPreview;
+        {
+            BenchTimer t;
+            std::unordered_map<UUID, size_t> linkCounts;
+            std::vector<std::pair<UUID, UUID>> links;
+            db.load_entry_links(LinkType::DEPENDENCY, links);
+            for (const auto &link : links)
+                linkCounts[link.first]++;
+
+            for (auto &[uuid, task] : tasks)
+            {
+                if (task->status == TaskStatus::HABIT)
+                    for (TaskStatus &day : task->completed_days)
+                        day = TaskStatus::INCOMPLETE;
+            }
+            std::vector<std::pair<UUID, int>> entries;
+            db.load_habit_entries_in_window(today, PREVIEW_DAYS, entries);
+            for (const auto &[uuid, offset] : entries)
+            {
+                auto it = tasks.find(uuid);
+                if (it != tasks.end() && offset >= 0 && offset < PREVIEW_DAYS)
+                    it->second->completed_days[offset] = TaskStatus::COMPLETE;
+            }
+
+            for (auto &[uuid, task] : tasks)
+            {
+                bulkLinks.push_back(linkCounts[uuid]);
+                if (task->status == TaskStatus::HABIT)
+                    bulkPreview.emplace_back(reinterpret_cast<const char *>(task->completed_days), sizeof(task->completed_days));
+            }
+            bench_report("bulk queries", taskCount, t.seconds());
+        }
+
+        if (perTaskLinks != bulkLinks || perTaskPreview != bulkPreview)
+        {
+            printf("Bulk load results differ from per-task queries\n");
+            return 1;
+        }
+    }
+    catch (int err)
+    {
+        printf("Benchmark failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    remove(DB_PATH);
+    return 0;
+}
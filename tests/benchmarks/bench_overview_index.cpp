@@ -0,0 +1,187 @@
+/** bench_overview_index.cpp
+ * Overview queries: scanning every Task and sorting by urgency / completion time, as
+ * OverviewView used to, against the repository's topUrgentTasks and tasksCompletedSince
+ * scans over its hot task table, and the cost of re-scoring the table after a weights change.
+ * Checks both return the same tasks before and after a round of edits.
+ *
+ * Usage: bench_overview_index [task_count] [queries]
+ */
+#include "bench_util.h"
+
+#include "calendarrepository.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define TOP_COUNT 5
+
+// Urgencies of the top tasks and the completed-since set, by the previous full scan
+static void scan_overview(CalendarRepository &repo, time_t since, std::vector<float> &top, std::vector<Task *> &completed)
+{
+    std::vector<std::pair<float, Task *>> ranked;
+    for (auto &[uuid, taskPtr] : repo.tasks())
+    {
+        if (taskPtr->status == TaskStatus::INCOMPLETE || taskPtr->status == TaskStatus::HABIT)
+            ranked.emplace_back(taskPtr->get_urgency(), taskPtr.get());
+        else if (taskPtr->status == TaskStatus::COMPLETE && taskPtr->completed_datetime >= since)
+            completed.push_back(taskPtr.get());
+    }
+    size_t topCount = std::min(ranked.size(), (size_t)TOP_COUNT);
+    std::partial_sort(ranked.begin(), ranked.begin() + topCount, ranked.end(),
+                      [](const std::pair<float, Task *> &a, const std::pair<float, Task *> &b)
+                      { return a.first > b.first; });
+    for (size_t i = 0; i < topCount; i++)
+        top.push_back(ranked[i].first);
+    std::sort(completed.begin(), completed.end(), [](const Task *a, const Task *b)
+              { return a->completed_datetime > b->completed_datetime; });
+}
+
+static bool table_matches(CalendarRepository &repo, time_t since)
+{
+    std::vector<float> scanTop;
+    std::vector<Task *> scanCompleted;
+    scan_overview(repo, since, scanTop, scanCompleted);
+
+    std::vector<Task *> top, completed;
+    repo.topUrgentTasks(TOP_COUNT, top);
+    repo.tasksCompletedSince(since, completed);
+
+    // Ties may be ordered differently, so compare urgencies and completion times
+    std::vector<float> tableTop;
+    for (Task *t : top)
+        tableTop.push_back(t->get_urgency());
+    if (tableTop != scanTop || completed.size() != scanCompleted.size())
+        return false;
+    for (size_t i = 0; i < completed.size(); i++)
+    {
+        if (completed[i]->completed_datetime != scanCompleted[i]->completed_datetime)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 50000);
+    const long queries = bench_arg(argc, argv, 2, 200);
+
+    bench_silence_logs();
+    bench_remove_db_files();
+
+    time_t now = time(nullptr);
+    const time_t since = now - 6 * 3600;
+
+    // --- Fixture: mixed priorities and due dates, a fifth completed over the last two days ---
+    try
+    {
+        Database db;
+        Database::Batch batch(db);
+        Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+        db.insert_timeblock(tb);
+        for (long i = 0; i < taskCount; i++)
+        {
+            Task task("Task", "Benchmark task", static_cast<Priority>(i % 6), now + ((i * 7919) % 1000) * 3600);
+            task.set_timeblock_uuid(tb.uuid);
+            if (i % 5 == 0)
+            {
+                task.status = TaskStatus::COMPLETE;
+                task.completed_datetime = now - (i % 48) * 3600;
+            }
+            db.insert_task(task);
+        }
+        batch.commit();
+    }
+    catch (int err)
+    {
+        printf("Fixture failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    QCoreApplication app(argc, argv);
+    printf("Overview index benchmark (%ld tasks, top %d)\n", taskCount, TOP_COUNT);
+
+    CalendarRepository repo; // runs loadAll and fills the task table
+
+    {
+        BenchTimer t;
+        for (long i = 0; i < queries; i++)
+        {
+            std::vector<float> top;
+            std::vector<Task *> completed;
+            scan_overview(repo, since, top, completed);
+        }
+        bench_report("scan + sort", queries, t.seconds());
+    }
+    {
+        BenchTimer t;
+        for (long i = 0; i < queries; i++)
+        {
+            std::vector<Task *> top, completed;
+            repo.topUrgentTasks(TOP_COUNT, top);
+            repo.tasksCompletedSince(since, completed);
+        }
+        bench_report("task table scan", queries, t.seconds());
+    }
+    {
+        // Every query after a weights change re-scores the whole table first
+        BenchTimer t;
+        for (long i = 0; i < queries; i++)
+        {
+            g_score_weights_generation++;
+            std::vector<Task *> top;
+            repo.topUrgentTasks(TOP_COUNT, top);
+        }
+        bench_report("re-score + task table scan", queries, t.seconds());
+    }
+
+    if (!table_matches(repo, since))
+    {
+        printf("Task table disagrees with a full scan after loadAll\n");
+        return 1;
+    }
+
+    // --- Edits go through the modifiers and must keep the task table in step ---
+    std::vector<UUID> uuids;
+    for (auto &[uuid, taskPtr] : repo.tasks())
+    {
+        uuids.push_back(uuid);
+        if (uuids.size() == 300)
+            break;
+    }
+    BenchTimer editTimer;
+    for (size_t i = 0; i < uuids.size(); i++)
+    {
+        Task edited = *repo.findTaskByUuid(uuids[i]);
+        if (i % 3 == 0)
+        {
+            edited.status = TaskStatus::COMPLETE;
+            edited.completed_datetime = now - i;
+        }
+        else if (i % 3 == 1)
+        {
+            edited.status = TaskStatus::INCOMPLETE;
+            edited.priority = Priority::VERY_HIGH;
+            edited.due_date = now + 60;
+        }
+        else
+        {
+            edited.priority = Priority::NONE;
+        }
+        repo.updateTask(edited);
+    }
+    for (size_t i = 0; i < uuids.size(); i += 10)
+        repo.removeTask(uuids[i]);
+    bench_report("updateTask / removeTask", uuids.size() + uuids.size() / 10, editTimer.seconds());
+
+    if (!table_matches(repo, since))
+    {
+        printf("Task table disagrees with a full scan after edits\n");
+        return 1;
+    }
+
+    bench_remove_db_files();
+    return 0;
+}
@@ -0,0 +1,104 @@
+/** bench_receipt_ack.cpp
+ * Receipt bookkeeping for acknowledged sync: the cost of stamping each receipt with a sequence
+ * number (task updates with receipts), and pruning an acknowledged range through the seq index
+ * while edits made after the acknowledged position stay queued. Checks exactly those survive.
+ *
+ * Usage: bench_receipt_ack [task_count] [late_edits]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static const char *DB_PATH = "bench_receipt_ack.db";
+
+// Read through a separate connection, after the Database under test is closed
+static long count_receipts()
+{
+    sqlite3 *db = nullptr;
+    long n = -1;
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_open(DB_PATH, &db) == SQLITE_OK &&
+        sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM task_change_receipts;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+        n = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 20000);
+    const long lateEdits = bench_arg(argc, argv, 2, 1000);
+
+    bench_silence_logs();
+    bench_remove_db_files(DB_PATH);
+    printf("Receipt acknowledgement benchmark (%ld tasks, %ld edits after the acknowledged position)\n", taskCount, lateEdits);
+
+    try
+    {
+        Database db(DB_PATH);
+        std::vector<Task> tasks;
+        {
+            Database::Batch batch(db);
+            Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+            db.insert_timeblock(tb);
+            time_t now = time(nullptr);
+            for (long i = 0; i < taskCount; i++)
+            {
+                Task task("Task", "Benchmark task", static_cast<Priority>(i % 5), now + (i % 500) * 3600);
+                task.set_timeblock_uuid(tb.uuid);
+                db.insert_task(task);
+                tasks.push_back(std::move(task));
+            }
+            batch.commit();
+        }
+
+        {
+            BenchTimer t;
+            Database::Batch batch(db);
+            for (Task &task : tasks)
+            {
+                task.priority = Priority::HIGH;
+                db.update_task(task);
+            }
+            batch.commit();
+            bench_report("update_task (seq-stamped receipt)", taskCount, t.seconds());
+        }
+
+        // The server acknowledges everything up to here; later edits land before the reply does
+        sqlite3_int64 acked = db.receipt_seq();
+        for (long i = 0; i < lateEdits && i < taskCount; i++)
+        {
+            tasks[i].priority = Priority::LOW;
+            db.update_task(tasks[i]);
+        }
+
+        BenchTimer t;
+        {
+            Database::Batch batch(db);
+            db.prune_receipts(acked);
+            batch.commit();
+        }
+        bench_report("prune_receipts (acknowledged range)", 1, t.seconds());
+    }
+    catch (int err)
+    {
+        printf("Failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    long left = count_receipts();
+    if (left != std::min(lateEdits, taskCount))
+    {
+        printf("%ld receipts left after pruning, expected the %ld late edits\n", left, std::min(lateEdits, taskCount));
+        return 1;
+    }
+
+    bench_remove_db_files(DB_PATH);
+    return 0;
+}
@@ -0,0 +1,199 @@
+/** bench_statement_cache.cpp
+ * Per-call latency of the hot Database calls with the prepared statement cache, compared
+ * against the previous behaviour of preparing and finalizing the same SQL on every call. Each
+ * update_task call moves the task's due date, since update_task skips rows that did not change.
+ *
+ * Usage: bench_statement_cache [read_calls] [write_calls]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char *DB_PATH = "bench_statement_cache.db";
+
+/* -------------------------------------------------------------------------- */
+/*                   Baseline: prepare + finalize on every call                */
+/* -------------------------------------------------------------------------- */
+
+static bool uncached_habit_entry_exists(sqlite3 *db, const UUID &task_uuid, const char *date)
+{
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM habit_entries WHERE task_uuid = ? AND date = ?;", -1, &stmt, 0) != SQLITE_OK)
+        return false;
+    bind_uuid(stmt, 1, task_uuid);
+    sqlite3_bind_text(stmt, 2, date, -1, SQLITE_STATIC);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+static void uncached_get_linked_entries(sqlite3 *db, const UUID &uuid, std::vector<UUID> &out)
+{
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT child_uuid FROM entry_links WHERE parent_uuid = ? AND link_type = ?;", -1, &stmt, 0) != SQLITE_OK)
+        return;
+    bind_uuid(stmt, 1, uuid);
+    sqlite3_bind_int(stmt, 2, static_cast<int>(LinkType::DEPENDENCY));
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+        out.push_back(column_uuid(stmt, 0));
+    sqlite3_finalize(stmt);
+}
+
+static void uncached_update_task(sqlite3 *db, const Task &task)
+{
+    sqlite3_stmt *stmt;
+    const char *sql = "UPDATE tasks SET timeblock_uuid = ?, name = ?, description = ?, due_date = ?, priority = ?, scope = ?, status = ?, goal_spec = ?, completed_datetime = ? WHERE uuid = ?;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK)
+        return;
+    bind_uuid(stmt, 1, task.timeblock_uuid);
+    sqlite3_bind_text(stmt, 2, task.name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, task.desc, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, task.due_date);
+    sqlite3_bind_int(stmt, 5, static_cast<int>(task.priority));
+    sqlite3_bind_int(stmt, 6, static_cast<int>(task.scope));
+    sqlite3_bind_int(stmt, 7, static_cast<int>(task.status));
+    sqlite3_bind_int(stmt, 8, task.goal_spec.to_sql());
+    sqlite3_bind_int64(stmt, 9, task.completed_datetime);
+    bind_uuid(stmt, 10, task.uuid);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    // Receipt write, mirroring Database::record_task_receipt
+    sql = "INSERT OR REPLACE INTO task_change_receipts "
+          "(uuid, timeblock_uuid, name, description, due_date, priority, scope, status, goal_spec, completed_datetime, modified_at, deleted_at) "
+          "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+        return;
+    bind_uuid(stmt, 1, task.uuid);
+    bind_uuid(stmt, 2, task.timeblock_uuid);
+    sqlite3_bind_text(stmt, 3, task.name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, task.desc, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 5, task.due_date);
+    sqlite3_bind_int(stmt, 6, static_cast<int>(task.priority));
+    sqlite3_bind_int(stmt, 7, static_cast<int>(task.scope));
+    sqlite3_bind_int(stmt, 8, static_cast<int>(task.status));
+    sqlite3_bind_int(stmt, 9, task.goal_spec.to_sql());
+    sqlite3_bind_int64(stmt, 10, task.completed_datetime);
+    sqlite3_bind_int64(stmt, 11, time(nullptr));
+    sqlite3_bind_null(stmt, 12);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Main                                    */
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    const long readCalls = bench_arg(argc, argv, 1, 20000);
+    const long writeCalls = bench_arg(argc, argv, 2, 200);
+    const int taskCount = 256;
+
+    bench_silence_logs();
+    remove(DB_PATH);
+
+    try
+    {
+        Database db(DB_PATH);
+
+        // --- Fixture: one timeblock, a chain of linked tasks, one habit entry per task ---
+        Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+        db.insert_timeblock(tb);
+
+        std::vector<Task> tasks;
+        tasks.reserve(taskCount);
+        for (int i = 0; i < taskCount; i++)
+        {
+            tasks.emplace_back("Task", "Benchmark task", Priority::MEDIUM, time(nullptr) + i * 3600);
+            tasks.back().set_timeblock_uuid(tb.uuid);
+            db.insert_task(tasks.back());
+            db.add_habit_entry(tasks.back().uuid, "2026-01-01");
+            if (i > 0)
+                db.add_entry_link(tasks[i].uuid, tasks[i - 1].uuid, LinkType::DEPENDENCY);
+        }
+
+        // Second connection for the uncached baseline
+        sqlite3 *raw = nullptr;
+        if (sqlite3_open(DB_PATH, &raw) != SQLITE_OK)
+        {
+            printf("Failed to open baseline connection\n");
+            return 1;
+        }
+
+        printf("Statement cache benchmark (%d tasks)\n", taskCount);
+        std::vector<UUID> linked;
+        long found = 0;
+
+        // --- habit_entry_exists ---
+        {
+            BenchTimer t;
+            for (long i = 0; i < readCalls; i++)
+                found += uncached_habit_entry_exists(raw, tasks[i % taskCount].uuid, "2026-01-01");
+            bench_report("habit_entry_exists (prepare per call)", readCalls, t.seconds());
+        }
+        {
+            BenchTimer t;
+            for (long i = 0; i < readCalls; i++)
+                found += db.habit_entry_exists(tasks[i % taskCount].uuid, "2026-01-01");
+            bench_report("habit_entry_exists (cached)", readCalls, t.seconds());
+        }
+
+        // --- get_linked_entries ---
+        {
+            BenchTimer t;
+            for (long i = 0; i < readCalls; i++)
+            {
+                uncached_get_linked_entries(raw, tasks[i % taskCount].uuid, linked);
+                linked.clear();
+            }
+            bench_report("get_linked_entries (prepare per call)", readCalls, t.seconds());
+        }
+        {
+            BenchTimer t;
+            for (long i = 0; i < readCalls; i++)
+            {
+                db.get_linked_entries(tasks[i % taskCount].uuid, LinkType::DEPENDENCY, linked);
+                linked.clear();
+            }
+            bench_report("get_linked_entries (cached)", readCalls, t.seconds());
+        }
+
+        // --- update_task (task row + receipt) ---
+        {
+            BenchTimer t;
+            for (long i = 0; i < writeCalls; i++)
+            {
+                Task &task = tasks[i % taskCount];
+                task.due_date += i + 1;
+                uncached_update_task(raw, task);
+            }
+            bench_report("update_task (prepare per call)", writeCalls, t.seconds());
+        }
+        {
+            BenchTimer t;
+            for (long i = 0; i < writeCalls; i++)
+            {
+                Task &task = tasks[i % taskCount];
+                task.due_date += i + 1;
+                db.update_task(task);
+            }
+            bench_report("update_task (cached)", writeCalls, t.seconds());
+        }
+
+        sqlite3_close(raw);
+        printf("(%ld lookups hit)\n", found);
+    }
+    catch (int err)
+    {
+        printf("Benchmark failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    remove(DB_PATH);
+    return 0;
+}
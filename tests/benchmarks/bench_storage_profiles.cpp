@@ -0,0 +1,99 @@
+/** bench_storage_profiles.cpp
+ * Write latency of each StorageProfile preset on a large database, next to SQLite's defaults
+ * (rollback journal, synchronous=FULL) that the client used before profiles existed.
+ *
+ * Usage: bench_storage_profiles [task_count] [write_calls]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+
+#include <string>
+#include <vector>
+
+static const char *DB_PATH = "bench_storage_profiles.db";
+
+static void run_profile(const char *label, const StorageProfile &profile, long taskCount, long writeCalls)
+{
+    bench_remove_db_files(DB_PATH);
+    Database db(DB_PATH, profile);
+
+    // --- Fixture: one timeblock holding taskCount tasks, written in a single batch ---
+    Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+    db.insert_timeblock(tb);
+
+    std::vector<Task> tasks;
+    tasks.reserve(taskCount + writeCalls);
+    {
+        Database::Batch batch(db);
+        for (long i = 0; i < taskCount; i++)
+        {
+            tasks.emplace_back("Task", "Benchmark task", Priority::MEDIUM, time(nullptr) + i * 60);
+            tasks.back().set_timeblock_uuid(tb.uuid);
+            db.insert_task(tasks.back());
+        }
+        batch.commit();
+    }
+
+    printf("%s\n", label);
+
+    // --- One commit per call, as the UI does ---
+    {
+        BenchTimer t;
+        for (long i = 0; i < writeCalls; i++)
+        {
+            Task &task = tasks[(i * 7919) % taskCount]; // spread updates over the table
+            task.priority = static_cast<Priority>(i % 5);
+            db.update_task(task);
+        }
+        bench_report("  update_task", writeCalls, t.seconds());
+    }
+    {
+        BenchTimer t;
+        for (long i = 0; i < writeCalls; i++)
+        {
+            tasks.emplace_back("New task", "Inserted during benchmark", Priority::LOW, time(nullptr));
+            tasks.back().set_timeblock_uuid(tb.uuid);
+            db.insert_task(tasks.back());
+        }
+        bench_report("  insert_task", writeCalls, t.seconds());
+    }
+    {
+        BenchTimer t;
+        for (long i = 0; i < writeCalls; i++)
+            db.delete_task(tasks[taskCount + i].uuid);
+        bench_report("  delete_task", writeCalls, t.seconds());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 20000);
+    const long writeCalls = bench_arg(argc, argv, 2, 200);
+
+    bench_silence_logs();
+
+    StorageProfile legacy;
+    legacy.journal_mode = "DELETE";
+    legacy.synchronous = "FULL";
+    legacy.cache_size = -2000;
+    legacy.mmap_size = 0;
+    legacy.temp_store = "DEFAULT";
+
+    printf("Storage profile benchmark (%ld tasks, %ld writes per operation)\n", taskCount, writeCalls);
+    try
+    {
+        run_profile("sqlite defaults (DELETE, FULL)", legacy, taskCount, writeCalls);
+        run_profile("durable", StorageProfile::preset("durable"), taskCount, writeCalls);
+        run_profile("balanced", StorageProfile::preset("balanced"), taskCount, writeCalls);
+        run_profile("fast", StorageProfile::preset("fast"), taskCount, writeCalls);
+    }
+    catch (int err)
+    {
+        printf("Benchmark failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    bench_remove_db_files(DB_PATH);
+    return 0;
+}
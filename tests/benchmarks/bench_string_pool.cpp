@@ -0,0 +1,153 @@
+/** bench_string_pool.cpp
+ * Heap allocations made while loading and copying tasks, now that names and descriptions are
+ * interned in StringPool::global(), against the previous strdup of both strings per row and
+ * per copy. Allocations are counted by wrapping malloc, which operator new also goes through,
+ * so the load figures include SQLite's and the task map's own allocations (a map node and
+ * the Task per row).
+ *
+ * Usage: bench_string_pool [task_count]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+#include "stringpool.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char *DB_PATH = "bench_string_pool.db";
+static const int TIMEBLOCK_COUNT = 50;
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+
+static std::atomic<long> g_mallocs{0};
+
+extern "C" void *malloc(size_t size)
+{
+    g_mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+#else
+static std::atomic<long> g_mallocs{-1}; // Not counted
+#endif
+
+// Allocations made by fn, per row
+template <typename Fn>
+static void report_allocations(const char *name, long rows, Fn fn)
+{
+    long before = g_mallocs.load();
+    BenchTimer t;
+    fn();
+    double seconds = t.seconds();
+    long made = g_mallocs.load() - before;
+    bench_report(name, rows, seconds);
+    if (before >= 0)
+        printf("%-40s %10ld allocs %10.2f allocs/row\n", "", made, rows ? (double)made / rows : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 20000);
+
+    bench_silence_logs();
+    remove(DB_PATH);
+
+    try
+    {
+        Database db(DB_PATH);
+
+        // --- Fixture: distinct task names, descriptions shared between tasks as notes often are ---
+        {
+            Database::Batch batch(db);
+            std::vector<UUID> timeblockUuids;
+            for (int i = 0; i < TIMEBLOCK_COUNT; i++)
+            {
+                std::string name = "Timeblock " + std::to_string(i);
+                Timeblock tb(name.c_str(), "Benchmark timeblock", 0, 3600, 0);
+                db.insert_timeblock(tb);
+                timeblockUuids.push_back(tb.uuid);
+            }
+            for (long i = 0; i < taskCount; i++)
+            {
+                std::string name = "Task " + std::to_string(i);
+                std::string desc = "Notes " + std::to_string(i % 100);
+                Task task(name.c_str(), desc.c_str(), Priority::MEDIUM, time(nullptr) + i * 60);
+                task.set_timeblock_uuid(timeblockUuids[i % TIMEBLOCK_COUNT]);
+                db.insert_task(task);
+            }
+            batch.commit();
+        }
+
+        printf("String pool benchmark (%ld tasks, %d timeblocks)\n", taskCount, TIMEBLOCK_COUNT);
+        const long rows = taskCount + TIMEBLOCK_COUNT;
+        TaskHash tasks;
+        std::vector<Timeblock> timeblocks;
+
+        // --- Loading: a string already interned costs a lookup, a new one a bump allocation ---
+        report_allocations("load_timeblocks + load_tasks", rows, [&]()
+                           {
+            db.load_timeblocks(timeblocks);
+            db.load_tasks(tasks); });
+
+        TaskHash reloaded;
+        std::vector<Timeblock> reloadedTimeblocks;
+        report_allocations("reload (same rows)", rows, [&]()
+                           {
+            db.load_timeblocks(reloadedTimeblocks);
+            db.load_tasks(reloaded); });
+
+        for (const auto &[uuid, task] : tasks)
+        {
+            auto it = reloaded.find(uuid);
+            if (it == reloaded.end() || it->second->name != task->name || it->second->desc != task->desc)
+            {
+                printf("Reloaded task <%s> does not share its interned strings\n", uuid.text().c_str());
+                return 1;
+            }
+        }
+
+        std::vector<const char *> names;
+        names.reserve(2 * taskCount);
+        report_allocations("strdup name + desc per row (previous)", taskCount, [&]()
+                           {
+            for (const auto &[uuid, task] : tasks)
+            {
+                names.push_back(strdup(task->name));
+                names.push_back(strdup(task->desc));
+            } });
+        for (const char *name : names)
+            free(const_cast<char *>(name));
+
+        // --- Snapshot copy: a Task copy only copies the string pointers ---
+        std::vector<Task> snapshot;
+        snapshot.reserve(taskCount);
+        report_allocations("copy tasks into a snapshot", taskCount, [&]()
+                           {
+            for (const auto &[uuid, task] : tasks)
+                snapshot.push_back(*task); });
+
+        for (const Task &copy : snapshot)
+        {
+            const Task &task = *tasks[copy.uuid];
+            if (copy.name != task.name || strcmp(copy.desc, task.desc) != 0)
+            {
+                printf("Snapshot copy of <%s> differs\n", copy.uuid.text().c_str());
+                return 1;
+            }
+        }
+
+        StringPool::Stats stats = StringPool::global().stats();
+        printf("pool: %zu strings, %zu bytes in %zu blocks\n", stats.strings, stats.bytes, stats.blocks);
+    }
+    catch (int err)
+    {
+        printf("Benchmark failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    remove(DB_PATH);
+    return 0;
+}
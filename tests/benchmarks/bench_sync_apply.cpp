@@ -0,0 +1,125 @@
+/** bench_sync_apply.cpp
+ * Writing a page of server changes: the previous per-entry upsert_task / add_habit_entry calls
+ * (a savepoint and an echo receipt per entry) inside one batch, against the apply_server_*
+ * calls Synchronizer now uses. Checks both leave the same rows and that the new path records
+ * no receipts.
+ *
+ * Usage: bench_sync_apply [entry_count]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+
+#include <string>
+#include <vector>
+
+static const char *DB_PATH = "bench_sync_apply.db";
+
+// A server page: every task once, then a habit entry for every fifth
+struct Page
+{
+    Timeblock timeblock;
+    std::vector<Task> tasks;
+    std::vector<UUID> habitTasks;
+};
+
+static Page make_page(long entryCount)
+{
+    Page page{Timeblock("Bench", "Benchmark timeblock", 0, 3600, 0), {}, {}};
+    time_t now = time(nullptr);
+    for (long i = 0; i < entryCount; i++)
+    {
+        Task task("Task", "Benchmark task", static_cast<Priority>(i % 5), now + (i % 500) * 3600);
+        task.set_timeblock_uuid(page.timeblock.uuid);
+        if (i % 5 == 0)
+            page.habitTasks.push_back(task.uuid);
+        page.tasks.push_back(std::move(task));
+    }
+    return page;
+}
+
+// Read through a separate connection, after the Database under test is closed
+static long count_rows(const char *table)
+{
+    sqlite3 *db = nullptr;
+    long n = -1;
+    sqlite3_stmt *stmt = nullptr;
+    std::string sql = std::string("SELECT COUNT(*) FROM ") + table + ";";
+    if (sqlite3_open(DB_PATH, &db) == SQLITE_OK && sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+        n = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return n;
+}
+
+static bool rows_match(const Page &page)
+{
+    return count_rows("tasks") == (long)page.tasks.size() && count_rows("habit_entries") == (long)page.habitTasks.size();
+}
+
+int main(int argc, char **argv)
+{
+    const long entryCount = bench_arg(argc, argv, 1, 20000);
+
+    bench_silence_logs();
+    Page page = make_page(entryCount);
+    const long writes = page.tasks.size() + page.habitTasks.size();
+
+    printf("Sync apply benchmark (%ld tasks, %zu habit entries, one batch)\n", entryCount, page.habitTasks.size());
+
+    try
+    {
+        bench_remove_db_files(DB_PATH);
+        {
+            Database db(DB_PATH);
+            BenchTimer t;
+            Database::Batch batch(db);
+            db.upsert_timeblock(page.timeblock);
+            for (const Task &task : page.tasks)
+                db.upsert_task(task);
+            for (const UUID &uuid : page.habitTasks)
+                db.add_habit_entry(uuid, "2026-10-17");
+            batch.commit();
+            bench_report("upsert_* per entry", writes, t.seconds());
+        }
+        if (!rows_match(page))
+        {
+            printf("Per-entry upserts left the wrong rows\n");
+            return 1;
+        }
+
+        bench_remove_db_files(DB_PATH);
+        {
+            Database db(DB_PATH);
+            BenchTimer t;
+            Database::Batch batch(db);
+            db.apply_server_timeblock(page.timeblock);
+            for (const Task &task : page.tasks)
+                db.apply_server_task(task);
+            for (const UUID &uuid : page.habitTasks)
+                db.apply_server_habit_entry(uuid, "2026-10-17", false);
+            batch.commit();
+            bench_report("apply_server_*", writes, t.seconds());
+        }
+        if (!rows_match(page))
+        {
+            printf("Server apply left the wrong rows\n");
+            return 1;
+        }
+        if (count_rows("timeblock_change_receipts") != 0 || count_rows("task_change_receipts") != 0 ||
+            count_rows("habit_entry_change_receipts") != 0)
+        {
+            printf("Server apply recorded receipts\n");
+            return 1;
+        }
+    }
+    catch (int err)
+    {
+        printf("Failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    bench_remove_db_files(DB_PATH);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/** bench_sync_encoding.cpp
+ * Sync wire formats: payload bytes and encode / decode time for a large sync sent as pages of
+ * SYNC_PAGE_SIZE entries, in JSON, CBOR and deflated CBOR. The entries are a server reply's
+ * mix of tasks, habit entries and deletions. Checks every page decodes back to what was sent.
+ *
+ * Usage: bench_sync_encoding [entry_count]
+ */
+#include "bench_util.h"
+
+#include "database.h"
+#include "syncronize.h"
+#include "synccodec.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <vector>
+
+static QString new_uuid()
+{
+    char uuid[UUID_LEN];
+    generate_uuid(uuid);
+    return QString::fromLatin1(uuid);
+}
+
+// One page of a server reply, shaped like collect_delta_page's entries
+static QJsonObject make_page(long first, long count, const QString &timeblockUuid, qint64 now)
+{
+    QJsonArray entries;
+    for (long i = first; i < first + count; i++)
+    {
+        QJsonObject data;
+        QJsonObject entry;
+        if (i % 10 == 9)
+        {
+            data["task_uuid"] = new_uuid();
+            data["date"] = "2026-10-17";
+            data["modified_at"] = now - i;
+            data["server_version"] = (qint64)i + 1;
+            data["deleted"] = false;
+            entry["table"] = "habit_entries";
+        }
+        else
+        {
+            data["uuid"] = new_uuid();
+            data["modified_at"] = now - i;
+            data["server_version"] = (qint64)i + 1;
+            data["deleted"] = (i % 25 == 0);
+            if (i % 25 != 0)
+            {
+                data["timeblock_uuid"] = timeblockUuid;
+                data["name"] = QString("Task %1").arg(i);
+                data["description"] = "Benchmark task";
+                data["due_date"] = now + (i % 500) * 3600;
+                data["priority"] = (int)(i % 5);
+                data["scope"] = (int)(i % 3);
+                data["status"] = 0;
+                data["goal_spec"] = 0;
+                data["completed_datetime"] = QJsonValue::Null;
+            }
+            entry["table"] = "tasks";
+        }
+        entry["data"] = data;
+        entries.append(entry);
+    }
+
+    QJsonObject page;
+    page["new_server_version"] = (qint64)(first + count);
+    page["entries"] = entries;
+    page["cursor"] = QString("1:%1:%2").arg(first + count).arg(first + count + 1);
+    return page;
+}
+
+struct FormatResult
+{
+    long bytes = 0;
+    double encodeSeconds = 0;
+    double decodeSeconds = 0;
+    bool roundTrips = true;
+};
+
+static FormatResult run_format(const std::vector<QJsonObject> &pages, SyncEncoding encoding, bool deflated)
+{
+    FormatResult result;
+    for (const QJsonObject &page : pages)
+    {
+        BenchTimer encodeTimer;
+        QByteArray bytes = SyncCodec::encode(page, encoding);
+        if (deflated)
+            bytes = SyncCodec::deflate(bytes);
+        result.encodeSeconds += encodeTimer.seconds();
+        result.bytes += bytes.size();
+
+        if (deflated)
+        {
+            // qUncompress wants qCompress's length prefix back; zero means unknown
+            QByteArray prefixed(4, '\0');
+            prefixed.append(bytes);
+            BenchTimer inflateTimer;
+            bytes = qUncompress(prefixed);
+            result.decodeSeconds += inflateTimer.seconds();
+        }
+
+        QJsonObject decoded;
+        BenchTimer decodeTimer;
+        bool ok = SyncCodec::decode(bytes, encoding, decoded);
+        result.decodeSeconds += decodeTimer.seconds();
+        if (!ok || decoded != page)
+            result.roundTrips = false;
+    }
+    return result;
+}
+
+static void report(const char *name, const FormatResult &r, long jsonBytes, long entryCount)
+{
+    printf("  %-16s %12ld bytes %6.1f%% %8.1f B/entry %10.1f ms encode %10.1f ms decode\n",
+           name, r.bytes, jsonBytes ? 100.0 * r.bytes / jsonBytes : 100.0, (double)r.bytes / entryCount,
+           r.encodeSeconds * 1e3, r.decodeSeconds * 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    const long entryCount = bench_arg(argc, argv, 1, 100000);
+
+    bench_silence_logs();
+
+    qint64 now = time(nullptr);
+    QString timeblockUuid = new_uuid();
+    std::vector<QJsonObject> pages;
+    for (long first = 0; first < entryCount; first += SYNC_PAGE_SIZE)
+        pages.push_back(make_page(first, std::min<long>(SYNC_PAGE_SIZE, entryCount - first), timeblockUuid, now));
+
+    printf("Sync encoding benchmark (%ld entries in %zu pages of %d)\n", entryCount, pages.size(), SYNC_PAGE_SIZE);
+
+    FormatResult json = run_format(pages, SyncEncoding::JSON, false);
+    FormatResult cbor = run_format(pages, SyncEncoding::CBOR, false);
+    FormatResult deflated = run_format(pages, SyncEncoding::CBOR, true);
+
+    report("json", json, json.bytes, entryCount);
+    report("cbor", cbor, json.bytes, entryCount);
+    report("cbor + deflate", deflated, json.bytes, entryCount);
+
+    if (!json.roundTrips || !cbor.roundTrips || !deflated.roundTrips)
+    {
+        printf("A page did not decode back to what was encoded\n");
+        return 1;
+    }
+    return 0;
+}
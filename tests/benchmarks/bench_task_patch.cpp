@@ -0,0 +1,115 @@
+/** bench_task_patch.cpp
+ * Checkbox toggles through the repository: copying the task, changing its status and passing
+ * the copy to updateTask, against patchTask with only the status and completion time. Checks
+ * the database ends up with the statuses the in-memory model holds, and that the pending
+ * receipts only mark the columns a patch touched.
+ *
+ * Usage: bench_task_patch [task_count] [toggles]
+ */
+#include "bench_util.h"
+
+#include "calendarrepository.h"
+
+#include <QCoreApplication>
+
+#include <string>
+#include <vector>
+
+static TaskStatus toggled(TaskStatus status)
+{
+    return status == TaskStatus::COMPLETE ? TaskStatus::INCOMPLETE : TaskStatus::COMPLETE;
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 5000);
+    const long toggles = bench_arg(argc, argv, 2, 1000);
+
+    bench_silence_logs();
+    if (!bench_build_fixture(taskCount))
+        return 1;
+
+    QCoreApplication app(argc, argv);
+    printf("Task patch benchmark (%ld tasks, %ld toggles)\n", taskCount, toggles);
+
+    CalendarRepository repo;
+    std::vector<UUID> uuids;
+    for (auto &[uuid, taskPtr] : repo.tasks())
+        uuids.push_back(uuid);
+
+    {
+        BenchTimer t;
+        for (long i = 0; i < toggles; i++)
+        {
+            Task edited = *repo.findTaskByUuid(uuids[i % uuids.size()]);
+            edited.status = toggled(edited.status);
+            edited.completed_datetime = edited.status == TaskStatus::COMPLETE ? time(nullptr) : 0;
+            repo.updateTask(edited);
+        }
+        bench_report("copy + updateTask", toggles, t.seconds());
+    }
+    if (!bench_database_matches(repo))
+        return 1;
+
+    {
+        BenchTimer t;
+        for (long i = 0; i < toggles; i++)
+        {
+            const UUID &uuid = uuids[i % uuids.size()];
+            const TaskStatus status = toggled(repo.findTaskByUuid(uuid)->status);
+            repo.patchTask(uuid, TaskPatch().set_status(status).set_completed_datetime(status == TaskStatus::COMPLETE ? time(nullptr) : 0));
+        }
+        bench_report("patchTask", toggles, t.seconds());
+    }
+    if (!bench_database_matches(repo))
+        return 1;
+
+    {
+        BenchTimer t;
+        for (long i = 0; i < toggles; i++)
+        {
+            const UUID &uuid = uuids[i % uuids.size()];
+            const TaskStatus status = toggled(repo.findTaskByUuid(uuid)->status);
+            repo.patchTaskAsync(uuid, TaskPatch().set_status(status).set_completed_datetime(status == TaskStatus::COMPLETE ? time(nullptr) : 0));
+        }
+        bench_report("patchTaskAsync (GUI thread)", toggles, t.seconds());
+    }
+    if (!bench_database_matches(repo))
+        return 1;
+
+    // A status-only patch marks only the status column of its receipt
+    try
+    {
+        repo.waitForWorker();
+        Database db;
+        db.prune_receipts(db.receipt_seq());
+    }
+    catch (int err)
+    {
+        printf("Pruning receipts failed with SQLite error %d\n", err);
+        return 1;
+    }
+    const UUID &uuid = uuids[0];
+    repo.patchTask(uuid, TaskPatch().set_status(toggled(repo.findTaskByUuid(uuid)->status)));
+
+    sqlite3 *handle = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    long receipts = -1, changed = -1;
+    if (sqlite3_open(DATABASE_PATH, &handle) == SQLITE_OK &&
+        sqlite3_prepare_v2(handle, "SELECT COUNT(*), MAX(changed) FROM task_change_receipts;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        receipts = sqlite3_column_int64(stmt, 0);
+        changed = sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(handle);
+    if (receipts != 1 || changed != TaskPatch::STATUS)
+    {
+        printf("Status patch left %ld receipts marking 0x%lx, expected 1 marking 0x%x\n", receipts, changed, (unsigned)TaskPatch::STATUS);
+        return 1;
+    }
+
+    bench_remove_db_files();
+    return 0;
+}
@@ -0,0 +1,157 @@
+/** bench_timeblock_index.cpp
+ * Scaling of the timeblock -> task grouping in CalendarRepository. Times loadAll with the
+ * single-pass grouping, the previous per-timeblock scan of every task, and UUID lookups
+ * through the timeblock index, then checks that membership stays consistent through
+ * moveTask, removeTask, addTimeblock and removeTimeblock.
+ *
+ * Usage: bench_timeblock_index [task_count] [timeblock_count]
+ */
+#include "bench_util.h"
+
+#include "calendarrepository.h"
+
+#include <QCoreApplication>
+
+#include <string>
+#include <vector>
+
+// Every task sits in exactly the timeblock named by its timeblock_uuid
+static bool membership_consistent(CalendarRepository &repo)
+{
+    size_t grouped = 0;
+    for (const Timeblock &tb : repo.timeblocks())
+    {
+        if (repo.findTimeblockByUuid(tb.uuid) != &tb)
+            return false;
+        for (const Task *task : tb.tasks)
+        {
+            if (task->timeblock_uuid != tb.uuid)
+                return false;
+        }
+        grouped += tb.tasks.size();
+    }
+    return grouped == repo.tasks().size();
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 100000);
+    const long timeblockCount = bench_arg(argc, argv, 2, 1000);
+
+    bench_silence_logs();
+    bench_remove_db_files();
+
+    // --- Fixture: tasks spread round-robin over the timeblocks ---
+    std::vector<UUID> timeblockUuids;
+    try
+    {
+        Database db;
+        Database::Batch batch(db);
+        for (long i = 0; i < timeblockCount; i++)
+        {
+            Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+            db.insert_timeblock(tb);
+            timeblockUuids.push_back(tb.uuid);
+        }
+        time_t now = time(nullptr);
+        for (long i = 0; i < taskCount; i++)
+        {
+            Task task("Task", "Benchmark task", static_cast<Priority>(i % 5), now + (i % 500) * 3600);
+            task.set_timeblock_uuid(timeblockUuids[i % timeblockCount]);
+            db.insert_task(task);
+        }
+        batch.commit();
+    }
+    catch (int err)
+    {
+        printf("Fixture failed with SQLite error %d\n", err);
+        return 1;
+    }
+
+    QCoreApplication app(argc, argv);
+    printf("Timeblock index benchmark (%ld tasks, %ld timeblocks)\n", taskCount, timeblockCount);
+
+    BenchTimer loadTimer;
+    CalendarRepository repo; // runs loadAll
+    bench_report("loadAll (single-pass grouping)", 1, loadTimer.seconds());
+
+    {
+        // The grouping loadAll used before: one scan of every task per timeblock. Only a sample
+        // of timeblocks is scanned; the per-call figure extrapolates to the full count.
+        const long sampled = timeblockCount < 50 ? timeblockCount : 50;
+        BenchTimer t;
+        size_t scanned = 0, expected = 0;
+        for (long i = 0; i < sampled; i++)
+        {
+            const Timeblock &tb = repo.timeblocks()[i];
+            std::vector<Task *> result;
+            for (auto &[uuid, taskPtr] : repo.tasks())
+            {
+                if (taskPtr->timeblock_uuid == tb.uuid)
+                    result.push_back(taskPtr.get());
+            }
+            scanned += result.size();
+            expected += tb.tasks.size();
+        }
+        double seconds = t.seconds();
+        bench_report("grouping (scan per timeblock)", sampled, seconds);
+        printf("%-40s %10ld calls %10.3f ms (projected)\n", "grouping (scan per timeblock)", timeblockCount, seconds * 1e3 * timeblockCount / sampled);
+        if (scanned != expected)
+        {
+            printf("Scan found %zu tasks, index grouped %zu\n", scanned, expected);
+            return 1;
+        }
+    }
+
+    {
+        const long lookups = 1000000;
+        BenchTimer t;
+        long found = 0;
+        for (long i = 0; i < lookups; i++)
+            found += repo.findTimeblockByUuid(timeblockUuids[(i * 7919) % timeblockCount]) != nullptr;
+        bench_report("findTimeblockByUuid", lookups, t.seconds());
+        if (found != lookups)
+        {
+            printf("Index lookups missed %ld timeblocks\n", lookups - found);
+            return 1;
+        }
+    }
+
+    if (!membership_consistent(repo))
+    {
+        printf("Membership inconsistent after loadAll\n");
+        return 1;
+    }
+
+    // --- Modifiers keep the grouping and index in step ---
+    {
+        std::vector<UUID> taskUuids;
+        for (auto &[uuid, taskPtr] : repo.tasks())
+        {
+            taskUuids.push_back(uuid);
+            if (taskUuids.size() == 200)
+                break;
+        }
+
+        BenchTimer t;
+        for (size_t i = 0; i < taskUuids.size(); i++)
+            repo.moveTask(taskUuids[i], timeblockUuids[(i * 31) % timeblockCount]);
+        bench_report("moveTask", taskUuids.size(), t.seconds());
+
+        for (size_t i = 0; i < taskUuids.size(); i += 4)
+            repo.removeTask(taskUuids[i]);
+    }
+
+    Timeblock added("Added", "Added during benchmark", 0, 3600, 0);
+    repo.addTimeblock(added);
+    repo.removeTimeblock(timeblockUuids[0]);
+
+    if (!membership_consistent(repo))
+    {
+        printf("Membership inconsistent after modifications\n");
+        return 1;
+    }
+
+    bench_remove_db_files();
+    return 0;
+}
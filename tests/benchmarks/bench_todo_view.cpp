@@ -0,0 +1,189 @@
+/** bench_todo_view.cpp
+ * Cost of rebuilding the todo lists: one QListWidgetItem + TaskItemWidget per task (the
+ * previous TodoListView) against TodoListView's TaskListModel/TaskItemDelegate lists. Reports
+ * rebuild time (including the first layout and paint) and resident memory growth per size.
+ * Runs offscreen unless QT_QPA_PLATFORM is set.
+ *
+ * Usage: bench_todo_view [small_count] [large_count] [widget_limit]
+ *   The widget path only runs for sizes up to widget_limit (default 10000); at 100k tasks it
+ *   takes minutes and gigabytes.
+ */
+#include "bench_util.h"
+
+#include "calendarrepository.h"
+#include "todolistview.h"
+#include "taskitemwidget.h"
+
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QListView>
+#include <QListWidget>
+
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define TIMEBLOCK_COUNT 20
+
+// Resident set size from /proc; 0 where unavailable
+static long rss_bytes()
+{
+    long pages = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+        resident = 0;
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void report(const char *name, double seconds, long rssBefore, long rssAfter)
+{
+    printf("  %-34s %10.1f ms %10.1f MiB\n", name, seconds * 1e3, (rssAfter - rssBefore) / (1024.0 * 1024.0));
+}
+
+// Flush pending deletes so freed widgets do not count against the next measurement
+static void drain_events()
+{
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    QCoreApplication::processEvents();
+}
+
+// --- Fixture: a quarter of the tasks archived, a tenth habits ---
+static bool build_fixture(long taskCount)
+{
+    bench_remove_db_files();
+    try
+    {
+        Database db;
+        Database::Batch batch(db);
+        std::vector<UUID> timeblockUuids;
+        for (int i = 0; i < TIMEBLOCK_COUNT; i++)
+        {
+            Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+            db.insert_timeblock(tb);
+            timeblockUuids.push_back(tb.uuid);
+        }
+        time_t now = time(nullptr);
+        for (long i = 0; i < taskCount; i++)
+        {
+            Task task("Task", "Benchmark task", static_cast<Priority>(i % 5), now + (i % 500) * 3600);
+            task.set_timeblock_uuid(timeblockUuids[i % TIMEBLOCK_COUNT]);
+            if (i % 4 == 0)
+            {
+                task.status = TaskStatus::COMPLETE;
+                task.completed_datetime = now - i;
+            }
+            else if (i % 10 == 1)
+            {
+                task.status = TaskStatus::HABIT;
+            }
+            db.insert_task(task);
+        }
+        batch.commit();
+    }
+    catch (int err)
+    {
+        printf("Fixture failed with SQLite error %d\n", err);
+        return false;
+    }
+    return true;
+}
+
+// The rebuild TodoListView did before: a widget per task in both lists of every column
+static void widget_rebuild(CalendarRepository &repo)
+{
+    long before = rss_bytes();
+    BenchTimer t;
+
+    QWidget *container = new QWidget();
+    QHBoxLayout *layout = new QHBoxLayout(container);
+    for (const Timeblock &tb : repo.timeblocks())
+    {
+        QListWidget *todoList = new QListWidget(container);
+        QListWidget *archivedList = new QListWidget(container);
+        archivedList->setVisible(false);
+        for (Task *task : tb.tasks)
+        {
+            QListWidgetItem *item = new QListWidgetItem();
+            TaskItemWidget *widget = new TaskItemWidget(task, &repo);
+            item->setSizeHint(widget->sizeHint());
+            QListWidget *list = (task->status != TaskStatus::COMPLETE) ? todoList : archivedList;
+            list->addItem(item);
+            list->setItemWidget(item, widget);
+        }
+        layout->addWidget(todoList);
+        layout->addWidget(archivedList);
+    }
+    container->resize(1600, 900);
+    container->show();
+    QCoreApplication::processEvents();
+
+    report("widget per task", t.seconds(), before, rss_bytes());
+    delete container;
+    drain_events();
+}
+
+static bool model_rebuild(CalendarRepository &repo)
+{
+    long before = rss_bytes();
+    BenchTimer t;
+
+    TodoListView *view = new TodoListView(nullptr, &repo);
+    view->updateTasklists(repo.timeblocks());
+    view->resize(1600, 900);
+    view->show();
+    QCoreApplication::processEvents();
+
+    report("model + delegate", t.seconds(), before, rss_bytes());
+
+    // Every active task has a row; archived lists stay empty while collapsed
+    size_t expected = 0;
+    for (const auto &[uuid, task] : repo.tasks())
+        expected += (task->status != TaskStatus::COMPLETE);
+    size_t rows = 0;
+    for (QListView *list : view->findChildren<QListView *>())
+        rows += list->model()->rowCount();
+
+    delete view;
+    drain_events();
+
+    if (rows != expected)
+    {
+        printf("Model lists show %zu rows, expected %zu active tasks\n", rows, expected);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const long sizes[] = {bench_arg(argc, argv, 1, 10000), bench_arg(argc, argv, 2, 100000)};
+    const long widgetLimit = bench_arg(argc, argv, 3, 10000);
+
+    bench_silence_logs();
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    printf("Todo view rebuild benchmark (%d timeblocks; time, RSS growth)\n", TIMEBLOCK_COUNT);
+    for (long taskCount : sizes)
+    {
+        if (!build_fixture(taskCount))
+            return 1;
+
+        printf("%ld tasks\n", taskCount);
+        CalendarRepository repo; // runs loadAll
+
+        if (!model_rebuild(repo))
+            return 1;
+        if (taskCount <= widgetLimit)
+            widget_rebuild(repo);
+        else
+            printf("  %-34s %13s\n", "widget per task", "skipped");
+    }
+
+    bench_remove_db_files();
+    return 0;
+}
@@ -0,0 +1,107 @@
+/** bench_urgency_kernel.cpp
+ * Urgency scoring throughput: one urgency_score() call per task, as the sort comparators used
+ * to score tasks, against the batch score_urgency() kernels over contiguous columns. Every
+ * kernel must produce the same bits as the per-task scores, including for overdue, undated,
+ * far future and out of range due dates.
+ *
+ * Usage: bench_urgency_kernel [task_count] [passes]
+ */
+#include "bench_util.h"
+
+#include "urgency.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+static const Priority PRIORITIES[] = {Priority::NONE, Priority::VERY_LOW, Priority::LOW, Priority::MEDIUM, Priority::HIGH, Priority::VERY_HIGH};
+static const Scope SCOPES[] = {Scope::NONE, Scope::XS, Scope::S, Scope::M, Scope::L, Scope::XL};
+
+static void report_throughput(const char *name, long tasks, long passes, double seconds)
+{
+    bench_report(name, passes, seconds);
+    printf("%-40s %10.1f Mtasks/s %10.3f ns/task\n", "", tasks * passes / seconds / 1e6, seconds * 1e9 / (tasks * passes));
+}
+
+int main(int argc, char **argv)
+{
+    const long taskCount = bench_arg(argc, argv, 1, 1000000);
+    const long passes = bench_arg(argc, argv, 2, 20);
+
+    // --- Fixture: mostly due within a few weeks either way, with undated and extreme rows ---
+    const time_t now = time(nullptr);
+    std::mt19937_64 rng(42);
+    std::vector<time_t> dueDates(taskCount);
+    std::vector<int8_t> priorities(taskCount);
+    std::vector<int8_t> scopes(taskCount);
+    for (long i = 0; i < taskCount; i++)
+    {
+        switch (rng() % 16)
+        {
+        case 0:
+            dueDates[i] = 0; // Undated
+            break;
+        case 1:
+            dueDates[i] = now + static_cast<time_t>(rng() % (50ull * 365 * 86400)); // Far future, pressure underflows
+            break;
+        case 2:
+            dueDates[i] = static_cast<time_t>(rng()); // Anywhere in the time_t range
+            break;
+        default:
+            dueDates[i] = now + static_cast<time_t>(rng() % (60 * 86400)) - 30 * 86400;
+            break;
+        }
+        priorities[i] = static_cast<int8_t>(PRIORITIES[rng() % 6]);
+        scopes[i] = static_cast<int8_t>(SCOPES[rng() % 6]);
+    }
+
+    ScoreWeights weights;
+    weights.priority_weight = 1.5f;
+    weights.scope_weight = 0.75f;
+
+    printf("Urgency kernel benchmark (%ld tasks, %ld passes, best kernel %s)\n", taskCount, passes,
+           urgency_kernel_name(best_urgency_kernel()));
+
+    std::vector<float> reference(taskCount);
+    {
+        BenchTimer t;
+        for (long pass = 0; pass < passes; pass++)
+        {
+            for (long i = 0; i < taskCount; i++)
+                reference[i] = urgency_score(priorities[i], scopes[i], dueDates[i], now, weights);
+        }
+        report_throughput("urgency_score per task", taskCount, passes, t.seconds());
+    }
+
+    const UrgencyKernel kernels[] = {UrgencyKernel::SCALAR, UrgencyKernel::AVX2};
+    for (UrgencyKernel kernel : kernels)
+    {
+        if (kernel != UrgencyKernel::SCALAR && kernel != best_urgency_kernel())
+        {
+            printf("%-40s not supported on this CPU\n", urgency_kernel_name(kernel));
+            continue;
+        }
+
+        std::vector<float> scores(taskCount);
+        BenchTimer t;
+        for (long pass = 0; pass < passes; pass++)
+        {
+            score_urgency(kernel, dueDates.data(), priorities.data(), scopes.data(), taskCount, now, weights, scores.data());
+        }
+        std::string name = std::string("score_urgency (") + urgency_kernel_name(kernel) + ")";
+        report_throughput(name.c_str(), taskCount, passes, t.seconds());
+
+        for (long i = 0; i < taskCount; i++)
+        {
+            if (std::memcmp(&scores[i], &reference[i], sizeof(float)) != 0)
+            {
+                printf("%s kernel scored row %ld (due %lld, priority %d, scope %d) %.9g, per task %.9g\n",
+                       urgency_kernel_name(kernel), i, static_cast<long long>(dueDates[i]), priorities[i], scopes[i],
+                       scores[i], reference[i]);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
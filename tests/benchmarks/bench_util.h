@@ -0,0 +1,124 @@
+/** bench_util.h
+ * Small helpers shared by the client micro-benchmarks.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "calendarrepository.h"
+
+class BenchTimer
+{
+public:
+    BenchTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Print one result row: total time and per-call latency
+static inline void bench_report(const char *name, long calls, double seconds)
+{
+    printf("%-40s %10ld calls %10.3f ms %10.3f us/call\n",
+           name, calls, seconds * 1e3, calls ? seconds * 1e6 / calls : 0.0);
+}
+
+// The client library logs every database operation to stderr; silence it so the log
+// formatting does not dominate the measurements.
+static inline void bench_silence_logs()
+{
+    if (!freopen("/dev/null", "w", stderr))
+        fprintf(stdout, "warning: could not silence stderr\n");
+}
+
+// Read an optional positive integer argument, falling back to `def`
+static inline long bench_arg(int argc, char **argv, int index, long def)
+{
+    if (argc > index)
+    {
+        long v = strtol(argv[index], nullptr, 10);
+        if (v > 0)
+            return v;
+    }
+    return def;
+}
+
+// Delete a database and the files SQLite keeps beside it
+static inline void bench_remove_db_files(const char *path = DATABASE_PATH)
+{
+    remove(path);
+    remove((std::string(path) + "-wal").c_str());
+    remove((std::string(path) + "-shm").c_str());
+    remove((std::string(path) + "-journal").c_str());
+}
+
+// Fresh database at DATABASE_PATH, where CalendarRepository opens it: one timeblock holding
+// taskCount tasks with mixed priorities, due over the next three weeks
+static inline bool bench_build_fixture(long taskCount)
+{
+    bench_remove_db_files();
+    try
+    {
+        Database db;
+        Database::Batch batch(db);
+        Timeblock tb("Bench", "Benchmark timeblock", 0, 3600, 0);
+        db.insert_timeblock(tb);
+        time_t now = time(nullptr);
+        for (long i = 0; i < taskCount; i++)
+        {
+            Task task("Task", "Benchmark task", static_cast<Priority>(i % 5), now + (i % 500) * 3600);
+            task.set_timeblock_uuid(tb.uuid);
+            db.insert_task(task);
+        }
+        batch.commit();
+    }
+    catch (int err)
+    {
+        printf("Fixture failed with SQLite error %d\n", err);
+        return false;
+    }
+    return true;
+}
+
+// Once the repository's queued writes have landed, the stored tasks agree with its in-memory
+// model on every column the benchmarks edit
+static inline bool bench_database_matches(CalendarRepository &repo)
+{
+    repo.waitForWorker();
+    TaskHash stored;
+    try
+    {
+        Database db;
+        db.load_tasks(stored);
+    }
+    catch (int err)
+    {
+        printf("Reading back failed with SQLite error %d\n", err);
+        return false;
+    }
+    for (auto &[uuid, taskPtr] : repo.tasks())
+    {
+        auto it = stored.find(uuid);
+        if (it == stored.end() || it->second->timeblock_uuid != taskPtr->timeblock_uuid ||
+            it->second->due_date != taskPtr->due_date || it->second->priority != taskPtr->priority ||
+            it->second->status != taskPtr->status || it->second->completed_datetime != taskPtr->completed_datetime)
+        {
+            printf("Task <%s> differs between memory and the database\n", uuid.text().c_str());
+            return false;
+        }
+    }
+    if (stored.size() != repo.tasks().size())
+    {
+        printf("Database holds %zu tasks, memory %zu\n", stored.size(), repo.tasks().size());
+        return false;
+    }
+    return true;
+}
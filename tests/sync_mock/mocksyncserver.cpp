@@ -0,0 +1,264 @@
+#include "mocksyncserver.h"
+#include "synccodec.h"
+
+#include <QFile>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+
+MockSyncServer::MockSyncServer()
+{
+    m_server.setMaxPendingConnections(1024);
+    QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]()
+                     {
+        while (QTcpSocket *socket = m_server.nextPendingConnection())
+        {
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]()
+                             { onReadyRead(socket); });
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, [this, socket]()
+                             {
+                m_buffers.remove(socket);
+                socket->deleteLater(); });
+        } });
+}
+
+bool MockSyncServer::listen()
+{
+    return m_server.listen(QHostAddress::LocalHost, 0);
+}
+
+QUrl MockSyncServer::url() const
+{
+    return QUrl(QString("http://127.0.0.1:%1/sync").arg(m_server.serverPort()));
+}
+
+bool MockSyncServer::loadRecording(const QString &path, QJsonArray &entries)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isArray())
+    {
+        entries = doc.array();
+        return true;
+    }
+    if (doc.isObject() && doc.object()["entries"].isArray())
+    {
+        entries = doc.object()["entries"].toArray();
+        return true;
+    }
+    return false;
+}
+
+// Value of a header in a request head, matched case-insensitively; empty if absent
+static QByteArray header(const QByteArray &head, const char *name)
+{
+    for (const QByteArray &line : head.split('\n'))
+    {
+        int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == name)
+            return line.mid(colon + 1).trimmed();
+    }
+    return QByteArray();
+}
+
+// A raw zlib stream, as sent with Content-Encoding: deflate. qUncompress expects a 4-byte
+// big-endian size hint in front and grows its buffer past a low one.
+static QByteArray inflate(const QByteArray &data)
+{
+    QByteArray framed(4, '\0');
+    qToBigEndian<quint32>(data.size() * 4, framed.data());
+    return qUncompress(framed + data);
+}
+
+void MockSyncServer::onReadyRead(QTcpSocket *socket)
+{
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+
+    for (;;)
+    {
+        int headEnd = buffer.indexOf("\r\n\r\n");
+        if (headEnd < 0)
+            return;
+        QByteArray head = buffer.left(headEnd);
+        int length = header(head, "content-length").toInt(); // 0 if absent
+        if (buffer.size() < headEnd + 4 + length)
+            return; // Body still arriving
+
+        QByteArray body = buffer.mid(headEnd + 4, length);
+        buffer.remove(0, headEnd + 4 + length);
+
+        QByteArray replyBody, contentType;
+        int status = handle(head, body, replyBody, contentType);
+        reply(socket, status, replyBody, contentType);
+    }
+}
+
+int MockSyncServer::handle(const QByteArray &head, const QByteArray &body, QByteArray &out, QByteArray &contentType)
+{
+    contentType = "application/json";
+
+    QList<QByteArray> requestLine = head.left(head.indexOf("\r\n")).split(' ');
+    if (requestLine.size() < 2 || requestLine[0] != "POST" || requestLine[1] != "/sync")
+    {
+        out = R"({"detail":"Not Found"})";
+        return 404;
+    }
+
+    SyncEncoding encoding;
+    QByteArray type = header(head, "content-type");
+    if (type.startsWith(SyncCodec::contentType(SyncEncoding::CBOR)))
+        encoding = SyncEncoding::CBOR;
+    else if (type.isEmpty() || type.startsWith("application/json"))
+        encoding = SyncEncoding::JSON;
+    else
+    {
+        out = R"({"detail":"Unsupported sync encoding"})";
+        return 415;
+    }
+
+    m_stats.requests++;
+    m_stats.bytesReceived += body.size();
+
+    QJsonObject page;
+    QByteArray data = header(head, "content-encoding") == "deflate" ? inflate(body) : body;
+    if (!SyncCodec::decode(data, encoding, page))
+    {
+        out = R"({"detail":"Malformed sync page"})";
+        return 422;
+    }
+    m_stats.entriesReceived += page.value("entries").toArray().size();
+
+    // Same paging as the server: nothing comes back while the client is still uploading, then
+    // either a manifest of the tables with deltas past the client's last version, or page_size
+    // deltas per reply with a cursor until the last page
+    const int total = m_deltas.size();
+    const int lastVersion = page.value("last_server_version").toInt();
+    const int pageSize = page.value("page_size").toInt();
+    const QString table = page.value("table").toString();
+    QJsonArray entries;
+    QJsonValue cursor = QJsonValue::Null;
+    QJsonValue manifest = QJsonValue::Null;
+    int newVersion = total;
+    if (page.value("more").toBool())
+    {
+        newVersion = lastVersion;
+    }
+    else if (!table.isEmpty() && pageSize > 0)
+    {
+        // One table of the manifest; its cursor is "<table>:<last version sent>"
+        int i = std::min(total, std::max(lastVersion, page.value("cursor").toString().section(':', 1).toInt()));
+        int sent = i;
+        for (; i < total; i++)
+        {
+            if (m_deltas[i].toObject().value("table").toString() != table)
+                continue;
+            if (entries.size() == pageSize)
+            {
+                cursor = table + ":" + QString::number(sent);
+                break;
+            }
+            entries.append(m_deltas[i]);
+            sent = i + 1;
+        }
+    }
+    else if (m_manifest && page.value("manifest").toBool() && page.value("cursor").toString().isEmpty())
+    {
+        // Tables in the order they first appear, which for recorded or generated deltas is parents first
+        QJsonArray ranges;
+        QHash<QString, int> counts;
+        for (int i = std::min(total, lastVersion); i < total; i++)
+        {
+            QString deltaTable = m_deltas[i].toObject().value("table").toString();
+            if (counts[deltaTable]++ == 0)
+                ranges.append(QJsonObject{{"table", deltaTable}, {"after", lastVersion}, {"upto", total},
+                                          {"cursor", deltaTable + ":" + QString::number(lastVersion)}});
+        }
+        for (int i = 0; i < ranges.size(); i++)
+        {
+            QJsonObject range = ranges[i].toObject();
+            range["count"] = counts[range["table"].toString()];
+            ranges[i] = range;
+        }
+        manifest = ranges;
+    }
+    else
+    {
+        int start = std::min(total, std::max(lastVersion, page.value("cursor").toString().toInt()));
+        int end = pageSize > 0 ? std::min(total, start + pageSize) : total;
+        for (int i = start; i < end; i++)
+            entries.append(m_deltas[i]);
+        if (end < total)
+            cursor = QString::number(end);
+    }
+    m_stats.entriesSent += entries.size();
+
+    QJsonObject response;
+    response["new_server_version"] = newVersion;
+    response["entries"] = entries;
+    response["cursor"] = cursor;
+    response["acked_seq"] = page.contains("receipt_seq") ? page.value("receipt_seq") : QJsonValue(QJsonValue::Null);
+
+    // The last upload page of each client, to answer a client asking after one it lost the reply to
+    const QString clientId = page.value("client_id").toString();
+    if (page.contains("batch_id") && page.contains("receipt_seq"))
+        m_batches[clientId] = qMakePair(page.value("batch_id").toString(), page.value("receipt_seq"));
+    if (page.contains("resume_batch"))
+    {
+        auto batch = m_batches.constFind(clientId);
+        bool committed = batch != m_batches.constEnd() && batch->first == page.value("resume_batch").toString();
+        response["acked_seq"] = committed ? batch->second : QJsonValue(QJsonValue::Null);
+    }
+    response["manifest"] = manifest;
+
+    // Answer in the binary format when the client offers it
+    SyncEncoding replyEncoding = header(head, "accept").contains(SyncCodec::contentType(SyncEncoding::CBOR))
+                                     ? SyncEncoding::CBOR
+                                     : SyncEncoding::JSON;
+    contentType = SyncCodec::contentType(replyEncoding);
+    out = SyncCodec::encode(response, replyEncoding);
+    m_stats.bytesSent += out.size();
+    return 200;
+}
+
+static const char *reason(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 404:
+        return "Not Found";
+    case 415:
+        return "Unsupported Media Type";
+    case 422:
+        return "Unprocessable Entity";
+    default:
+        return "Error";
+    }
+}
+
+void MockSyncServer::reply(QTcpSocket *socket, int status, const QByteArray &body, const QByteArray &contentType)
+{
+    if (m_silent)
+        return; // The connection stays open with nothing sent back
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reason(status) + "\r\n" +
+                          "Content-Type: " + contentType + "\r\n" +
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n" +
+                          "\r\n" + body;
+
+    if (m_replyDelayMs <= 0)
+    {
+        socket->write(response);
+        return;
+    }
+    QTimer::singleShot(m_replyDelayMs, socket, [socket, response]()
+                       { socket->write(response); });
+}
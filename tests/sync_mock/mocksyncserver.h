@@ -0,0 +1,64 @@
+/** mocksyncserver.h
+ * In-process stand-in for the server's /sync endpoint, listening on loopback over plain HTTP.
+ * It speaks the same pages as the FastAPI server (JSON or CBOR, deflated request bodies,
+ * cursor paging, acked_seq, resumed batches) but keeps no tables: uploaded entries are counted and dropped, and
+ * every client is served the same fixed list of deltas, so runs are repeatable.
+ *
+ * Delta i (0-based) is treated as server version i + 1, and a cursor is the number of deltas
+ * already sent, or for a manifest table "<table>:<last version sent>".
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPair>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+
+class MockSyncServer
+{
+public:
+    struct Stats
+    {
+        long requests = 0;
+        long entriesReceived = 0;
+        long entriesSent = 0;
+        long long bytesReceived = 0; // Request bodies as sent, before inflating
+        long long bytesSent = 0;     // Reply bodies
+    };
+
+    MockSyncServer();
+
+    bool listen(); // On 127.0.0.1, any free port
+    QUrl url() const;
+
+    void setDeltas(const QJsonArray &entries) { m_deltas = entries; }
+    void setReplyDelay(int ms) { m_replyDelayMs = ms; } // Added to every reply, to stand in for a real network
+    void setManifest(bool enabled) { m_manifest = enabled; } // Off: answer like a server without manifests
+    void setSilent(bool silent) { m_silent = silent; }       // On: read requests but never answer, like a stalled server
+
+    // Entries from a recorded page or payload ({"entries": [...]}) or a bare array of entries
+    static bool loadRecording(const QString &path, QJsonArray &entries);
+
+    const Stats &stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+private:
+    void onReadyRead(QTcpSocket *socket);
+    // Handle one complete request; returns the status line's code and fills the reply
+    int handle(const QByteArray &head, const QByteArray &body, QByteArray &out, QByteArray &contentType);
+    void reply(QTcpSocket *socket, int status, const QByteArray &body, const QByteArray &contentType);
+
+    QHash<QTcpSocket *, QByteArray> m_buffers; // Bytes of a request still being received
+    QHash<QString, QPair<QString, QJsonValue>> m_batches; // Per client id: last batch_id and its receipt_seq
+    QJsonArray m_deltas;
+    int m_replyDelayMs = 0;
+    bool m_manifest = true;
+    bool m_silent = false;
+    Stats m_stats;
+    QTcpServer m_server; // Last, so its sockets go before the state their handlers touch
+};
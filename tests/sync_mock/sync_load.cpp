@@ -0,0 +1,326 @@
+/** sync_load.cpp
+ * Sync load test against the in-process MockSyncServer, with no Python server, certificates or
+ * GUI. For 1, 10 and 100 simulated clients, each with its own database file and Synchronizer,
+ * every client uploads its local edits and downloads the same server deltas, all at once over
+ * loopback. Reports wall time, per-client exchange latency and entry throughput, and checks
+ * every client applied all the deltas and had all its receipts acknowledged. Each round runs
+ * twice: the server's changes paged back in one stream, then fetched per table from a manifest.
+ * A last round has the server read a client's request and never answer, which must fail the
+ * exchange once the request times out instead of leaving it open.
+ *
+ * The deltas are generated unless a recording is given: a saved sync page or payload
+ * ({"entries": [...]}, e.g. tests/server_basic_sync/payload.json) or a bare array of entries.
+ *
+ * Usage: sync_load [server_tasks] [local_tasks] [reply_delay_ms] [recording.json]
+ */
+#include "bench_util.h"
+#include "mocksyncserver.h"
+
+#include "database.h"
+#include "syncronize.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonObject>
+#include <QNetworkProxy>
+#include <QSet>
+#include <QTimer>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define SYNC_LOAD_TIMEOUT_MS 120000 // Per round; a client that has not finished by then fails the run
+#define SYNC_STALL_TIMEOUT_MS 500    // Request timeout of the client the silent server never answers
+
+struct Client
+{
+    std::string path;
+    std::unique_ptr<Database> db;
+    std::unique_ptr<Synchronizer> synchronizer; // Declared after db, so destroyed before it
+    qint64 startNs = 0;
+    double seconds = -1; // Exchange latency, negative until it finishes
+    bool failed = false;
+};
+
+static void remove_db_files(const std::string &path)
+{
+    remove(path.c_str());
+    remove((path + "-wal").c_str());
+    remove((path + "-shm").c_str());
+}
+
+static std::string client_path(int index)
+{
+    return "sync_load_" + std::to_string(index) + ".db";
+}
+
+// A timeblock, its tasks, and a habit entry for every fifth task, as the server would send them
+static QJsonArray make_deltas(long taskCount)
+{
+    const qint64 now = time(nullptr);
+    char tbUuid[UUID_LEN];
+    generate_uuid(tbUuid);
+
+    QJsonArray deltas;
+    QJsonObject tb{{"uuid", tbUuid}, {"status", 0}, {"name", "Server"}, {"description", "Server timeblock"},
+                   {"day_frequency", 127}, {"duration", 3600}, {"start", 0}, {"day_start", 8 * 3600},
+                   {"completed_datetime", 0}, {"modified_at", now}, {"deleted_at", QJsonValue::Null}};
+    deltas.append(QJsonObject{{"table", "timeblocks"}, {"data", tb}});
+
+    for (long i = 0; i < taskCount; i++)
+    {
+        char uuid[UUID_LEN];
+        generate_uuid(uuid);
+        QJsonObject task{{"uuid", uuid}, {"timeblock_uuid", tbUuid}, {"name", "Task"}, {"description", "Server task"},
+                         {"due_date", now + (i % 500) * 3600}, {"priority", (int)(i % 5)}, {"scope", 0}, {"status", 0},
+                         {"goal_spec", 0}, {"completed_datetime", 0}, {"modified_at", now}, {"deleted_at", QJsonValue::Null}};
+        deltas.append(QJsonObject{{"table", "tasks"}, {"data", task}});
+        if (i % 5 == 0)
+        {
+            QJsonObject habit{{"task_uuid", uuid}, {"date", "2026-10-17"}, {"modified_at", now}, {"deleted_at", QJsonValue::Null}};
+            deltas.append(QJsonObject{{"table", "habit_entries"}, {"data", habit}});
+        }
+    }
+    return deltas;
+}
+
+// Tasks a client holds after applying the deltas in order
+static long delta_task_count(const QJsonArray &deltas)
+{
+    QSet<QString> uuids;
+    for (const QJsonValue &value : deltas)
+    {
+        QJsonObject entry = value.toObject();
+        if (entry["table"].toString() != "tasks")
+            continue;
+        QJsonObject data = entry["data"].toObject();
+        if (data["deleted"] == true)
+            uuids.remove(data["uuid"].toString());
+        else
+            uuids.insert(data["uuid"].toString());
+    }
+    return uuids.size();
+}
+
+// Read through a separate connection, after the client's Database is closed
+static long count_rows(const std::string &path, const char *table)
+{
+    sqlite3 *db = nullptr;
+    long n = -1;
+    sqlite3_stmt *stmt = nullptr;
+    std::string sql = std::string("SELECT COUNT(*) FROM ") + table + ";";
+    if (sqlite3_open(path.c_str(), &db) == SQLITE_OK && sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+        n = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return n;
+}
+
+// A fresh database holding localTasks edits not yet synced
+static void make_client(Client &client, int index, long localTasks, const QUrl &endpoint)
+{
+    client.path = client_path(index);
+    remove_db_files(client.path);
+    client.db = std::make_unique<Database>(client.path.c_str());
+
+    Database::Batch batch(*client.db);
+    Timeblock tb("Local", "Client timeblock", 0, 3600, 0);
+    client.db->insert_timeblock(tb);
+    time_t now = time(nullptr);
+    for (long i = 0; i < localTasks; i++)
+    {
+        Task task("Task", "Client task", static_cast<Priority>(i % 5), now + (i % 500) * 3600);
+        task.set_timeblock_uuid(tb.uuid);
+        client.db->insert_task(task);
+    }
+    batch.commit();
+
+    client.synchronizer = std::make_unique<Synchronizer>(*client.db);
+    client.synchronizer->setEndpoint(endpoint);
+    client.synchronizer->setClientId(QString("load-client-%1").arg(index));
+}
+
+static bool run_round(MockSyncServer &server, bool manifest, int clientCount, long localTasks, long expectedTasks)
+{
+    server.setManifest(manifest);
+    std::vector<Client> clients(clientCount);
+    try
+    {
+        for (int i = 0; i < clientCount; i++)
+            make_client(clients[i], i, localTasks, server.url());
+    }
+    catch (int err)
+    {
+        printf("Client setup failed with SQLite error %d\n", err);
+        return false;
+    }
+    server.resetStats();
+
+    QEventLoop loop;
+    QElapsedTimer clock;
+    int remaining = clientCount;
+    for (Client &client : clients)
+    {
+        Client *c = &client;
+        auto finished = [&loop, &clock, &remaining, c](bool failed)
+        {
+            c->seconds = (clock.nsecsElapsed() - c->startNs) * 1e-9;
+            c->failed = failed;
+            if (--remaining == 0)
+                loop.quit();
+        };
+        QObject::connect(c->synchronizer.get(), &Synchronizer::syncCompleted, &loop, [finished]()
+                         { finished(false); });
+        QObject::connect(c->synchronizer.get(), &Synchronizer::syncFailed, &loop, [finished]()
+                         { finished(true); });
+    }
+    QTimer::singleShot(SYNC_LOAD_TIMEOUT_MS, &loop, &QEventLoop::quit);
+
+    // Every client starts its exchange before any reply is handled
+    clock.start();
+    for (Client &client : clients)
+    {
+        client.startNs = clock.nsecsElapsed();
+        client.synchronizer->sync();
+    }
+    if (remaining > 0)
+        loop.exec();
+    double wall = clock.nsecsElapsed() * 1e-9;
+
+    std::vector<double> latencies;
+    bool ok = true;
+    for (Client &client : clients)
+    {
+        if (client.seconds < 0 || client.failed)
+        {
+            printf("Client %s %s\n", client.path.c_str(), client.failed ? "failed to sync" : "timed out");
+            ok = false;
+        }
+        latencies.push_back(client.seconds);
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const MockSyncServer::Stats &stats = server.stats();
+    double mean = 0;
+    for (double s : latencies)
+        mean += s / latencies.size();
+    printf("%-8s %4d clients %9.1f ms wall %9.1f ms mean %9.1f ms p50 %9.1f ms max %11.0f entries/s %7ld requests %8.1f KiB up %8.1f KiB down\n",
+           manifest ? "manifest" : "stream", clientCount, wall * 1e3, mean * 1e3, latencies[latencies.size() / 2] * 1e3, latencies.back() * 1e3,
+           (stats.entriesReceived + stats.entriesSent) / wall, stats.requests, stats.bytesReceived / 1024.0, stats.bytesSent / 1024.0);
+
+    for (Client &client : clients)
+    {
+        client.synchronizer.reset();
+        client.db.reset();
+        if (!ok)
+            continue;
+
+        long tasks = count_rows(client.path, "tasks");
+        long receipts = count_rows(client.path, "timeblock_change_receipts") + count_rows(client.path, "task_change_receipts") +
+                        count_rows(client.path, "habit_entry_change_receipts") + count_rows(client.path, "entry_link_change_receipts");
+        if (tasks != localTasks + expectedTasks || receipts != 0)
+        {
+            printf("Client %s has %ld tasks (expected %ld) and %ld receipts left\n", client.path.c_str(), tasks,
+                   localTasks + expectedTasks, receipts);
+            ok = false;
+        }
+    }
+    for (Client &client : clients)
+        remove_db_files(client.path);
+    return ok;
+}
+
+// One client against a server that never answers: the request times out and the exchange fails
+static bool run_silent_round(MockSyncServer &server, long localTasks)
+{
+    Client client;
+    try
+    {
+        make_client(client, 0, localTasks, server.url());
+    }
+    catch (int err)
+    {
+        printf("Client setup failed with SQLite error %d\n", err);
+        return false;
+    }
+    client.synchronizer->setRequestTimeout(SYNC_STALL_TIMEOUT_MS);
+    server.setSilent(true);
+
+    QEventLoop loop;
+    bool completed = false, failed = false;
+    QObject::connect(client.synchronizer.get(), &Synchronizer::syncCompleted, &loop, [&]()
+                     { completed = true; loop.quit(); });
+    QObject::connect(client.synchronizer.get(), &Synchronizer::syncFailed, &loop, [&]()
+                     { failed = true; loop.quit(); });
+    QTimer::singleShot(SYNC_LOAD_TIMEOUT_MS, &loop, &QEventLoop::quit);
+
+    QElapsedTimer clock;
+    clock.start();
+    client.synchronizer->sync();
+    loop.exec();
+    double seconds = clock.nsecsElapsed() * 1e-9;
+    const bool stillSyncing = client.synchronizer->syncing();
+    server.setSilent(false);
+
+    printf("%-8s %4d clients %9.1f ms until the exchange failed\n", "silent", 1, seconds * 1e3);
+    client.synchronizer.reset();
+    client.db.reset();
+    remove_db_files(client.path);
+
+    if (!failed || completed || stillSyncing)
+    {
+        printf("Exchange with a silent server %s\n", completed ? "completed" : "never ended");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const long serverTasks = bench_arg(argc, argv, 1, 2000);
+    const long localTasks = bench_arg(argc, argv, 2, 200);
+    const long replyDelayMs = bench_arg(argc, argv, 3, 0);
+    const int clientCounts[] = {1, 10, 100};
+
+    bench_silence_logs();
+    QCoreApplication app(argc, argv);
+    QNetworkProxy::setApplicationProxy(QNetworkProxy::NoProxy); // Loopback only, whatever the environment says
+
+    QJsonArray deltas;
+    if (argc > 4)
+    {
+        if (!MockSyncServer::loadRecording(argv[4], deltas))
+        {
+            printf("Could not read recorded entries from %s\n", argv[4]);
+            return 1;
+        }
+    }
+    else
+    {
+        deltas = make_deltas(serverTasks);
+    }
+
+    MockSyncServer server;
+    server.setDeltas(deltas);
+    server.setReplyDelay(replyDelayMs);
+    if (!server.listen())
+    {
+        printf("Mock sync server could not listen on loopback\n");
+        return 1;
+    }
+
+    printf("Sync load test (%d server deltas, %ld local tasks per client, %ld ms reply delay, %s)\n", (int)deltas.size(),
+           localTasks, replyDelayMs, qPrintable(server.url().toString()));
+    const long expectedTasks = delta_task_count(deltas);
+    for (int clientCount : clientCounts)
+    {
+        if (!run_round(server, false, clientCount, localTasks, expectedTasks) ||
+            !run_round(server, true, clientCount, localTasks, expectedTasks))
+            return 1;
+    }
+    return run_silent_round(server, localTasks) ? 0 : 1;
+}